@@ -0,0 +1,270 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Request parser benchmark
+
+   Splits the head of a request into its start line and header fields, over
+   and over, with the tokenizer implementations the CPU supports and with the
+   scan the parser did before: `strstr()` for the end of every line and
+   `strchr()` for the colon of every header.
+
+   Throughput is reported in bytes per cycle of the time stamp counter, which
+   ticks at a constant rate, or in bytes per nanosecond where there is none.
+
+   Usage: rx_bench_parse [iterations]
+ */
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+#define RX_BENCH_PARSE_ITERATIONS 1000000
+
+struct rx_bench_request
+{
+    const char *name;
+    const char *head;
+};
+
+struct rx_bench_parser
+{
+    const char *name;
+    rx_tokenizer_impl_t impl;
+    int (*parse)(struct rx_tokens *tokens, const char *head, size_t len);
+};
+
+static size_t iterations = RX_BENCH_PARSE_ITERATIONS;
+
+/* Keeps the compiler from dropping the parsing */
+static volatile size_t sink;
+
+static const struct rx_bench_request requests[] = {
+    {
+        .name = "curl",
+        .head = "GET /about HTTP/1.1\r\n"
+                "Host: localhost:8080\r\n"
+                "User-Agent: curl/8.5.0\r\n"
+                "Accept: */*\r\n"
+                "\r\n",
+    },
+    {
+        .name = "browser",
+        .head = "GET /public/css/index.css HTTP/1.1\r\n"
+                "Host: localhost:8080\r\n"
+                "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) "
+                "Gecko/20100101 Firefox/128.0\r\n"
+                "Accept: text/css,*/*;q=0.1\r\n"
+                "Accept-Language: en-US,en;q=0.5\r\n"
+                "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+                "Connection: keep-alive\r\n"
+                "Referer: http://localhost:8080/about\r\n"
+                "Cookie: session=0123456789abcdef0123456789abcdef; "
+                "theme=dark; lang=en\r\n"
+                "Sec-Fetch-Dest: style\r\n"
+                "Sec-Fetch-Mode: no-cors\r\n"
+                "Sec-Fetch-Site: same-origin\r\n"
+                "If-Modified-Since: Sat, 17 Oct 2026 10:00:00 GMT\r\n"
+                "Priority: u=2\r\n"
+                "\r\n",
+    },
+};
+
+/* The scan of the parser before the tokenizer
+
+   Relies on the head being NUL terminated and ending with an empty line.
+ */
+static int
+rx_bench_parse_strstr(struct rx_tokens *tokens, const char *head, size_t len)
+{
+    const char *line, *eol, *colon, *p;
+    struct rx_token_header *header;
+
+    (void)len;
+
+    eol = strstr(head, "\r\n");
+
+    tokens->method = head;
+    for (p = head; p < eol && *p != ' '; p++)
+        ;
+    tokens->method_end = p;
+
+    tokens->uri = p + 1;
+    for (p = p + 1; p < eol && *p != ' '; p++)
+        ;
+    tokens->uri_end = p;
+
+    tokens->version     = p + 1;
+    tokens->version_end = eol;
+    tokens->nheaders    = 0;
+
+    line = eol + 2;
+    eol  = strstr(line, "\r\n");
+
+    while (eol != NULL && eol > line)
+    {
+        colon = strchr(line, ':');
+
+        if (colon == NULL || tokens->nheaders == RX_TOKENIZER_MAX_HEADERS)
+        {
+            return RX_ERROR;
+        }
+
+        header            = &tokens->headers[tokens->nheaders++];
+        header->name      = line;
+        header->name_end  = colon;
+        header->value     = colon + 2;
+        header->value_end = eol;
+
+        line = eol + 2;
+        eol  = strstr(line, "\r\n");
+    }
+
+    return RX_OK;
+}
+
+static uint64_t
+rx_bench_ticks()
+{
+#if defined(RX_HAVE_X86_INTRINSICS)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+static double
+rx_bench_now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+rx_bench_run(
+    const struct rx_bench_parser *parser,
+    const struct rx_bench_request *request
+)
+{
+    struct rx_tokens tokens;
+    uint64_t ticks;
+    double start, elapsed;
+    size_t i, len;
+
+    len = strlen(request->head);
+
+    rx_tokenizer_reset(&tokens);
+
+    if (parser->parse(&tokens, request->head, len) != RX_OK)
+    {
+        fprintf(stderr, "%s: cannot parse %s\n", parser->name, request->name);
+        return RX_ERROR;
+    }
+
+    start = rx_bench_now();
+    ticks = rx_bench_ticks();
+
+    for (i = 0; i < iterations; i++)
+    {
+        rx_tokenizer_reset(&tokens);
+        (void)parser->parse(&tokens, request->head, len);
+        sink += tokens.nheaders;
+    }
+
+    ticks   = rx_bench_ticks() - ticks;
+    elapsed = rx_bench_now() - start;
+
+    printf(
+        "%-8s %-8s %6zu %8zu %10.1f %12.2f\n", parser->name, request->name,
+        len, tokens.nheaders, elapsed * 1e9 / iterations,
+        (double)len * iterations / ticks
+    );
+
+    return RX_OK;
+}
+
+int
+main(int argc, const char *argv[])
+{
+    static const struct rx_bench_parser parsers[] = {
+        {
+            .name  = "strstr",
+            .impl  = RX_TOKENIZER_SCALAR,
+            .parse = rx_bench_parse_strstr,
+        },
+        {
+            .name  = "scalar",
+            .impl  = RX_TOKENIZER_SCALAR,
+            .parse = rx_tokenize,
+        },
+        {
+            .name  = "sse4.2",
+            .impl  = RX_TOKENIZER_SSE42,
+            .parse = rx_tokenize,
+        },
+        {
+            .name  = "avx2",
+            .impl  = RX_TOKENIZER_AVX2,
+            .parse = rx_tokenize,
+        },
+    };
+
+    if (argc > 1 && (iterations = strtoul(argv[1], NULL, 10)) == 0)
+    {
+        fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf(
+        "%-8s %-8s %6s %8s %10s %12s\n", "parser", "request", "bytes",
+        "headers", "ns/parse",
+#if defined(RX_HAVE_X86_INTRINSICS)
+        "bytes/cycle"
+#else
+        "bytes/ns"
+#endif
+    );
+
+    for (size_t r = 0; r < sizeof(requests) / sizeof(requests[0]); r++)
+    {
+        for (size_t p = 0; p < sizeof(parsers) / sizeof(parsers[0]); p++)
+        {
+            if (rx_tokenizer_use(parsers[p].impl) != RX_OK)
+            {
+                continue;
+            }
+
+            if (rx_bench_run(&parsers[p], &requests[r]) != RX_OK)
+            {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
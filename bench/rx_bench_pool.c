@@ -0,0 +1,455 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Thread pool benchmark
+
+   Compares the work-stealing thread pool with a pool whose workers all share
+   one ring, which is how the pool worked before. Producer threads stand in
+   for the event loops: each submits its share of small tasks as fast as it
+   can, runs a task itself when the pool refuses it, like the loop does, and
+   waits until all of its tasks are done.
+
+   Usage: rx_bench_pool [tasks per producer]
+ */
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+#define RX_BENCH_POOL_TASKS 200000
+
+/* Iterations of the busy loop of a task, a stand-in for serving a request */
+#define RX_BENCH_POOL_WORK 200
+
+struct rx_bench_producer;
+
+struct rx_bench_task
+{
+    struct rx_task task;
+    struct rx_bench_producer *producer;
+};
+
+struct rx_bench_pool;
+
+struct rx_bench_producer
+{
+    pthread_t thread;
+    struct rx_bench_pool *pool;
+
+    struct rx_bench_task *tasks;
+    size_t ntasks;
+    size_t ninline;
+
+    _Alignas(RX_CACHE_LINE_SIZE) _Atomic size_t done;
+};
+
+/* The pool before work stealing: one ring shared by every worker, with the
+   same spinning and parking as the work-stealing pool */
+struct rx_bench_shared_pool
+{
+    struct rx_ring ring;
+
+    pthread_t *threads;
+    size_t nthreads;
+
+    _Atomic uint32_t wakeups;
+    _Atomic uint32_t nparked;
+    _Atomic int stopping;
+};
+
+struct rx_bench_pool
+{
+    const char *name;
+
+    int (*init)(struct rx_bench_pool *pool, size_t nthreads);
+    int (*submit)(struct rx_bench_pool *pool, struct rx_task *task);
+    void (*destroy)(struct rx_bench_pool *pool);
+
+    union
+    {
+        struct rx_thread_pool stealing;
+        struct rx_bench_shared_pool *shared;
+    } u;
+};
+
+static size_t ntasks = RX_BENCH_POOL_TASKS;
+
+static void *
+rx_bench_pool_work(void *arg)
+{
+    struct rx_bench_task *task = arg;
+    volatile size_t sink       = 0;
+
+    for (size_t i = 0; i < RX_BENCH_POOL_WORK; i++)
+    {
+        sink += i;
+    }
+
+    atomic_fetch_add_explicit(
+        &task->producer->done, 1, memory_order_release
+    );
+
+    return RX_OK_PTR;
+}
+
+static int
+rx_bench_stealing_init(struct rx_bench_pool *pool, size_t nthreads)
+{
+    struct rx_thread_pool_config config = {
+        .name     = "stealing",
+        .nthreads = nthreads,
+        .depth    = RX_RING_DEFAULT_CAPACITY,
+        .priority = 0,
+        .affinity = 0,
+        .target   = 0,
+    };
+
+    return rx_thread_pool_init(&pool->u.stealing, &config);
+}
+
+static int
+rx_bench_stealing_submit(struct rx_bench_pool *pool, struct rx_task *task)
+{
+    return rx_thread_pool_submit(&pool->u.stealing, task);
+}
+
+static void
+rx_bench_stealing_destroy(struct rx_bench_pool *pool)
+{
+    rx_thread_pool_destroy(&pool->u.stealing);
+}
+
+static struct rx_task *
+rx_bench_shared_take(struct rx_bench_shared_pool *pool)
+{
+    struct rx_task *task;
+    uint32_t wakeups;
+
+    for (;;)
+    {
+        for (size_t i = 0; i < RX_THREAD_POOL_SPIN; i++)
+        {
+            if ((task = rx_ring_pop(&pool->ring)) != NULL)
+            {
+                return task;
+            }
+        }
+
+        wakeups = atomic_load_explicit(&pool->wakeups, memory_order_acquire);
+        atomic_fetch_add(&pool->nparked, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        task = rx_ring_pop(&pool->ring);
+
+        if (task == NULL && !atomic_load(&pool->stopping))
+        {
+            (void)syscall(
+                SYS_futex, &pool->wakeups, FUTEX_WAIT_PRIVATE, wakeups, NULL,
+                NULL, 0
+            );
+        }
+
+        atomic_fetch_sub(&pool->nparked, 1);
+
+        if (task != NULL || atomic_load(&pool->stopping))
+        {
+            return task;
+        }
+    }
+}
+
+static void *
+rx_bench_shared_worker(void *arg)
+{
+    struct rx_bench_shared_pool *pool = arg;
+    struct rx_task *task;
+
+    while ((task = rx_bench_shared_take(pool)) != NULL)
+    {
+        task->handle(task->arg);
+    }
+
+    return NULL;
+}
+
+static void
+rx_bench_shared_wake(struct rx_bench_shared_pool *pool, int nworkers)
+{
+    atomic_fetch_add_explicit(&pool->wakeups, 1, memory_order_release);
+
+    (void)syscall(
+        SYS_futex, &pool->wakeups, FUTEX_WAKE_PRIVATE, nworkers, NULL, NULL, 0
+    );
+}
+
+static int
+rx_bench_shared_init(struct rx_bench_pool *pool, size_t nthreads)
+{
+    struct rx_bench_shared_pool *shared;
+
+    shared = aligned_alloc(
+        _Alignof(struct rx_bench_shared_pool),
+        sizeof(struct rx_bench_shared_pool)
+    );
+
+    if (shared == NULL)
+    {
+        return RX_ERROR;
+    }
+
+    shared->threads = calloc(nthreads, sizeof(pthread_t));
+
+    if (shared->threads == NULL)
+    {
+        free(shared);
+        return RX_ERROR;
+    }
+
+    if (rx_ring_init(&shared->ring, RX_RING_DEFAULT_CAPACITY) != RX_OK)
+    {
+        free(shared->threads);
+        free(shared);
+        return RX_ERROR;
+    }
+
+    shared->nthreads = nthreads;
+
+    atomic_init(&shared->wakeups, 0);
+    atomic_init(&shared->nparked, 0);
+    atomic_init(&shared->stopping, 0);
+
+    for (size_t i = 0; i < nthreads; i++)
+    {
+        if (pthread_create(
+                &shared->threads[i], NULL, rx_bench_shared_worker, shared
+            ) != 0)
+        {
+            return RX_ERROR;
+        }
+    }
+
+    pool->u.shared = shared;
+
+    return RX_OK;
+}
+
+static int
+rx_bench_shared_submit(struct rx_bench_pool *pool, struct rx_task *task)
+{
+    struct rx_bench_shared_pool *shared = pool->u.shared;
+
+    if (rx_ring_push(&shared->ring, task) != RX_OK)
+    {
+        return RX_AGAIN;
+    }
+
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (atomic_load_explicit(&shared->nparked, memory_order_relaxed) > 0)
+    {
+        rx_bench_shared_wake(shared, 1);
+    }
+
+    return RX_OK;
+}
+
+static void
+rx_bench_shared_destroy(struct rx_bench_pool *pool)
+{
+    struct rx_bench_shared_pool *shared = pool->u.shared;
+
+    atomic_store(&shared->stopping, 1);
+    rx_bench_shared_wake(shared, INT_MAX);
+
+    for (size_t i = 0; i < shared->nthreads; i++)
+    {
+        pthread_join(shared->threads[i], NULL);
+    }
+
+    rx_ring_destroy(&shared->ring);
+    free(shared->threads);
+    free(shared);
+}
+
+static void *
+rx_bench_producer_run(void *arg)
+{
+    struct rx_bench_producer *producer = arg;
+    struct rx_task *task;
+
+    for (size_t i = 0; i < producer->ntasks; i++)
+    {
+        task = &producer->tasks[i].task;
+
+        if (producer->pool->submit(producer->pool, task) != RX_OK)
+        {
+            task->handle(task->arg);
+            producer->ninline++;
+        }
+    }
+
+    while (atomic_load_explicit(&producer->done, memory_order_acquire) <
+           producer->ntasks)
+    {
+        sched_yield();
+    }
+
+    return NULL;
+}
+
+static double
+rx_bench_now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+rx_bench_run(struct rx_bench_pool *pool, size_t nthreads, size_t nproducers)
+{
+    struct rx_bench_producer *producers;
+    size_t i, j, ninline = 0;
+    double start, elapsed;
+
+    producers = aligned_alloc(
+        _Alignof(struct rx_bench_producer),
+        nproducers * sizeof(struct rx_bench_producer)
+    );
+
+    if (producers == NULL)
+    {
+        return RX_ERROR;
+    }
+
+    for (i = 0; i < nproducers; i++)
+    {
+        producers[i].pool    = pool;
+        producers[i].ntasks  = ntasks;
+        producers[i].ninline = 0;
+        producers[i].tasks   = calloc(ntasks, sizeof(struct rx_bench_task));
+
+        atomic_init(&producers[i].done, 0);
+
+        if (producers[i].tasks == NULL)
+        {
+            return RX_ERROR;
+        }
+
+        for (j = 0; j < ntasks; j++)
+        {
+            producers[i].tasks[j].task.handle = rx_bench_pool_work;
+            producers[i].tasks[j].task.arg    = &producers[i].tasks[j];
+            producers[i].tasks[j].producer    = &producers[i];
+        }
+    }
+
+    if (pool->init(pool, nthreads) != RX_OK)
+    {
+        fprintf(stderr, "%s: cannot start %zu workers\n", pool->name, nthreads);
+        return RX_ERROR;
+    }
+
+    start = rx_bench_now();
+
+    for (i = 0; i < nproducers; i++)
+    {
+        pthread_create(
+            &producers[i].thread, NULL, rx_bench_producer_run, &producers[i]
+        );
+    }
+
+    for (i = 0; i < nproducers; i++)
+    {
+        pthread_join(producers[i].thread, NULL);
+        ninline += producers[i].ninline;
+    }
+
+    elapsed = rx_bench_now() - start;
+
+    pool->destroy(pool);
+
+    printf(
+        "%-10s %8zu %10zu %14.0f %10.1f %9zu\n", pool->name, nthreads,
+        nproducers, nproducers * ntasks / elapsed,
+        elapsed * 1e9 / (nproducers * ntasks), ninline
+    );
+
+    for (i = 0; i < nproducers; i++)
+    {
+        free(producers[i].tasks);
+    }
+
+    free(producers);
+
+    return RX_OK;
+}
+
+int
+main(int argc, const char *argv[])
+{
+    static struct rx_bench_pool pools[] = {
+        {
+            .name    = "shared",
+            .init    = rx_bench_shared_init,
+            .submit  = rx_bench_shared_submit,
+            .destroy = rx_bench_shared_destroy,
+        },
+        {
+            .name    = "stealing",
+            .init    = rx_bench_stealing_init,
+            .submit  = rx_bench_stealing_submit,
+            .destroy = rx_bench_stealing_destroy,
+        },
+    };
+    static const size_t threads[]   = {8, 32, 64};
+    static const size_t producers[] = {1, 4};
+
+    if (argc > 1 && (ntasks = strtoul(argv[1], NULL, 10)) == 0)
+    {
+        fprintf(stderr, "Usage: %s [tasks per producer]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf(
+        "%-10s %8s %10s %14s %10s %9s\n", "pool", "threads", "producers",
+        "tasks/s", "ns/task", "inline"
+    );
+
+    for (size_t p = 0; p < sizeof(producers) / sizeof(producers[0]); p++)
+    {
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++)
+        {
+            for (size_t i = 0; i < sizeof(pools) / sizeof(pools[0]); i++)
+            {
+                if (rx_bench_run(&pools[i], threads[t], producers[p]) != RX_OK)
+                {
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
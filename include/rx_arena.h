@@ -0,0 +1,106 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __RX_ARENA_H__
+#define __RX_ARENA_H__ 1
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+/* Size of the blocks an arena allocates from */
+#define RX_ARENA_BLOCK_SIZE 16384 /* 16KB */
+
+struct rx_arena_block
+{
+    struct rx_arena_block *next;
+
+    /* Number of bytes available in `data` */
+    size_t size;
+
+    /* Aligned storage of the block */
+    max_align_t data[];
+};
+
+/* The arena structure
+
+   An arena is a bump-pointer allocator for objects that share the same
+   lifetime. Every connection owns one: the request, the responses and
+   everything they point to (header lists, redirect locations, rendered pages
+   and response buffers) are allocated from it, and are released all at once
+   by `rx_arena_reset()` when the connection is cleaned up after its responses
+   have been sent.
+
+   Blocks of `RX_ARENA_BLOCK_SIZE` bytes are kept across resets, so a
+   connection that serves similar requests stops calling `malloc()` after the
+   first one. Larger blocks, made for allocations that do not fit into a
+   regular block, are released on reset.
+
+   An arena is not thread-safe. The connection is only ever used by one
+   thread at a time (the event loop or the worker processing it), and the
+   arena follows the same ownership.
+ */
+struct rx_arena
+{
+    /* Blocks of the arena, the block in use first */
+    struct rx_arena_block *blocks;
+
+    /* Blocks that have been filled since the last reset */
+    struct rx_arena_block *used;
+
+    /* Free space of the block in use */
+    char *pos;
+    char *end;
+};
+
+/* Initialize an empty arena. No memory is allocated until the first
+   allocation. */
+void
+rx_arena_init(struct rx_arena *arena);
+
+/* Allocate `size` bytes aligned for any type, or return `NULL` if the memory
+   is exhausted */
+void *
+rx_arena_alloc(struct rx_arena *arena, size_t size);
+
+/* Copy `len` bytes of `str` into the arena and terminate them with a null
+   byte */
+char *
+rx_arena_strndup(struct rx_arena *arena, const char *str, size_t len);
+
+/* Format a string into the arena like `asprintf()`
+
+   The formatted string is stored in `strp`. Return the length of the string,
+   or `-1` if the memory is exhausted.
+ */
+int
+rx_arena_sprintf(struct rx_arena *arena, char **strp, const char *fmt, ...);
+
+/* Release every allocation of the arena at once */
+void
+rx_arena_reset(struct rx_arena *arena);
+
+/* Release the memory of the arena */
+void
+rx_arena_destroy(struct rx_arena *arena);
+
+#endif /* __RX_ARENA_H__ */
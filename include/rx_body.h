@@ -0,0 +1,111 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __RX_BODY_H__
+#define __RX_BODY_H__ 1
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+/* Most hexadecimal digits in the size of a chunk, which keeps the size from
+   overflowing */
+#define RX_CHUNKED_MAX_DIGITS 15
+
+enum rx_chunked_state
+{
+    /* At the size of a chunk, and in it */
+    RX_CHUNKED_STATE_SIZE,
+    RX_CHUNKED_STATE_SIZE_DIGITS,
+
+    /* In the extensions after the size, which are ignored */
+    RX_CHUNKED_STATE_EXTENSION,
+
+    /* After the CR that ends the size line */
+    RX_CHUNKED_STATE_SIZE_LF,
+
+    /* In the data of a chunk, and after it */
+    RX_CHUNKED_STATE_DATA,
+    RX_CHUNKED_STATE_DATA_CR,
+    RX_CHUNKED_STATE_DATA_LF,
+
+    /* After the last chunk: at a trailer field or the empty line, in a
+       trailer field, which is ignored, and after the CR of either */
+    RX_CHUNKED_STATE_TRAILER,
+    RX_CHUNKED_STATE_TRAILER_FIELD,
+    RX_CHUNKED_STATE_TRAILER_LF,
+    RX_CHUNKED_STATE_LAST_LF,
+
+    RX_CHUNKED_STATE_DONE,
+    RX_CHUNKED_STATE_INVALID,
+};
+
+typedef enum rx_chunked_state rx_chunked_state_t;
+
+/* Decoder of a body sent with `Transfer-Encoding: chunked`
+
+   The body may arrive split anywhere, even inside the size of a chunk, so
+   the decoder keeps where it is between the parts.
+ */
+struct rx_chunked
+{
+    rx_chunked_state_t state;
+
+    /* Size of the chunk being read, or the part of it still to come */
+    size_t size;
+
+    /* Number of digits of the size read so far */
+    size_t digits;
+};
+
+/* Consumer of the body of a request, which is handed the body part by part
+   as it arrives instead of all at once
+
+   Return `RX_ERROR` to refuse the body.
+ */
+typedef int (*rx_body_sink_t)(
+    struct rx_request *req, const char *data, size_t len
+);
+
+void
+rx_chunked_init(struct rx_chunked *chunked);
+
+/* Decode the next `len` bytes of a chunked body, in place
+
+   The data of the chunks is moved to the front of `buffer`, over the sizes
+   and line breaks around it, and `*decoded` is set to its length. Every
+   byte is looked at once, however the body is split between the calls.
+
+   Returns `RX_AGAIN` when the `len` bytes are all part of the body and more
+   are needed, and `RX_OK` once the last chunk and the trailer have been read.
+   The bytes after the body are then moved right after the decoded data, and
+   `*consumed` is set to the number of bytes of the body that were read.
+   Returns `RX_ERROR` as soon as the body turns out to be malformed. Both
+   results are final.
+ */
+int
+rx_chunked_decode(
+    struct rx_chunked *chunked, char *buffer, size_t len, size_t *decoded,
+    size_t *consumed
+);
+
+#endif /* __RX_BODY_H__ */
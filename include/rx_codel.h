@@ -0,0 +1,87 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __RX_CODEL_H__
+#define __RX_CODEL_H__ 1
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+/* Defaults from CoDel, in nanoseconds */
+#define RX_CODEL_DEFAULT_TARGET   5000000ULL
+#define RX_CODEL_DEFAULT_INTERVAL 100000000ULL
+
+/* Admission control on the delay tasks spend in a queue
+
+   After CoDel, the controller watches the smallest queueing delay seen over
+   each interval. A queue that holds a burst drains within an interval, so
+   its smallest delay falls back under the target. A queue that stays above
+   the target for a whole interval holds a standing backlog, and the queue is
+   overloaded until an interval passes with a delay under the target again.
+
+   Rather than dropping at an increasing rate like CoDel does for packets,
+   an overloaded queue sheds every task that has waited more than twice the
+   target. A client then gets a quick refusal instead of a late answer, while
+   the tasks that got through quickly are still served.
+
+   Any number of threads may feed delays to the same controller. The state is
+   only updated with atomic operations, and a sample that races with the end
+   of an interval is simply counted in the next one.
+ */
+struct rx_codel
+{
+    /* Delay a queue may keep for a whole interval, in nanoseconds, or `0`
+       to never shed */
+    uint64_t target;
+
+    /* Length of an interval, in nanoseconds */
+    uint64_t interval;
+
+    /* End of the current interval */
+    _Atomic uint64_t deadline;
+
+    /* Smallest delay seen during the current interval */
+    _Atomic uint64_t min_delay;
+
+    /* Set when an interval has ended, until the next delay starts the
+       minimum of the new interval */
+    _Atomic int reset;
+
+    _Atomic int overloaded;
+};
+
+void
+rx_codel_init(struct rx_codel *codel, uint64_t target, uint64_t interval);
+
+/* Record that a task taken from the queue at `now` waited `delay`
+
+   Both values are in nanoseconds. Returns whether the task should be shed.
+ */
+int
+rx_codel_shed(struct rx_codel *codel, uint64_t now, uint64_t delay);
+
+/* Current time on the monotonic clock, in nanoseconds */
+uint64_t
+rx_codel_now();
+
+#endif /* __RX_CODEL_H__ */
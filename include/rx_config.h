@@ -28,8 +28,14 @@
 
 /* ISO C standard libraries */
 #include <assert.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <limits.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -38,11 +44,15 @@
 /* POSIX standard libraries */
 #include <errno.h>
 #include <fcntl.h>
+#include <getopt.h>
 #include <pthread.h>
+#include <sched.h>
 #include <semaphore.h>
 #include <signal.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 /* POSIX socket libraries */
@@ -52,9 +62,18 @@
 #include <sys/socket.h>
 
 /* Linux-specific libraries */
+#include <linux/futex.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/mman.h>
 #include <sys/sendfile.h>
+#include <sys/syscall.h>
+
+/* x86 intrinsics, for the code paths that are picked at run time */
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define RX_HAVE_X86_INTRINSICS 1
+#endif
 
 #define NOOP(x) (void)x
 
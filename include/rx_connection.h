@@ -26,10 +26,27 @@
 
 #include <rx_config.h>
 #include <rx_core.h>
+#include <rx_arena.h>
+#include <rx_body.h>
+#include <rx_mpsc.h>
+#include <rx_task.h>
+#include <rx_timer.h>
 
 #define RX_HEADER_BUFFER_SIZE 8192    /* 8KB */
 #define RX_BODY_BUFFER_SIZE   1048576 /* 1MB*/
 
+/* Events a client socket is watched for while waiting for requests.
+   `EPOLLRDHUP` reports a client that closes its side while a worker serves
+   it, so the connection is not kept open after the responses. */
+#define RX_CONNECTION_EVENTS (EPOLLIN | EPOLLET | EPOLLRDHUP)
+
+/* Size of the numeric client address: an IPv6 address in brackets, a colon
+   and a port */
+#define RX_CONNECTION_PEER_SIZE (INET6_ADDRSTRLEN + sizeof("[]:65535"))
+
+/* Maximum number of pipelined requests processed in one batch */
+#define RX_CONNECTION_MAX_PIPELINE 32
+
 typedef enum rx_connection_state
 {
     RX_CONNECTION_STATE_READY,
@@ -47,26 +64,31 @@ typedef enum rx_connection_state
    server. The structure contains a request and response structure, as well as
    information about the client that is needed to process the request and
    construct the response successfully.
+
+   Connections are allocated from the slab of their event loop. The fields
+   used on every event come first, and the client address, which is only
+   needed for logging, is kept at the end of the structure. The address is
+   never resolved to a hostname, so accepting a connection does not wait on
+   DNS.
  */
 struct rx_connection
 {
-    /* File descriptor for epoll instance */
-    int efd;
-
     /* Socket from client connection */
     int fd;
 
-    /* Address of the client */
-    struct sockaddr addr;
+    /* Events the socket is registered for in the epoll instance of the loop
 
-    /* Length of the address */
-    socklen_t addr_len;
+        Only the loop thread changes the registration, and only when it
+        differs from this value. */
+    uint32_t events;
 
-    /* Client's hostname */
-    char host[NI_MAXHOST];
+    /* Whether the client sent more data while a worker was serving the
+       connection, so the socket has to be read once the responses are sent */
+    int readable;
 
-    /* Client's port */
-    char port[NI_MAXSERV];
+    /* Whether the client has closed its side of the connection, so no
+       request follows the ones already in the buffer */
+    int eof;
 
     /* The current state of the connection
 
@@ -81,11 +103,27 @@ struct rx_connection
 
     size_t task_num;
 
-    /* Buffer to store HTTP Header part
+    /* Buffer to store the received requests
+
+        The buffer is taken from the buffer pool of the event loop when the
+        first bytes of a request arrive. It starts small and only grows to a
+        larger size class when a request does not fit, up to
+        `RX_HEADER_BUFFER_SIZE + RX_BODY_BUFFER_SIZE` bytes. It goes back to
+        the pool when the connection is idle, in which case it is `NULL`. */
+    char *buffer_start;
+
+    /* Capacity of the buffer, including the terminating null byte */
+    size_t buffer_cap;
+
+    /* Pointer to mark the beginning of the request being processed
 
-        If the buffer exceeds (RX_HDR_MAXSIZE) bytes, which is 8912,
-        the server will return 413 (Request Entity Too Large). */
-    char buffer_start[RX_HEADER_BUFFER_SIZE + RX_BODY_BUFFER_SIZE];
+        With pipelining, the buffer can hold several requests back to back.
+        Requests before `request_start` have been processed already. */
+    char *request_start;
+
+    /* Pointer to mark the end of the request being processed, which is also
+       the beginning of the next pipelined request */
+    char *request_end;
 
     /* Pointer to mark the end of the header */
     char *header_end;
@@ -100,12 +138,106 @@ struct rx_connection
 
         This field should be only used for POST/PUT methods, and ignored in
         other methods. If a POST/PUT request misses the `Content-Length`
-        header, a `400` response should be returned instead.*/
+        header, a `400` response should be returned instead.
+
+        The event loop reads it from the header of the request being received
+        to know when the whole body has arrived. For a chunked body, it is the
+        number of bytes decoded so far. */
     size_t content_length;
 
+    /* Whether the body is sent with `Transfer-Encoding: chunked`
+
+        The body is then decoded in place as it arrives: the data of the
+        chunks follows `body_start`, and the bytes that have not been decoded
+        yet follow the data. */
+    int chunked;
+    struct rx_chunked chunks;
+
+    /* Consumer of the body, when the route of the request takes its body as
+       it arrives (see `rx_route.body`) */
+    rx_body_sink_t body_sink;
+
+    /* Number of bytes of the body handed to `body_sink` and dropped from the
+       buffer
+
+        The rest of the body, up to `content_length`, follows `body_start`. */
+    size_t body_consumed;
+
+    /* Status the request is refused with because of its body
+
+        A body with an unsupported transfer coding, a malformed one, one too
+        large to be kept in the buffer or one refused by its consumer is not
+        read any further, so the connection is closed after the response. */
+    rx_http_status_t body_status;
+
+    /* Start line and header fields of the request at `request_start`
+
+        The head is tokenized as it arrives, and each pass resumes where the
+        previous one stopped, so a head that arrives in many small parts is
+        only looked at once. The tokens are allocated from the arena when the
+        first bytes of the request are looked at. */
+    struct rx_tokens *tokens;
+
     struct rx_request *request;
 
     struct rx_response *response;
+
+    /* Queue of constructed responses waiting to be sent, in request order
+
+        The responses are linked through `rx_response.next` and flushed to the
+        socket together with a single vectored write. */
+    struct rx_response *resp_queue_head;
+    struct rx_response *resp_queue_tail;
+
+    /* Number of requests that have been served on this connection */
+    size_t nrequests;
+
+    /* Event loop that owns the connection */
+    struct rx_event_loop *loop;
+
+    /* Task that hands the connection to the thread pool
+
+       A connection is in the queue of the pool at most once, so the queue
+       carries a pointer to this task and submitting allocates nothing. */
+    struct rx_task task;
+
+    /* Thread pool the connection was last handed to */
+    rx_workload_t workload;
+
+    /* Set by the event loop when the client goes away while a worker holds
+       the connection. The worker stops serving it, and the loop releases the
+       connection once it is handed back, so the memory is never freed under
+       the worker. */
+    _Atomic int cancelled;
+
+    /* Link in the completion queue of the loop, used by the worker that
+       served the connection to hand it back */
+    struct rx_mpsc_node completion;
+
+    /* Deadline of the connection in the timer wheel of its event loop
+
+        Only one deadline applies at a time, depending on what the server is
+        waiting for: the request header, the request body, the client to read
+        the response, or the next request on a persistent connection. */
+    struct rx_timer timer;
+
+    /* Memory of the request being served and of its responses
+
+        The arena is reset by `rx_connection_cleanup()`, which releases every
+        allocation made while serving the request at once. */
+    struct rx_arena arena;
+
+    /* Address of the client */
+    struct sockaddr_storage addr;
+
+    /* Length of the address */
+    socklen_t addr_len;
+
+    /* Numeric form of the client address, as `host:port`
+
+        The address is only formatted when it is first needed, by
+        `rx_connection_peer()`. It is empty until then. */
+    char peer[RX_CONNECTION_PEER_SIZE];
 };
 
 /* Initialize and establish connection between a client and the server
@@ -116,10 +248,18 @@ struct rx_connection
  */
 int
 rx_connection_init(
-    struct rx_connection *conn, int efd, int fd, struct sockaddr addr,
-    socklen_t addr_len
+    struct rx_connection *conn, struct rx_event_loop *loop, int fd,
+    const struct sockaddr *addr, socklen_t addr_len
 );
 
+/* Get the numeric address of the client of a connection, as `host:port`
+
+   IPv6 addresses are enclosed in brackets. The string is formatted on the
+   first call and cached in the connection.
+ */
+const char *
+rx_connection_peer(struct rx_connection *conn);
+
 /* Deallocate and free memory of a connection
 
    This function is used by the server to deallocate and free memory of a
@@ -134,6 +274,11 @@ rx_connection_free(struct rx_connection *conn);
    This function is used to reset the state of connection. Instead of freeing
    and reallocating new memory, the server can reuse the connection object when
    the communication is done but the connection is still alive (keep-alive).
+
+   The request, the responses and everything allocated for them are released
+   by resetting the arena of the connection, which keeps its memory for the
+   next request. Bytes of pipelined requests that have not been processed yet
+   are moved to the beginning of the buffer.
  */
 void
 rx_connection_cleanup(struct rx_connection *conn);
@@ -151,4 +296,136 @@ rx_connection_cleanup(struct rx_connection *conn);
 void *
 rx_connection_process(struct rx_connection *conn);
 
+/* Process every complete request in the buffer of a connection
+
+   This function is the task handler submitted to the thread pool. It calls
+   `rx_connection_process()` for each pipelined request, starting from
+   `request_start`, and appends the responses to the response queue in the
+   same order. Processing stops at an incomplete request, after a response
+   that closes the connection, after `RX_CONNECTION_MAX_PIPELINE` requests,
+   or before a request for another pool than `workload`.
+ */
+void *
+rx_connection_process_batch(struct rx_connection *conn);
+
+/* Process the complete requests of a connection on the event loop thread
+
+   This function works like `rx_connection_process_batch()`, except that it
+   stops before any request that `rx_connection_workload()` gives a thread
+   pool, so the rest of the batch can be handed over to that pool. The first
+   request should run on the loop. Returns the number of processed requests.
+ */
+size_t
+rx_connection_process_inline(struct rx_connection *conn);
+
+/* Tell the worker that holds a connection that its client has gone away
+
+   Only the event loop of the connection calls this function.
+ */
+void
+rx_connection_cancel(struct rx_connection *conn);
+
+/* Handle the `events` that epoll reports for the socket of a connection when
+   its client goes away
+
+   Returns `RX_ERROR` when the socket has failed or is shut down both ways,
+   and the connection is to be closed. Returns `RX_AGAIN` when a worker holds
+   the connection: the worker is cancelled, and the connection is released
+   once it is handed back. Otherwise returns `RX_OK`, the events are left to
+   the reading path. A client that has only closed its side (`EPOLLRDHUP`)
+   still gets the requests it sent served, and the connection is closed after
+   their responses. Only the event loop of the connection calls this
+   function.
+ */
+int
+rx_connection_hangup(struct rx_connection *conn, uint32_t events);
+
+/* Whether the client of a connection has gone away since it was handed to a
+   worker
+
+   Workers check it before each request and before the costly steps of
+   serving one, so a request nobody waits for is dropped at the next check.
+ */
+int
+rx_connection_is_cancelled(const struct rx_connection *conn);
+
+/* Refuse the complete requests of a connection
+
+   The prepared response becomes a `503 Service Unavailable` and is appended
+   to the response queue. It closes the connection, so the requests left in
+   the buffer are dropped without being parsed. This function is the shedding
+   handler of the task submitted to the thread pool.
+ */
+void *
+rx_connection_shed(struct rx_connection *conn);
+
+/* Where serving the request at `request_start` runs
+
+   Only the method and the path of the request line are looked at, to find
+   the route with `rx_route_workload()`. Requests that end up in a `4xx`
+   response are cheap to answer and run on the event loop. The header of the
+   request has to be complete.
+ */
+rx_workload_t
+rx_connection_workload(const struct rx_connection *conn);
+
+/* Find the next complete request in the buffer
+
+   Return `RX_OK` if a complete request (header and body) starts at
+   `request_start`, or `RX_AGAIN` if more data is needed. When the header is
+   complete, `header_end`, `body_start` and `content_length` are set;
+   otherwise `body_start` is left at `request_start`.
+
+   The header is tokenized into `tokens` as it arrives, and the bytes looked
+   at by the previous calls are skipped. A malformed header is reported as a
+   complete request without a body as soon as it is found, so that it is
+   answered with a `400` without waiting for the rest of it.
+
+   Return `RX_ERROR` if the tokens cannot be allocated.
+
+   The body is framed by `Content-Length`, or decoded as it arrives when it
+   is chunked. While the event loop reads it, in the state
+   `RX_CONNECTION_STATE_READING_BODY`, the parts that have arrived are handed
+   to `body_sink`, if the route has one, and dropped from the buffer. A body
+   that cannot be read or kept is reported as complete, with `body_status`
+   set, so that the request is rejected by `rx_connection_process()` instead
+   of waiting for data that will never be read.
+ */
+int
+rx_connection_find_request(struct rx_connection *conn);
+
+/* Check if a connection can be kept open after the current response
+
+   A connection is persistent when keep-alive is enabled in the server, the
+   client has not asked to close it, the request was well-formed, and the
+   connection has not reached the maximum number of requests.
+ */
+int
+rx_connection_keep_alive(struct rx_connection *conn);
+
+/* Allocate the request and the response of a connection if it has none
+
+   Both are allocated from the arena of the connection, and released when the
+   connection is cleaned up after the responses have been sent.
+ */
+int
+rx_connection_prepare(struct rx_connection *conn);
+
+/* Make room for `len` more bytes at the end of the buffer of a connection
+
+   The buffer is taken from the pool of the event loop if the connection has
+   none, or moved to a larger size class if the received bytes would not fit.
+   The pointers into the buffer are moved along with it. Return `RX_ERROR` if
+   the request would exceed the largest buffer or the memory is exhausted.
+ */
+int
+rx_connection_reserve(struct rx_connection *conn, size_t len);
+
+/* Give the buffer of an idle connection back to the pool of its event loop
+
+   The buffer is only released when it holds no unprocessed bytes.
+ */
+void
+rx_connection_release_buffer(struct rx_connection *conn);
+
 #endif /* __RX_CONNECTION_H__ */
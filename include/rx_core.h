@@ -27,7 +27,9 @@
 #include <rx_config.h>
 
 struct rx_log;
+struct rx_arena;
 struct rx_event;
+struct rx_event_loop;
 struct rx_server;
 struct rx_client;
 struct rx_request;
@@ -41,6 +43,15 @@ struct rx_ring;
 struct rx_qlist;
 struct rx_route;
 struct rx_thread_pool;
+struct rx_timer;
+struct rx_timer_wheel;
+struct rx_slab;
+struct rx_buffer_pool;
+struct rx_mpsc;
+struct rx_mpsc_node;
+struct rx_codel;
+struct rx_chunked;
+struct rx_tokens;
 struct rx_view;
 
 typedef struct rx_string rx_str_t;
@@ -71,8 +82,11 @@ enum rx_http_status_enum
     RX_HTTP_STATUS_CODE_BAD_REQUEST            = 400,
     RX_HTTP_STATUS_CODE_NOT_FOUND              = 404,
     RX_HTTP_STATUS_CODE_METHOD_NOT_ALLOWED     = 405,
+    RX_HTTP_STATUS_CODE_PAYLOAD_TOO_LARGE      = 413,
     RX_HTTP_STATUS_CODE_UNSUPPORTED_MEDIA_TYPE = 415,
     RX_HTTP_STATUS_CODE_INTERNAL_SERVER_ERROR  = 500,
+    RX_HTTP_STATUS_CODE_NOT_IMPLEMENTED        = 501,
+    RX_HTTP_STATUS_CODE_SERVICE_UNAVAILABLE    = 503,
 };
 
 /* List of HTTP status messages associated with the enum `rx_http_status_enum`
@@ -88,8 +102,11 @@ enum rx_http_status_enum
 #define RX_HTTP_STATUS_MSG_BAD_REQUEST            "Bad Request"
 #define RX_HTTP_STATUS_MSG_NOT_FOUND              "Not Found"
 #define RX_HTTP_STATUS_MSG_METHOD_NOT_ALLOWED     "Method Not Allowed"
+#define RX_HTTP_STATUS_MSG_PAYLOAD_TOO_LARGE      "Payload Too Large"
 #define RX_HTTP_STATUS_MSG_UNSUPPORTED_MEDIA_TYPE "Unsupported Media Type"
 #define RX_HTTP_STATUS_MSG_INTERNAL_SERVER_ERROR  "Internal Server Error"
+#define RX_HTTP_STATUS_MSG_NOT_IMPLEMENTED        "Not Implemented"
+#define RX_HTTP_STATUS_MSG_SERVICE_UNAVAILABLE    "Service Unavailable"
 
 /* Should be used when parsing requests or reading files for fast comparison. */
 
@@ -160,12 +177,40 @@ enum rx_http_mime_enum
 
 #define RX_MAX_URI_LENGTH 2048
 
+/* Classes of work that the routes declare, each served by its own thread pool
+
+   Keeping the classes apart is a bulkhead: a route that burns CPU fills the
+   queues and occupies the workers of its own pool only, so requests of the
+   other classes are still picked up on time.
+ */
+enum rx_workload_enum
+{
+    /* Cheap handlers, served directly on the event loop thread */
+    RX_WORKLOAD_LOOP = -1,
+
+    /* Pages read from disk and rendered */
+    RX_WORKLOAD_PAGES,
+
+    /* Authentication, where a handler may hash passwords */
+    RX_WORKLOAD_AUTH,
+
+    RX_WORKLOAD_MAX,
+};
+
 typedef enum rx_http_status_enum rx_http_status_t;
 typedef enum rx_http_mime_enum rx_http_mime_t;
+typedef enum rx_workload_enum rx_workload_t;
 
+#include <rx_arena.h>
+#include <rx_body.h>
+#include <rx_codel.h>
 #include <rx_connection.h>
+#include <rx_event.h>
 #include <rx_file.h>
+#include <rx_header.h>
 #include <rx_log.h>
+#include <rx_mpsc.h>
+#include <rx_pool.h>
 #include <rx_qlist.h>
 #include <rx_request.h>
 #include <rx_response.h>
@@ -174,16 +219,135 @@ typedef enum rx_http_mime_enum rx_http_mime_t;
 #include <rx_string.h>
 #include <rx_task.h>
 #include <rx_thread.h>
+#include <rx_timer.h>
+#include <rx_tokenizer.h>
 #include <rx_view.h>
 
-extern int server_fd, client_fd, epoll_fd, n, i;
+/* Options that can be configured from the command line
+
+   The options are loaded once by `rx_core_init()` before any other component
+   is initialized, and they are read-only afterwards.
+ */
+struct rx_core_options
+{
+    /* Number of event loops (reactors) to run
+
+       Each event loop runs on its own thread with its own listening socket and
+       epoll instance. The value `0` means one loop per online CPU.
+
+       Command line: `-l <n>`, `--loops=<n>` (default: 1)
+     */
+    size_t nloops;
+
+    /* Number of worker threads in a thread pool that sets none
+
+       The value `0` means one worker per online CPU.
+
+       Command line: `-t <n>`, `--threads=<n>` (default: 0)
+     */
+    size_t nthreads;
+
+    /* Number of tasks the queue of each worker holds in a thread pool that
+       sets none
+
+       The value is rounded up to a power of two. When every queue of a pool
+       is full, the event loops answer its requests with `503 Service
+       Unavailable`.
+
+       Command line: `--queue-depth=<n>` (default: 256)
+     */
+    size_t queue_depth;
+
+    /* Thread pool of each workload, by `rx_workload_t`
+
+       A pool whose `nthreads` or `depth` is `0` takes `-t` or `--queue-depth`.
+       `priority` is the nice value of the workers, so a pool of background
+       work can yield the CPU to the others.
+
+       Command line: `--pool=<name>:<threads>[:<depth>[:<priority>]]`, once
+       per pool (default: `pages:0:0:0`, `auth:0:0:5`)
+     */
+    struct rx_thread_pool_config pools[RX_WORKLOAD_MAX];
+
+    /* Whether to pin each worker thread to a CPU
+
+       Workers are pinned to the CPUs the process may run on, one after the
+       other. Each worker allocates its queue once pinned, so on a NUMA
+       system the queue sits on the node of the worker.
+
+       Command line: `--affinity` (default: off)
+     */
+    int affinity;
+
+    /* Number of milliseconds requests may keep waiting in the queues
+
+       When the shortest wait over an interval of 100 milliseconds exceeds
+       this target, the workers answer the requests that waited more than
+       twice as long with `503 Service Unavailable`. The value `0` disables
+       load shedding.
+
+       Command line: `--queue-target=<ms>` (default: 5)
+     */
+    size_t queue_target;
+
+    /* Number of seconds an idle persistent connection is kept open
+
+       The value `0` disables keep-alive, so every connection is closed after
+       its first response.
+
+       Command line: `--keepalive-timeout=<secs>` (default: 5)
+     */
+    size_t keepalive_timeout;
+
+    /* Maximum number of requests served on one persistent connection
+
+       Command line: `--keepalive-requests=<n>` (default: 100)
+     */
+    size_t keepalive_requests;
+
+    /* Number of seconds a client has to send a complete request header
+
+       The value `0` disables the timeout.
+
+       Command line: `--header-timeout=<secs>` (default: 10)
+     */
+    size_t header_timeout;
+
+    /* Number of seconds the server waits between two parts of a request body
+
+       The value `0` disables the timeout.
+
+       Command line: `--body-timeout=<secs>` (default: 30)
+     */
+    size_t body_timeout;
+
+    /* Number of seconds the server waits for a client to read a response
+
+       The timer restarts whenever the client accepts more bytes, so it only
+       closes connections that have stalled. The value `0` disables the
+       timeout.
+
+       Command line: `--send-timeout=<secs>` (default: 30)
+     */
+    size_t send_timeout;
+
+    /* Whether to serve the routes that only exist to try the server out,
+       `GET /stats` and `POST /upload`
+
+       Command line: `--demo-routes` (default: off)
+     */
+    int demo_routes;
+};
+
+extern int server_fd;
 extern socklen_t server_len;
-extern char msg[1024], host[NI_MAXHOST], service[NI_MAXSERV];
+extern char host[NI_MAXHOST], service[NI_MAXSERV];
 
+extern struct rx_core_options rx_core_opts;
+extern struct rx_event_loop *rx_loops;
+extern size_t rx_nloops;
 extern struct rx_view rx_view_engine;
-extern struct rx_ring rx_ring_buffer;
-extern struct rx_thread_pool rx_tp;
-extern struct epoll_event ev, events[RX_MAX_EVENTS];
+extern struct rx_thread_pool rx_tp[RX_WORKLOAD_MAX];
 extern struct sockaddr server;
 
 void
@@ -199,18 +363,18 @@ void
 rx_core_set_nonblocking();
 
 void
-rx_core_epoll_create();
+rx_core_load_event_loops();
 
 void
 rx_core_load_view();
 
-void
-rx_core_load_ring_buffer();
-
 void
 rx_core_load_thread_pool();
 
 void
 rx_core_boot();
 
+int
+rx_core_run();
+
 #endif /* __RX_CORE_H__ */
@@ -0,0 +1,134 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __RX_EVENT_H__
+#define __RX_EVENT_H__ 1
+
+#include <rx_config.h>
+#include <rx_core.h>
+#include <rx_mpsc.h>
+#include <rx_pool.h>
+#include <rx_timer.h>
+
+/* How long (in milliseconds) the listening socket is left alone after the
+   process ran out of file descriptors */
+#define RX_EVENT_LOOP_ACCEPT_BACKOFF 100
+
+/* The event loop structure
+
+   The `rx_event_loop` represents one reactor: a listening socket, an epoll
+   instance that monitors it together with all the client sockets accepted
+   from it, and the scratch state that the loop needs while dispatching events.
+
+   In multi-reactor mode, the server runs one event loop per thread. Every loop
+   owns a separate listening socket bound to the same address (the sockets are
+   created with `SO_REUSEPORT`), so the kernel balances new connections across
+   the loops and no state has to be shared between them except the thread pool.
+
+   Workers of the thread pool never touch the epoll instance. They hand the
+   connections they have served back to the loop through its completion queue,
+   and the loop sends the responses and changes the registrations itself.
+ */
+struct rx_event_loop
+{
+    /* Index of the loop (loop 0 runs on the main thread) */
+    size_t id;
+
+    /* Thread that runs the loop */
+    pthread_t thread;
+
+    /* Listening socket owned by this loop */
+    int server_fd;
+
+    /* File descriptor for epoll instance */
+    int epoll_fd;
+
+    /* Socket from the last accepted client connection */
+    int client_fd;
+
+    /* Event used to register file descriptors to `epoll_fd` */
+    struct epoll_event ev;
+
+    /* List of events returned by `epoll_wait()` */
+    struct epoll_event events[RX_MAX_EVENTS];
+
+    /* Buffer to store the error message before the loop exits */
+    char msg[1024];
+
+    /* Deadlines of the connections owned by this loop
+
+        The wheel is driven by the `epoll_wait()` timeout, so it is only ever
+        touched from the loop thread and needs no locking. */
+    struct rx_timer_wheel timers;
+
+    /* Connections accepted by this loop */
+    struct rx_slab conns;
+
+    /* Request buffers of the connections owned by this loop */
+    struct rx_buffer_pool buffers;
+
+    /* Connections whose requests have been served by a worker */
+    struct rx_mpsc completions;
+
+    /* Event file descriptor that wakes the loop up when the completion queue
+       becomes non-empty */
+    int notify_fd;
+
+    /* Watches the listening socket again once the loop has backed off from
+       `accept()` for lack of file descriptors */
+    struct rx_timer accept_timer;
+};
+
+/* Initialize an event loop that listens on `server_fd`
+
+   This function creates a new epoll instance for the loop and registers the
+   listening socket to it. The socket should already be in non-blocking mode.
+ */
+int
+rx_event_loop_init(struct rx_event_loop *loop, size_t id, int server_fd);
+
+/* Run an event loop
+
+   This function has the signature of a thread routine so that it can be
+   passed to `pthread_create()` directly. It only returns when the loop fails,
+   and the return value is either `RX_OK_PTR` or `RX_ERROR_PTR`. A failed
+   loop is not destroyed: workers may still hold its connections and hand
+   them back to it.
+ */
+void *
+rx_event_loop_run(void *arg);
+
+/* Hand a connection served by a worker back to its event loop
+
+   This function is called from the worker threads. The loop is only woken up
+   when the completion queue was empty, so a batch of connections that finish
+   together costs one `write()` on the event file descriptor.
+ */
+int
+rx_event_loop_post(struct rx_event_loop *loop, struct rx_connection *conn);
+
+/* Close the file descriptors and release the memory owned by an event loop */
+void
+rx_event_loop_destroy(struct rx_event_loop *loop);
+
+#endif /* __RX_EVENT_H__ */
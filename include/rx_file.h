@@ -37,14 +37,17 @@ struct rx_file
     /* Flags that are used to open `fd` */
     int flags;
 
-    /* Absolute path to the directory that contains the opening file */
-    char *path;
+    /* Absolute path to the directory that contains the opening file
+
+       The path is not copied: it points to the string given to
+       `rx_file_open()`, which has to outlive the structure. */
+    const char *path;
 
     /* File name without extension */
-    char *name;
+    const char *name;
 
     /* Extension of the opening file */
-    char *ext;
+    const char *ext;
 
     /* MIME type of the extension respectively to HTTP standard */
     rx_http_mime_t mime;
@@ -52,6 +55,9 @@ struct rx_file
     /* Size of the opening file */
     size_t size;
 
+    /* Type and permissions of the opening file, as given by `fstat()` */
+    mode_t mode;
+
     /* Last modified time of the opening file
 
        This field is used to check if the file has been modified since
@@ -90,11 +96,13 @@ const char *
 rx_file_strmime(rx_http_mime_t mime);
 
 /* Open a file in `path` with `flags` and store the information in `fstruct`
+
+   The file name and extension in `fstruct` point into `path`.
  */
 int
 rx_file_open(struct rx_file *fstruct, const char *path, int flags);
 
-/* Close the opening file and free the associated memory in `fstruct`
+/* Close the opening file in `fstruct`
  */
 int
 rx_file_close(struct rx_file *fstruct);
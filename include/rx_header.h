@@ -0,0 +1,124 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __RX_HEADER_H__
+#define __RX_HEADER_H__ 1
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+/* Perfect hash of the request header names
+
+   A name is hashed from its length, its first character and the one before
+   its last, lowercased, which together tell every known name apart. The key
+   is multiplied by a constant found by search, and the top bits of the
+   product give one of `1 << RX_HEADER_HASH_BITS` slots. No two known names
+   share a slot, so a lookup is one multiplication and one comparison with
+   the only name that may match.
+
+   The slot table is built by the compiler with this macro. A name added to
+   the table that lands on a taken slot overrides an initializer, which
+   `-Wextra -Werror` turns into a build error; a new multiplier is then
+   needed.
+ */
+#define RX_HEADER_HASH_BITS       7
+#define RX_HEADER_HASH_MULTIPLIER 0xb201a8bdU
+
+#define RX_HEADER_SLOT(len, first, penultimate)                                \
+    ((uint32_t)(((uint32_t)(len) << 16 | (uint32_t)(u_char)(first) << 8 |     \
+                 (uint32_t)(u_char)(penultimate)) *                            \
+                RX_HEADER_HASH_MULTIPLIER) >>                                  \
+     (32 - RX_HEADER_HASH_BITS))
+
+/* Longest known name, `Access-Control-Request-Headers` */
+#define RX_HEADER_MAX_NAME_LENGTH 30
+
+/* Request headers the server knows by name */
+enum rx_header
+{
+    RX_HEADER_UNKNOWN,
+    RX_HEADER_ACCEPT,
+    RX_HEADER_ACCEPT_CHARSET,
+    RX_HEADER_ACCEPT_ENCODING,
+    RX_HEADER_ACCEPT_LANGUAGE,
+    RX_HEADER_ACCESS_CONTROL_REQUEST_HEADERS,
+    RX_HEADER_ACCESS_CONTROL_REQUEST_METHOD,
+    RX_HEADER_AUTHORIZATION,
+    RX_HEADER_CACHE_CONTROL,
+    RX_HEADER_CONNECTION,
+    RX_HEADER_CONTENT_ENCODING,
+    RX_HEADER_CONTENT_LENGTH,
+    RX_HEADER_CONTENT_TYPE,
+    RX_HEADER_COOKIE,
+    RX_HEADER_DATE,
+    RX_HEADER_DNT,
+    RX_HEADER_EXPECT,
+    RX_HEADER_FORWARDED,
+    RX_HEADER_FROM,
+    RX_HEADER_HOST,
+    RX_HEADER_IF_MATCH,
+    RX_HEADER_IF_MODIFIED_SINCE,
+    RX_HEADER_IF_NONE_MATCH,
+    RX_HEADER_IF_RANGE,
+    RX_HEADER_IF_UNMODIFIED_SINCE,
+    RX_HEADER_KEEP_ALIVE,
+    RX_HEADER_MAX_FORWARDS,
+    RX_HEADER_ORIGIN,
+    RX_HEADER_PRAGMA,
+    RX_HEADER_PRIORITY,
+    RX_HEADER_PROXY_AUTHORIZATION,
+    RX_HEADER_RANGE,
+    RX_HEADER_REFERER,
+    RX_HEADER_SEC_CH_UA,
+    RX_HEADER_SEC_CH_UA_MOBILE,
+    RX_HEADER_SEC_CH_UA_PLATFORM,
+    RX_HEADER_SEC_FETCH_DEST,
+    RX_HEADER_SEC_FETCH_MODE,
+    RX_HEADER_SEC_FETCH_SITE,
+    RX_HEADER_SEC_FETCH_USER,
+    RX_HEADER_TE,
+    RX_HEADER_TRAILER,
+    RX_HEADER_TRANSFER_ENCODING,
+    RX_HEADER_UPGRADE,
+    RX_HEADER_UPGRADE_INSECURE_REQUESTS,
+    RX_HEADER_USER_AGENT,
+    RX_HEADER_VIA,
+    RX_HEADER_X_FORWARDED_FOR,
+    RX_HEADER_X_FORWARDED_HOST,
+    RX_HEADER_X_FORWARDED_PROTO,
+    RX_HEADER_X_REQUESTED_WITH,
+    RX_HEADER_MAX,
+};
+
+typedef enum rx_header rx_header_t;
+
+/* Find the header called `name`, regardless of case, or return
+   `RX_HEADER_UNKNOWN` */
+rx_header_t
+rx_header_lookup(const char *name, size_t len);
+
+/* Canonical name of a known header, or `NULL` */
+const char *
+rx_header_name(rx_header_t header);
+
+#endif /* __RX_HEADER_H__ */
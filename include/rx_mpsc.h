@@ -0,0 +1,72 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __RX_MPSC_H__
+#define __RX_MPSC_H__ 1
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+/* A node of a multi-producer single-consumer queue
+
+   The node is embedded in the object that is queued, so pushing never
+   allocates. An object can only be in one queue at a time.
+ */
+struct rx_mpsc_node
+{
+    struct rx_mpsc_node *next;
+};
+
+/* The multi-producer single-consumer queue structure
+
+   Any number of threads push nodes with a compare-and-swap on `head`, and one
+   thread takes all of them at once with an exchange. Since the consumer never
+   pops a single node, the queue is not exposed to the ABA problem and needs
+   no lock. Nodes are taken in the order they were pushed.
+ */
+struct rx_mpsc
+{
+    /* Last pushed node, linked to the previous ones through `next` */
+    _Atomic(struct rx_mpsc_node *) head;
+};
+
+void
+rx_mpsc_init(struct rx_mpsc *queue);
+
+/* Push `node` to `queue`
+
+   Returns `1` if the queue was empty, in which case the consumer might have
+   to be woken up, or `0` otherwise.
+ */
+int
+rx_mpsc_push(struct rx_mpsc *queue, struct rx_mpsc_node *node);
+
+/* Take every node of `queue` and return the oldest one
+
+   The nodes are linked through `next` in the order they were pushed. The
+   function returns `NULL` if the queue is empty.
+ */
+struct rx_mpsc_node *
+rx_mpsc_take(struct rx_mpsc *queue);
+
+#endif /* __RX_MPSC_H__ */
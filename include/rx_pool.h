@@ -0,0 +1,132 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __RX_POOL_H__
+#define __RX_POOL_H__ 1
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+/* Number of objects allocated at once when a slab runs out of free objects */
+#define RX_SLAB_CHUNK_OBJECTS 64
+
+/* Number of size classes in a buffer pool */
+#define RX_BUFFER_POOL_CLASSES 5
+
+/* The slab structure
+
+   A slab hands out objects of one fixed size. Objects are carved out of
+   chunks of `RX_SLAB_CHUNK_OBJECTS` objects, and freed objects are kept in a
+   free list (linked through the objects themselves) to be reused by the next
+   allocation. Memory is only returned to the system when the slab is
+   destroyed.
+
+   A slab is not thread-safe. Each event loop owns its own slabs and only
+   uses them from the loop thread.
+ */
+struct rx_slab
+{
+    /* Size of one object, rounded up to the alignment of `max_align_t` */
+    size_t size;
+
+    /* Free objects, linked through their first bytes */
+    void *free;
+
+    /* Allocated chunks, linked through their first bytes */
+    void *chunks;
+
+    /* Number of objects that are currently handed out */
+    size_t nused;
+};
+
+/* A size class of a buffer pool */
+struct rx_buffer_class
+{
+    /* Size of every buffer in this class */
+    size_t size;
+
+    /* Maximum number of free buffers kept in this class */
+    size_t max_free;
+
+    /* Number of free buffers kept in this class */
+    size_t nfree;
+
+    /* Free buffers, linked through their first bytes */
+    void *free;
+};
+
+/* The buffer pool structure
+
+   A buffer pool hands out byte buffers in a few size classes, from 4KB up to
+   the largest request the server accepts. A buffer is taken from the
+   smallest class that is large enough, and is kept in the free list of its
+   class when it is given back, up to a limit per class.
+
+   Like the slab, a buffer pool is owned by one event loop and is not
+   thread-safe.
+ */
+struct rx_buffer_pool
+{
+    struct rx_buffer_class classes[RX_BUFFER_POOL_CLASSES];
+};
+
+/* Initialize a slab of objects of `size` bytes */
+void
+rx_slab_init(struct rx_slab *slab, size_t size);
+
+/* Allocate one object from a slab, or return `NULL` if the memory is
+   exhausted. The content of the object is undefined.
+ */
+void *
+rx_slab_alloc(struct rx_slab *slab);
+
+/* Give an object back to the slab it was allocated from */
+void
+rx_slab_free(struct rx_slab *slab, void *obj);
+
+/* Release the memory of all the objects of a slab at once */
+void
+rx_slab_destroy(struct rx_slab *slab);
+
+/* Initialize a buffer pool with the default size classes */
+void
+rx_buffer_pool_init(struct rx_buffer_pool *pool);
+
+/* Get a buffer that can hold at least `size` bytes
+
+   The actual capacity of the buffer is stored in `cap`. The function returns
+   `NULL` if `size` is larger than the largest class or the memory is
+   exhausted.
+ */
+char *
+rx_buffer_pool_get(struct rx_buffer_pool *pool, size_t size, size_t *cap);
+
+/* Give a buffer of capacity `cap` back to the pool */
+void
+rx_buffer_pool_put(struct rx_buffer_pool *pool, char *buf, size_t cap);
+
+/* Release all the free buffers of a pool */
+void
+rx_buffer_pool_destroy(struct rx_buffer_pool *pool);
+
+#endif /* __RX_POOL_H__ */
@@ -43,10 +43,18 @@ struct rx_qlist
     struct rx_qlist_node *head;
     struct rx_qlist_node *tail;
     size_t size;
+
+    /* Arena the nodes are allocated from, or `NULL` to use the heap */
+    struct rx_arena *arena;
 };
 
+/* Create an empty list
+
+   When `arena` is not `NULL`, the nodes are allocated from it and released
+   together with the arena, so `rx_qlist_destroy()` does not free them.
+ */
 int
-rx_qlist_create(struct rx_qlist *list);
+rx_qlist_create(struct rx_qlist *list, struct rx_arena *arena);
 
 void
 rx_qlist_destroy(struct rx_qlist *list);
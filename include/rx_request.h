@@ -26,8 +26,7 @@
 
 #include <rx_config.h>
 #include <rx_core.h>
-
-#define RX_MAX_HEADER_LENGTH 1024
+#include <rx_string.h>
 
 enum rx_encoding
 {
@@ -48,15 +47,34 @@ enum rx_request_uri_result
     RX_REQUEST_URI_RESULT_TOO_LONG,
 };
 
+/* Progress of a request
+
+   The head of a request is tokenized as it arrives, and these are also the
+   states the tokenizer resumes from (see `rx_tokenize()`).
+ */
 enum rx_request_state
 {
     RX_REQUEST_STATE_READY,
     RX_REQUEST_STATE_METHOD,
     RX_REQUEST_STATE_URI,
     RX_REQUEST_STATE_VERSION,
+
+    /* At a header name, or at the empty line that ends the head */
     RX_REQUEST_STATE_HEADER,
+    RX_REQUEST_STATE_HEADER_VALUE,
+
+    /* After the CR that ends a line, and the LF that must follow it */
+    RX_REQUEST_STATE_LF,
+
+    /* After the CR of the empty line */
+    RX_REQUEST_STATE_HEADER_END,
+
+    /* The head is complete, and the body follows it */
     RX_REQUEST_STATE_BODY,
     RX_REQUEST_STATE_DONE,
+
+    /* The head is malformed */
+    RX_REQUEST_STATE_INVALID,
 };
 
 enum rx_request_method
@@ -103,16 +121,14 @@ typedef enum rx_encoding rx_encoding_t;
     ...
     ```
 
-    Then the `struct rx_request_uri` will be populated as follows:
+    Then the `struct rx_request_uri` will be populated with views into the
+    request buffer as follows:
 
     ```c
     struct rx_request_uri uri = {
-        .raw_uri = "/index.html?foo=bar&baz=waldo",
-        .length = 29,
-        .path = .raw_uri,
-        .path_end = .path + 11,
-        .query_string = .raw_uri + 12 ,
-        .query_string_end = .query_string + 17,
+        .raw          = { "/index.html?foo=bar&baz=waldo", 29 },
+        .path         = { .raw.data, 11 },
+        .query_string = { .raw.data + 12, 17 },
     };
     ```
 
@@ -121,7 +137,7 @@ typedef enum rx_encoding rx_encoding_t;
     ```c
     struct rx_request_uri uri_struct;
     const char *uri = "/index.html?foo=bar&baz=waldo";
-    int ret = rx_request_process_uri(&uri_struct, uri);
+    int ret = rx_request_process_uri(&uri_struct, uri, strlen(uri));
     ```
 */
 struct rx_request_uri
@@ -136,7 +152,7 @@ struct rx_request_uri
     */
     rx_request_uri_result_t result;
 
-    /* Main buffeer to store the raw URI in an HTTP request
+    /* The raw URI of an HTTP request
 
         If a request is made with the URI:
 
@@ -145,10 +161,7 @@ struct rx_request_uri
         ```
 
         Then the raw URI will be: `"/index.html?foo=bar"`*/
-    char raw_uri[RX_MAX_URI_LENGTH];
-
-    /* Length of the main URI buffer */
-    size_t length;
+    rx_str_t raw;
 
     /* The path of the URI
 
@@ -158,12 +171,8 @@ struct rx_request_uri
         GET /index.html?foo=bar HTTP/1.1
         ```
 
-        The path pointer will point to the string `"/index.html"`. However, the
-        end of the string is marked by `path_end` pointer*/
-    char *path;
-
-    /* Pointer that marks the end of the path string */
-    char *path_end;
+        The path will be `"/index.html"` */
+    rx_str_t path;
 
     /* The query string of the URI
 
@@ -173,13 +182,10 @@ struct rx_request_uri
         GET /index.html?foo=bar&baz=waldo HTTP/1.1
         ```
 
-        The `query_string` will point to the string `"foo=bar&baz=waldo"`.
-        However, the end of the string is marked by `query_string_end` pointer
+        The query string will be `"foo=bar&baz=waldo"`, or empty when the URI
+        has no `?`
      */
-    char *query_string;
-
-    /* Pointer that marks the end of the query string */
-    char *query_string_end;
+    rx_str_t query_string;
 };
 
 struct rx_request_version
@@ -189,20 +195,15 @@ struct rx_request_version
     uint8_t minor;
 };
 
+/* The host and port of the `Host` header
+
+   A header without a port gets the default port `80`.
+ */
 struct rx_header_host
 {
     rx_request_header_host_result_t result;
-    char raw_host[RX_MAX_HEADER_LENGTH];
-    size_t len;
-    char *host;
-    char *host_end;
-    char *port;
-    char *port_end;
-};
-
-struct rx_header_user_agent
-{
-    char raw_user_agent[RX_MAX_HEADER_LENGTH];
+    rx_str_t host;
+    rx_str_t port;
 };
 
 struct rx_header_accept_encoding
@@ -213,13 +214,6 @@ struct rx_header_accept_encoding
 
 struct rx_header_gmt
 {
-    char raw_gmt[RX_MAX_HEADER_LENGTH];
-    struct tm tm;
-};
-
-struct rx_header_if_modified_since
-{
-    char raw_if_modified_since[RX_MAX_HEADER_LENGTH];
     struct tm tm;
 };
 
@@ -231,7 +225,7 @@ struct rx_request
     struct rx_request_version version;
 
     struct rx_header_host host;
-    struct rx_header_user_agent user_agent;
+    rx_str_t user_agent;
     struct rx_header_accept_encoding accept_encoding;
     struct rx_qlist accept;
 
@@ -240,22 +234,35 @@ struct rx_request
     size_t content_length;
     rx_http_mime_t content_type;
     char *content;
+
+    /* Whether the client wants to keep the connection open after this request
+
+       HTTP/1.1 connections are persistent by default, unless the client sends
+       `Connection: close`.
+     */
+    int keep_alive;
+
+    /* Arena that every allocation made for the request comes from */
+    struct rx_arena *arena;
 };
 
+/* Initialize a request whose allocations come from `arena` */
 int
-rx_request_init(struct rx_request *request);
+rx_request_init(struct rx_request *request, struct rx_arena *arena);
 
 void
 rx_request_destroy(struct rx_request *request);
 
+/* Process the method, URI and version found by `rx_tokenize()` */
 int
 rx_request_process_start_line(
-    struct rx_request *request, const char *buffer, size_t len
+    struct rx_request *request, const struct rx_tokens *tokens
 );
 
+/* Process the header fields found by `rx_tokenize()` */
 int
 rx_request_process_headers(
-    struct rx_request *request, const char *buffer, size_t len
+    struct rx_request *request, const struct rx_tokens *tokens
 );
 
 int
@@ -310,6 +317,11 @@ rx_request_process_header_content_type(
     rx_http_mime_t *content_type, const char *buffer, size_t len
 );
 
+int
+rx_request_process_header_connection(
+    int *keep_alive, const char *buffer, size_t len
+);
+
 int
 rx_request_process_content(
     char *content, size_t content_length, const char *buffer, size_t len
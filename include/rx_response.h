@@ -27,6 +27,12 @@
 #include <rx_config.h>
 #include <rx_core.h>
 
+/* A response goes out as the header block followed by the content */
+#define RX_RESPONSE_MAX_SEGMENTS 2
+
+/* Seconds a client is asked to wait when the server sheds its request */
+#define RX_RESPONSE_RETRY_AFTER "1"
+
 struct rx_response
 {
     rx_http_status_t status_code;
@@ -35,19 +41,43 @@ struct rx_response
     char *location;
     struct timespec *last_modified;
 
-    int is_content_mmapd;
     char *content;
     size_t content_length;
     rx_http_mime_t content_type;
 
-    int is_resp_alloc;
-    char *resp_buf;
-    size_t resp_buf_offset;
-    size_t resp_buf_size;
+    /* File the content is sent from with `sendfile(2)`, or -1
+
+       When it is set, `content` is unused and `content_length` is the size of
+       the file. `content_offset` is the next byte of the file to send, so a
+       file that does not fit in the socket buffer is resumed on the next
+       `EPOLLOUT` event. The response owns the descriptor.
+     */
+    int content_fd;
+    off_t content_offset;
+
+    /* Output segments built by `rx_response_construct()`. The header block
+       lives in the arena, the content segment points at the content where
+       the route left it, so it is never copied. `segment` is the index of the
+       first segment that has not been sent completely. A file content follows
+       the segments. */
+    struct iovec segments[RX_RESPONSE_MAX_SEGMENTS];
+    size_t nsegments;
+    size_t segment;
+
+    /* Whether the connection stays open after the response is sent */
+    int keep_alive;
+
+    /* Next response in the response queue of the connection */
+    struct rx_response *next;
+
+    /* Arena that the content, the headers and the response buffer are
+       allocated from */
+    struct rx_arena *arena;
 };
 
+/* Initialize a response whose allocations come from `arena` */
 int
-rx_response_init(struct rx_response *response);
+rx_response_init(struct rx_response *response, struct rx_arena *arena);
 
 void
 rx_response_destroy(struct rx_response *response);
@@ -67,4 +97,25 @@ rx_response_redirect(struct rx_response *response, const char *location);
 int
 rx_response_construct(struct rx_response *response);
 
+/* Turn a response into a `503 Service Unavailable` that closes the connection
+
+   The response points at a static buffer built at compile time, with a
+   `Retry-After` of `RX_RESPONSE_RETRY_AFTER` seconds, so it needs neither
+   the arena nor `rx_response_construct()`.
+ */
+void
+rx_response_unavailable(struct rx_response *response);
+
+/* Account for `nbytes` sent bytes of the response
+
+   The bytes are taken from the segments first, then from the file content.
+   Returns how many of the bytes belonged to this response.
+ */
+size_t
+rx_response_advance(struct rx_response *response, size_t nbytes);
+
+/* Whether the segments and the file content have been sent completely */
+int
+rx_response_is_sent(const struct rx_response *response);
+
 #endif /* __RX_RESPONSE_H__ */
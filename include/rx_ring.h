@@ -27,26 +27,83 @@
 #include <rx_config.h>
 #include <rx_core.h>
 
-#define RX_RING_CAPACITY 256
+/* Number of tasks a ring holds unless told otherwise */
+#define RX_RING_DEFAULT_CAPACITY 256
 
+/* Size of a cache line, used to keep the producer and consumer indices of a
+   ring from sharing one */
+#define RX_CACHE_LINE_SIZE 64
+
+/* A slot of a ring
+
+   The sequence number tells whose turn it is: a producer may fill the slot
+   at position `pos` when `seq == pos`, and a consumer may empty it when
+   `seq == pos + 1`.
+ */
+struct rx_ring_cell
+{
+    _Atomic size_t seq;
+
+    struct rx_task *task;
+};
+
+/* The ring structure
+
+   A bounded multi-producer multi-consumer queue of tasks without locks
+   (after Dmitry Vyukov's design). Producers and consumers claim a position
+   with a compare-and-swap on `in` or `out`, then wait for nothing but the
+   sequence number of their slot, so a full or an empty ring is reported
+   right away instead of blocking.
+ */
 struct rx_ring
 {
-    size_t size;
-    size_t cap;
+    /* Next position to push to */
+    _Alignas(RX_CACHE_LINE_SIZE) _Atomic size_t in;
+
+    /* Next position to pop from */
+    _Alignas(RX_CACHE_LINE_SIZE) _Atomic size_t out;
 
-    size_t in;
-    size_t out;
+    _Alignas(RX_CACHE_LINE_SIZE) struct rx_ring_cell *cells;
 
-    struct rx_task *tasks[RX_RING_CAPACITY];
+    /* Number of slots minus one, the slots being a power of two */
+    size_t mask;
 };
 
-void
-rx_ring_init(struct rx_ring *ring);
+/* Allocate the slots of `ring`
+
+   `capacity` is rounded up to a power of two, and to at least two. The slots
+   are allocated and written by the calling thread, so on a NUMA system their
+   memory is placed on the node of that thread. Returns `RX_ERROR` if they
+   cannot be allocated.
+ */
+int
+rx_ring_init(struct rx_ring *ring, size_t capacity);
 
+/* Release the slots of `ring`, which should be empty */
 void
+rx_ring_destroy(struct rx_ring *ring);
+
+/* Number of tasks `ring` can hold */
+size_t
+rx_ring_capacity(const struct rx_ring *ring);
+
+/* Push `task` to `ring`
+
+   Returns `RX_OK`, or `RX_AGAIN` if the ring is full, in which case the task
+   is not queued.
+ */
+int
 rx_ring_push(struct rx_ring *ring, struct rx_task *task);
 
+/* Pop the oldest task from `ring`, or return `NULL` if the ring is empty */
 struct rx_task *
 rx_ring_pop(struct rx_ring *ring);
 
+/* Number of tasks in `ring`
+
+   While other threads use the ring, the result is only a snapshot.
+ */
+size_t
+rx_ring_size(struct rx_ring *ring);
+
 #endif /* __RX_RING_H__ */
@@ -58,6 +58,29 @@ struct rx_route
 
     const char *endpoint;
     const char *resource;
+
+    /* Where the handlers run. Handlers that might block, e.g. on reading
+       and rendering a page or on application logic, are served by the
+       thread pool of their workload, the others directly on the event loop
+       thread with `RX_WORKLOAD_LOOP`. */
+    rx_workload_t workload;
+
+    /* Whether the route only exists to try the server out, in which case it
+       is left out of the router unless `--demo-routes` is given */
+    int demo;
+
+    /* Consumer of the body of POST and PUT requests, for a route that takes
+       its body as it arrives rather than from `req->content`
+
+        The event loop hands it every part of the body as soon as it has been
+        read and decoded, then drops the part from the request buffer, so a
+        body of any size goes through a buffer of a few kilobytes. The socket
+        is not read further ahead of the consumer than that buffer, which
+        lets TCP slow the client down to the pace of the consumer. The parts
+        arrive in order, the last ones right before the handler runs, and the
+        start line and the headers have not been processed yet when the first
+        ones do. */
+    rx_body_sink_t body;
 };
 
 extern const struct rx_route router_table[];
@@ -65,6 +88,21 @@ extern const struct rx_route router_table[];
 int
 rx_route_get(struct rx_route *storage, const char *endpoint, size_t ep_len);
 
+/* Where serving `method` on the path `endpoint` runs
+
+   A path without a route and a method without a handler are answered with a
+   `4xx` response, which never blocks, so they run on the event loop.
+ */
+rx_workload_t
+rx_route_workload(
+    rx_request_method_t method, const char *endpoint, size_t ep_len
+);
+
+/* Consumer of the body of a request for `method` on the path `endpoint`, or
+   `NULL` if the body is kept in the request buffer for the handler */
+rx_body_sink_t
+rx_route_body(rx_request_method_t method, const char *endpoint, size_t ep_len);
+
 void *
 rx_route_static(struct rx_request *req, struct rx_response *res);
 
@@ -83,6 +121,18 @@ rx_route_login_get(struct rx_request *req, struct rx_response *res);
 void *
 rx_route_login_post(struct rx_request *req, struct rx_response *res);
 
+/* Report the length of a body of any size, which is streamed through and
+   discarded */
+void *
+rx_route_upload_post(struct rx_request *req, struct rx_response *res);
+
+int
+rx_route_upload_body(struct rx_request *req, const char *data, size_t len);
+
+/* Report the queues and the latency of every thread pool as plain text */
+void *
+rx_route_stats_get(struct rx_request *req, struct rx_response *res);
+
 void *
 rx_route_static_get(struct rx_request *req, struct rx_response *res);
 
@@ -27,6 +27,21 @@
 #include <rx_config.h>
 #include <rx_core.h>
 
+/* A view of `len` characters owned by someone else
+
+   The request keeps views into the receive buffer of its connection instead
+   of copies, so `data` is not NUL-terminated and is only valid while the
+   request is being served.
+ */
+struct rx_string
+{
+    const char *data;
+    size_t len;
+};
+
+/* View of a string literal */
+#define rx_string(literal) { (literal), sizeof(literal) - 1 }
+
 char *
 rx_strnchr(const char *big, size_t len, char little);
 
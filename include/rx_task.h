@@ -32,6 +32,13 @@ struct rx_task
     void *(*handle)(void *);
     void *arg;
 
+    /* Called instead of `handle` when the thread pool sheds the task, or
+       `NULL` if the task must always run */
+    void *(*shed)(void *);
+
+    /* Time the task was queued at, on the monotonic clock, in nanoseconds */
+    uint64_t enqueued;
+
     int task_type;
 };
 
@@ -27,25 +27,185 @@
 #include <rx_config.h>
 #include <rx_core.h>
 
+/* Number of rings an idle worker polls for a task before it parks */
+#define RX_THREAD_POOL_SPIN 128
+
+/* Settings of a thread pool */
+struct rx_thread_pool_config
+{
+    /* Name the pool is reported and configured under */
+    const char *name;
+
+    size_t nthreads;
+
+    /* Number of tasks each ring holds */
+    size_t depth;
+
+    /* Nice value of the workers, where a higher value yields the CPU to the
+       other threads of the server */
+    int priority;
+
+    /* Whether the workers are pinned to CPUs */
+    int affinity;
+
+    /* Delay above which queued tasks are shed, in nanoseconds, or `0` to
+       never shed them */
+    uint64_t target;
+};
+
+/* Counters of a worker
+
+   Only the worker writes them, so they are plain stores that other threads
+   read as they go. Times are in nanoseconds.
+ */
+struct rx_thread_worker_stats
+{
+    /* Tasks run, served or shed */
+    _Atomic uint64_t ntasks;
+    _Atomic uint64_t nshed;
+
+    /* Time the tasks waited in the rings, in total and at most */
+    _Atomic uint64_t wait;
+    _Atomic uint64_t wait_max;
+
+    /* Time spent running the tasks */
+    _Atomic uint64_t service;
+};
+
+/* Counters of a thread pool, summed over its workers */
+struct rx_thread_pool_stats
+{
+    /* Tasks waiting in the rings */
+    size_t queued;
+
+    uint64_t ntasks;
+    uint64_t nshed;
+    uint64_t wait;
+    uint64_t wait_max;
+    uint64_t service;
+};
+
+/* A worker of a thread pool
+
+   Each worker owns a ring of tasks. The event loops push to it, the worker
+   pops from it, and idle workers steal from it, so the indices of a ring are
+   only shared by the threads that actually meet on it.
+
+   The worker allocates this structure itself once it runs, pinned to its CPU
+   if the pool has affinity, so the ring lives in memory local to the worker.
+ */
+struct rx_thread_worker
+{
+    struct rx_ring ring;
+
+    struct rx_thread_pool *pool;
+    size_t id;
+
+    /* CPU the worker is pinned to, or `-1` */
+    int cpu;
+
+    struct rx_thread_worker_stats stats;
+};
+
+enum rx_thread_pool_state
+{
+    RX_THREAD_POOL_STATE_STARTING,
+    RX_THREAD_POOL_STATE_RUNNING,
+    RX_THREAD_POOL_STATE_STOPPING,
+};
+
+/* The thread pool structure
+
+   Tasks are spread over the rings of the workers in round-robin order. A
+   worker that finds its own ring empty steals from the others, and when all
+   of them are empty it spins for a short while, then parks on a futex.
+   Submitting a task only makes a system call when some worker is parked, so
+   a busy pool moves tasks without entering the kernel.
+
+   Tasks are stamped when they are queued. A worker measures how long each
+   task waited and feeds the delay to `codel`, and a task that has a `shed`
+   handler gets that handler called instead of `handle` when the pool is
+   overloaded.
+ */
 struct rx_thread_pool
 {
-    pthread_t threads[8];
+    const char *name;
+
+    /* Workers by id, filled in by the workers as they start */
+    struct rx_thread_worker **workers;
+    pthread_t *threads;
     size_t nthreads;
 
-    pthread_mutex_t lock;
-    sem_t empty;
-    sem_t full;
+    /* Number of tasks each ring holds */
+    size_t depth;
+
+    /* Nice value of the workers */
+    int priority;
+
+    /* Whether the workers are pinned to CPUs */
+    int affinity;
+
+    /* Futex word that parked workers wait on, bumped by every wakeup */
+    _Atomic uint32_t wakeups;
 
-    struct rx_ring *ring;
+    /* Number of workers that are parked or about to park */
+    _Atomic uint32_t nparked;
+
+    /* Number of workers that have taken an id, and that are set up */
+    _Atomic size_t nstarted;
+    _Atomic size_t nready;
+
+    _Atomic int state;
+
+    /* Admission control on the time tasks wait in the rings */
+    struct rx_codel codel;
 };
 
 void *
 rx_thread_pool_worker(void *arg);
 
+/* Start a thread pool as set by `config`
+
+   With `affinity`, the workers are pinned to the CPUs the process may run on,
+   one after the other, so each ring is allocated on the NUMA node of its
+   worker and stays there. A worker that may not take its `priority` keeps
+   the one of the server. The function returns once every worker is ready.
+   `codel` is set up with `target` before the first worker starts, since the
+   workers read it without synchronization.
+   Returns `RX_ERROR` if `nthreads` is zero, or if the workers cannot be
+   allocated or started.
+ */
 int
-rx_thread_pool_init(struct rx_thread_pool *pool, struct rx_ring *ring);
+rx_thread_pool_init(
+    struct rx_thread_pool *pool, const struct rx_thread_pool_config *config
+);
+
+/* Queue `task` for the workers of `pool`
 
+   The task goes to the next worker in round-robin order, kept per calling
+   thread, or to the one after if that ring is full, and `task->enqueued` is
+   set to the current time. Returns `RX_OK`, or
+   `RX_AGAIN` if every ring is full. The task is not queued in that case, and
+   the caller decides what to do with it.
+ */
 int
 rx_thread_pool_submit(struct rx_thread_pool *pool, struct rx_task *task);
 
+/* Sum the counters of the workers of `pool` into `stats`
+
+   The pool keeps running, so the result is only a snapshot.
+ */
+void
+rx_thread_pool_stats(
+    struct rx_thread_pool *pool, struct rx_thread_pool_stats *stats
+);
+
+/* Stop the workers of `pool` and release them
+
+   Workers finish the task at hand, then exit. Tasks still queued are not
+   run.
+ */
+void
+rx_thread_pool_destroy(struct rx_thread_pool *pool);
+
 #endif /*  __RX_THREAD_H__ */
@@ -0,0 +1,141 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __RX_TIMER_H__
+#define __RX_TIMER_H__ 1
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+/* Each level of the timer wheel has 2^RX_TIMER_WHEEL_BITS slots */
+#define RX_TIMER_WHEEL_BITS   6
+#define RX_TIMER_WHEEL_SLOTS  (1 << RX_TIMER_WHEEL_BITS)
+#define RX_TIMER_WHEEL_MASK   (RX_TIMER_WHEEL_SLOTS - 1)
+#define RX_TIMER_WHEEL_LEVELS 4
+
+/* Longest timeout (in ticks) that the wheel can represent without clamping,
+   which is 64^4 milliseconds, or about 4.6 hours */
+#define RX_TIMER_WHEEL_RANGE                                                   \
+    ((uint64_t)1 << (RX_TIMER_WHEEL_BITS * RX_TIMER_WHEEL_LEVELS))
+
+/* The timer structure
+
+   A timer is embedded in the object it belongs to (e.g. a connection) and
+   linked into one slot of a timer wheel while it is armed. The list is
+   intrusive and doubly-linked, so arming and cancelling a timer never
+   allocates and never scans other timers.
+ */
+struct rx_timer
+{
+    /* Links to the neighbours in the wheel slot. `next` is `NULL` when the
+       timer is not armed. */
+    struct rx_timer *prev;
+    struct rx_timer *next;
+
+    /* Absolute time (in milliseconds, `CLOCK_MONOTONIC`) when the timer
+       expires */
+    uint64_t expires;
+
+    /* Function called by the wheel when the timer expires
+
+       The timer is already disarmed when the handler runs, so the handler may
+       re-arm it or free the object that embeds it.
+     */
+    void (*handler)(struct rx_timer *timer);
+
+    /* User data for the handler */
+    void *data;
+};
+
+/* The hierarchical timer wheel
+
+   The wheel has `RX_TIMER_WHEEL_LEVELS` levels of `RX_TIMER_WHEEL_SLOTS`
+   slots. One tick is one millisecond. Level 0 holds the timers that expire
+   within the next 64 ticks, one slot per tick. Each slot of level `n` covers
+   64^n ticks, and its timers are moved (cascaded) one level down when the
+   wheel reaches that slot.
+
+   Adding and removing a timer is O(1). Advancing the wheel costs O(1) per
+   tick plus the work of cascading and running the expired timers.
+ */
+struct rx_timer_wheel
+{
+    /* Last tick that has been processed */
+    uint64_t now;
+
+    /* Number of armed timers */
+    size_t ntimers;
+
+    /* List heads of every slot. Only `prev` and `next` of the heads are
+       used. */
+    struct rx_timer slots[RX_TIMER_WHEEL_LEVELS][RX_TIMER_WHEEL_SLOTS];
+};
+
+/* Get the current time in milliseconds from a monotonic clock */
+uint64_t
+rx_timer_now();
+
+/* Initialize a timer with its expiry handler and user data */
+void
+rx_timer_init(
+    struct rx_timer *timer, void (*handler)(struct rx_timer *), void *data
+);
+
+/* Check if a timer is armed in a wheel */
+int
+rx_timer_is_active(const struct rx_timer *timer);
+
+/* Initialize an empty timer wheel that starts at the tick `now` */
+void
+rx_timer_wheel_init(struct rx_timer_wheel *wheel, uint64_t now);
+
+/* Arm a timer to expire at the absolute time `expires`
+
+   If the timer is already armed, it is moved to the new deadline. A deadline
+   that is not after the current tick of the wheel expires on the next tick.
+ */
+void
+rx_timer_wheel_add(
+    struct rx_timer_wheel *wheel, struct rx_timer *timer, uint64_t expires
+);
+
+/* Disarm a timer. It is safe to call this function on an inactive timer. */
+void
+rx_timer_wheel_del(struct rx_timer_wheel *wheel, struct rx_timer *timer);
+
+/* Advance the wheel to the tick `now` and run the handler of every timer that
+   has expired by then
+ */
+void
+rx_timer_wheel_advance(struct rx_timer_wheel *wheel, uint64_t now);
+
+/* Get the number of milliseconds until the wheel needs to be advanced again
+
+   The value is suitable as the timeout of `epoll_wait()`: it is `-1` if no
+   timer is armed. The wheel may wake up before a deadline to cascade a slot
+   of an upper level, but never after it.
+ */
+int
+rx_timer_wheel_timeout(const struct rx_timer_wheel *wheel);
+
+#endif /* __RX_TIMER_H__ */
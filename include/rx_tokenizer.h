@@ -0,0 +1,138 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __RX_TOKENIZER_H__
+#define __RX_TOKENIZER_H__ 1
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+/* Most header fields a request may carry */
+#define RX_TOKENIZER_MAX_HEADERS 64
+
+/* Bytes the tokenizer classifies at a time */
+#define RX_TOKENIZER_STRIDE 64
+
+enum rx_tokenizer_impl
+{
+    RX_TOKENIZER_SCALAR,
+    RX_TOKENIZER_SSE42,
+    RX_TOKENIZER_AVX2,
+};
+
+typedef enum rx_tokenizer_impl rx_tokenizer_impl_t;
+
+/* A header field, as it appears in the request buffer
+
+   The value is stripped of the whitespace around it and may be empty.
+ */
+struct rx_token_header
+{
+    const char *name;
+    const char *name_end;
+    const char *value;
+    const char *value_end;
+};
+
+/* The start line and header fields of a request
+
+   Every span points into the buffer that was tokenized, which is not
+   modified, so the tokens are only valid for as long as the buffer is, or
+   until they are moved along with it by `rx_tokenizer_rebase()`.
+ */
+struct rx_tokens
+{
+    /* Where tokenizing resumes when more of the request arrives
+
+       `RX_REQUEST_STATE_BODY` once the whole head has been tokenized, and
+       `RX_REQUEST_STATE_INVALID` once it has turned out to be malformed. */
+    rx_request_state_t state;
+
+    /* Offset of the token being read */
+    size_t mark;
+
+    /* Number of bytes of the request looked at so far */
+    size_t scanned;
+
+    const char *method;
+    const char *method_end;
+    const char *uri;
+    const char *uri_end;
+
+    /* `NULL` until the whole start line has been tokenized */
+    const char *version;
+    const char *version_end;
+
+    struct rx_token_header headers[RX_TOKENIZER_MAX_HEADERS];
+    size_t nheaders;
+
+    /* End of the head, past its empty line, once it has been tokenized */
+    const char *end;
+};
+
+/* Pick the fastest implementation the CPU supports
+
+   Until this is called, requests are tokenized by the scalar one. It must be
+   called before any thread starts tokenizing.
+ */
+void
+rx_tokenizer_init();
+
+/* Use the given implementation, or fail with `RX_ERROR` if the CPU does not
+   support it */
+int
+rx_tokenizer_use(rx_tokenizer_impl_t impl);
+
+const char *
+rx_tokenizer_name();
+
+/* Get ready to tokenize a new request */
+void
+rx_tokenizer_reset(struct rx_tokens *tokens);
+
+/* Split the head of a request into its start line and header fields, as it
+   arrives
+
+   `buffer` holds the first `len` bytes received of the request, and is
+   passed again with more bytes as they arrive. Each call resumes where the
+   previous one stopped, so every byte is looked at once, however the head
+   is split. The bytes are walked `RX_TOKENIZER_STRIDE` at a time: every
+   stride is reduced to bit masks of its CR, LF, colon and space bytes, and
+   only those bytes are looked at one by one. Within a header value, only CR
+   and LF are.
+
+   Returns `RX_OK` once the empty line that ends the head has been found, at
+   `end`, and `RX_AGAIN` while more bytes are needed. Returns `RX_ERROR` as
+   soon as the head turns out to be malformed: a bare CR or LF, a space in a
+   header name, or more than `RX_TOKENIZER_MAX_HEADERS` fields. Both results
+   are final, and the bytes after the head are never looked at.
+ */
+int
+rx_tokenize(struct rx_tokens *tokens, const char *buffer, size_t len);
+
+/* Move the spans of `tokens` from the buffer at `from` to the copy of it at
+   `to` */
+void
+rx_tokenizer_rebase(struct rx_tokens *tokens, const char *from, const char *to);
+
+#endif /* __RX_TOKENIZER_H__ */
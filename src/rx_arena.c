@@ -0,0 +1,218 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+#define RX_ARENA_ALIGN (_Alignof(max_align_t))
+
+#define rx_arena_align(n) (((n) + RX_ARENA_ALIGN - 1) & ~(RX_ARENA_ALIGN - 1))
+
+static struct rx_arena_block *
+rx_arena_block_create(size_t size)
+{
+    struct rx_arena_block *block;
+
+    block = malloc(sizeof(struct rx_arena_block) + size);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->size = size;
+
+    return block;
+}
+
+void
+rx_arena_init(struct rx_arena *arena)
+{
+    arena->blocks = NULL;
+    arena->used   = NULL;
+    arena->pos    = NULL;
+    arena->end    = NULL;
+}
+
+void *
+rx_arena_alloc(struct rx_arena *arena, size_t size)
+{
+    struct rx_arena_block *block;
+    char *ptr;
+
+    size = rx_arena_align(size == 0 ? 1 : size);
+
+    if ((size_t)(arena->end - arena->pos) >= size)
+    {
+        ptr = arena->pos;
+        arena->pos += size;
+
+        return ptr;
+    }
+
+    /* A large allocation gets a block of its own, so the space left in the
+       block in use is not wasted */
+    if (size > RX_ARENA_BLOCK_SIZE)
+    {
+        block = rx_arena_block_create(size);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+
+        block->next = arena->used;
+        arena->used = block;
+
+        return block->data;
+    }
+
+    /* Retire the block in use and move on to the next free one */
+    if (arena->blocks != NULL)
+    {
+        block         = arena->blocks;
+        arena->blocks = block->next;
+        block->next   = arena->used;
+        arena->used   = block;
+    }
+
+    if (arena->blocks == NULL)
+    {
+        arena->blocks = rx_arena_block_create(RX_ARENA_BLOCK_SIZE);
+        if (arena->blocks == NULL)
+        {
+            arena->pos = NULL;
+            arena->end = NULL;
+
+            return NULL;
+        }
+    }
+
+    ptr        = (char *)arena->blocks->data;
+    arena->pos = ptr + size;
+    arena->end = ptr + arena->blocks->size;
+
+    return ptr;
+}
+
+char *
+rx_arena_strndup(struct rx_arena *arena, const char *str, size_t len)
+{
+    char *dst = rx_arena_alloc(arena, len + 1);
+
+    if (dst == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(dst, str, len);
+    dst[len] = '\0';
+
+    return dst;
+}
+
+int
+rx_arena_sprintf(struct rx_arena *arena, char **strp, const char *fmt, ...)
+{
+    va_list ap;
+    size_t avail, size;
+    int len;
+
+    avail = arena->end - arena->pos;
+
+    /* Format into the block in use directly, and only format again when the
+       string does not fit */
+    va_start(ap, fmt);
+    len = vsnprintf(avail > 0 ? arena->pos : NULL, avail, fmt, ap);
+    va_end(ap);
+
+    if (len < 0)
+    {
+        return -1;
+    }
+
+    if ((size_t)len < avail)
+    {
+        *strp = arena->pos;
+        size  = rx_arena_align((size_t)len + 1);
+
+        arena->pos = size < avail ? arena->pos + size : arena->end;
+
+        return len;
+    }
+
+    *strp = rx_arena_alloc(arena, (size_t)len + 1);
+    if (*strp == NULL)
+    {
+        return -1;
+    }
+
+    va_start(ap, fmt);
+    len = vsnprintf(*strp, (size_t)len + 1, fmt, ap);
+    va_end(ap);
+
+    return len;
+}
+
+void
+rx_arena_reset(struct rx_arena *arena)
+{
+    struct rx_arena_block *block, *next;
+
+    for (block = arena->used; block != NULL; block = next)
+    {
+        next = block->next;
+
+        if (block->size > RX_ARENA_BLOCK_SIZE)
+        {
+            free(block);
+            continue;
+        }
+
+        block->next   = arena->blocks;
+        arena->blocks = block;
+    }
+
+    arena->used = NULL;
+
+    if (arena->blocks != NULL)
+    {
+        arena->pos = (char *)arena->blocks->data;
+        arena->end = arena->pos + arena->blocks->size;
+    }
+}
+
+void
+rx_arena_destroy(struct rx_arena *arena)
+{
+    struct rx_arena_block *block, *next;
+
+    rx_arena_reset(arena);
+
+    for (block = arena->blocks; block != NULL; block = next)
+    {
+        next = block->next;
+        free(block);
+    }
+
+    rx_arena_init(arena);
+}
@@ -0,0 +1,247 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static int
+rx_chunked_hex(char c);
+
+void
+rx_chunked_init(struct rx_chunked *chunked)
+{
+    chunked->state  = RX_CHUNKED_STATE_SIZE;
+    chunked->size   = 0;
+    chunked->digits = 0;
+}
+
+int
+rx_chunked_decode(
+    struct rx_chunked *chunked, char *buffer, size_t len, size_t *decoded,
+    size_t *consumed
+)
+{
+    rx_chunked_state_t state;
+    size_t src, dst, n;
+    int digit;
+    char c;
+
+    *decoded  = 0;
+    *consumed = 0;
+
+    if (chunked->state == RX_CHUNKED_STATE_DONE)
+    {
+        return RX_OK;
+    }
+
+    if (chunked->state == RX_CHUNKED_STATE_INVALID)
+    {
+        return RX_ERROR;
+    }
+
+    state = chunked->state;
+    dst   = 0;
+
+    for (src = 0; src < len;)
+    {
+        /* The data of a chunk is moved as a whole, only the bytes around it
+           are looked at one by one */
+
+        if (state == RX_CHUNKED_STATE_DATA)
+        {
+            n = len - src < chunked->size ? len - src : chunked->size;
+
+            if (dst != src)
+            {
+                memmove(buffer + dst, buffer + src, n);
+            }
+
+            dst           += n;
+            src           += n;
+            chunked->size -= n;
+
+            if (chunked->size == 0)
+            {
+                state = RX_CHUNKED_STATE_DATA_CR;
+            }
+
+            continue;
+        }
+
+        c = buffer[src++];
+
+        switch (state)
+        {
+        case RX_CHUNKED_STATE_SIZE:
+        case RX_CHUNKED_STATE_SIZE_DIGITS:
+            if ((digit = rx_chunked_hex(c)) >= 0)
+            {
+                if (chunked->digits == RX_CHUNKED_MAX_DIGITS)
+                {
+                    goto invalid;
+                }
+
+                chunked->size = chunked->size * 16 + digit;
+                chunked->digits++;
+
+                state = RX_CHUNKED_STATE_SIZE_DIGITS;
+                break;
+            }
+
+            /* A size has at least one digit */
+
+            if (state == RX_CHUNKED_STATE_SIZE)
+            {
+                goto invalid;
+            }
+
+            if (c == ';' || c == ' ' || c == '\t')
+            {
+                state = RX_CHUNKED_STATE_EXTENSION;
+                break;
+            }
+
+            if (c != '\r')
+            {
+                goto invalid;
+            }
+
+            state = RX_CHUNKED_STATE_SIZE_LF;
+            break;
+
+        case RX_CHUNKED_STATE_EXTENSION:
+        case RX_CHUNKED_STATE_TRAILER_FIELD:
+            if (c == '\n')
+            {
+                goto invalid;
+            }
+
+            if (c == '\r')
+            {
+                state = state == RX_CHUNKED_STATE_EXTENSION
+                            ? RX_CHUNKED_STATE_SIZE_LF
+                            : RX_CHUNKED_STATE_TRAILER_LF;
+            }
+
+            break;
+
+        case RX_CHUNKED_STATE_SIZE_LF:
+            if (c != '\n')
+            {
+                goto invalid;
+            }
+
+            /* A chunk of size zero is the last one */
+
+            state = chunked->size > 0 ? RX_CHUNKED_STATE_DATA
+                                      : RX_CHUNKED_STATE_TRAILER;
+
+            chunked->digits = 0;
+            break;
+
+        case RX_CHUNKED_STATE_DATA_CR:
+            if (c != '\r')
+            {
+                goto invalid;
+            }
+
+            state = RX_CHUNKED_STATE_DATA_LF;
+            break;
+
+        case RX_CHUNKED_STATE_DATA_LF:
+        case RX_CHUNKED_STATE_TRAILER_LF:
+            if (c != '\n')
+            {
+                goto invalid;
+            }
+
+            state = state == RX_CHUNKED_STATE_DATA_LF
+                        ? RX_CHUNKED_STATE_SIZE
+                        : RX_CHUNKED_STATE_TRAILER;
+            break;
+
+        case RX_CHUNKED_STATE_TRAILER:
+            if (c == '\n')
+            {
+                goto invalid;
+            }
+
+            state = c == '\r' ? RX_CHUNKED_STATE_LAST_LF
+                              : RX_CHUNKED_STATE_TRAILER_FIELD;
+            break;
+
+        case RX_CHUNKED_STATE_LAST_LF:
+            if (c != '\n')
+            {
+                goto invalid;
+            }
+
+            /* The bytes after the body belong to the next request */
+
+            if (dst != src)
+            {
+                memmove(buffer + dst, buffer + src, len - src);
+            }
+
+            chunked->state = RX_CHUNKED_STATE_DONE;
+
+            *decoded  = dst;
+            *consumed = src;
+
+            return RX_OK;
+
+        default:
+            goto invalid;
+        }
+    }
+
+    chunked->state = state;
+
+    *decoded  = dst;
+    *consumed = len;
+
+    return RX_AGAIN;
+
+invalid:
+    chunked->state = RX_CHUNKED_STATE_INVALID;
+
+    return RX_ERROR;
+}
+
+static int
+rx_chunked_hex(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+
+    c |= 0x20;
+
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+
+    return -1;
+}
@@ -0,0 +1,101 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+void
+rx_codel_init(struct rx_codel *codel, uint64_t target, uint64_t interval)
+{
+    codel->target   = target;
+    codel->interval = interval;
+
+    atomic_init(&codel->deadline, 0);
+    atomic_init(&codel->min_delay, 0);
+    atomic_init(&codel->reset, 0);
+    atomic_init(&codel->overloaded, 0);
+}
+
+int
+rx_codel_shed(struct rx_codel *codel, uint64_t now, uint64_t delay)
+{
+    uint64_t min_delay;
+
+    if (codel->target == 0)
+    {
+        return 0;
+    }
+
+    /* One thread closes the interval and judges it by its smallest delay.
+       Loading before exchanging keeps the other threads from writing to the
+       cache line on every task. */
+
+    if (now > atomic_load_explicit(&codel->deadline, memory_order_relaxed) &&
+        !atomic_load_explicit(&codel->reset, memory_order_acquire) &&
+        !atomic_exchange(&codel->reset, 1))
+    {
+        min_delay = atomic_load_explicit(
+            &codel->min_delay, memory_order_relaxed
+        );
+
+        atomic_store_explicit(
+            &codel->deadline, now + codel->interval, memory_order_relaxed
+        );
+        atomic_store_explicit(
+            &codel->overloaded, min_delay > codel->target, memory_order_relaxed
+        );
+    }
+
+    /* The first delay of an interval starts its minimum. A single sample
+       says nothing about a standing queue, so it is never shed. */
+
+    if (atomic_load_explicit(&codel->reset, memory_order_acquire) &&
+        atomic_exchange(&codel->reset, 0))
+    {
+        atomic_store_explicit(&codel->min_delay, delay, memory_order_relaxed);
+        return 0;
+    }
+
+    min_delay = atomic_load_explicit(&codel->min_delay, memory_order_relaxed);
+
+    while (delay < min_delay &&
+           !atomic_compare_exchange_weak_explicit(
+               &codel->min_delay, &min_delay, delay, memory_order_relaxed,
+               memory_order_relaxed
+           ))
+    {
+    }
+
+    return atomic_load_explicit(&codel->overloaded, memory_order_relaxed) &&
+           delay > 2 * codel->target;
+}
+
+uint64_t
+rx_codel_now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
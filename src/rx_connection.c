@@ -24,105 +24,428 @@
 #include <rx_config.h>
 #include <rx_core.h>
 
+/* Start looking for a new request at `request_start` */
+static void
+rx_connection_rewind(struct rx_connection *conn)
+{
+    conn->request_end    = conn->request_start;
+    conn->header_end     = conn->request_start;
+    conn->body_start     = conn->request_start;
+    conn->content_length = 0;
+    conn->chunked        = 0;
+    conn->body_sink      = NULL;
+    conn->body_consumed  = 0;
+    conn->body_status    = RX_HTTP_STATUS_CODE_UNSET;
+
+    if (conn->tokens != NULL)
+    {
+        rx_tokenizer_reset(conn->tokens);
+    }
+}
+
 int
 rx_connection_init(
-    struct rx_connection *conn, int efd, int fd, struct sockaddr addr,
-    socklen_t addr_len
+    struct rx_connection *conn, struct rx_event_loop *loop, int fd,
+    const struct sockaddr *addr, socklen_t addr_len
 )
 {
-    conn->efd      = efd;
+    if (addr_len > sizeof(conn->addr))
+    {
+        addr_len = sizeof(conn->addr);
+    }
+
     conn->fd       = fd;
+    conn->events   = 0;
+    conn->readable = 0;
+    conn->eof      = 0;
+    conn->loop     = loop;
     conn->addr_len = addr_len;
     conn->request  = NULL;
     conn->response = NULL;
+    conn->peer[0]  = '\0';
+
+    memcpy(&conn->addr, addr, addr_len);
+
+    conn->buffer_start  = NULL;
+    conn->buffer_cap    = 0;
+    conn->buffer_end    = NULL;
+    conn->request_start = NULL;
+    conn->tokens        = NULL;
+
+    rx_connection_rewind(conn);
+
+    conn->resp_queue_head = NULL;
+    conn->resp_queue_tail = NULL;
+
+    rx_arena_init(&conn->arena);
+
+    conn->state     = RX_CONNECTION_STATE_READY;
+    conn->task_num  = 0;
+    conn->nrequests = 0;
 
-    memset(conn->buffer_start, 0, sizeof(conn->buffer_start));
-    memcpy(&conn->addr, &addr, addr_len);
+    atomic_init(&conn->cancelled, 0);
 
-    conn->buffer_end = conn->buffer_start;
-    conn->header_end = conn->buffer_start;
-    conn->body_start = conn->buffer_start;
+    rx_timer_init(&conn->timer, NULL, NULL);
 
-    if (getnameinfo(
-            &conn->addr, conn->addr_len, conn->host, NI_MAXHOST, conn->port,
-            NI_MAXSERV, NI_NUMERICSERV
-        ) != 0)
+    return RX_OK;
+}
+
+const char *
+rx_connection_peer(struct rx_connection *conn)
+{
+    char host[INET6_ADDRSTRLEN];
+    const struct sockaddr_in *sin;
+    const struct sockaddr_in6 *sin6;
+
+    if (conn->peer[0] != '\0')
     {
-        rx_log_error("getnameinfo() failed: %s", strerror(errno));
-        return RX_ERROR;
+        return conn->peer;
     }
 
-    conn->state    = RX_CONNECTION_STATE_READY;
-    conn->task_num = 0;
+    switch (conn->addr.ss_family)
+    {
+    case AF_INET:
+        sin = (const struct sockaddr_in *)&conn->addr;
 
-    return RX_OK;
+        if (inet_ntop(AF_INET, &sin->sin_addr, host, sizeof(host)) != NULL)
+        {
+            snprintf(
+                conn->peer, sizeof(conn->peer), "%s:%u", host,
+                ntohs(sin->sin_port)
+            );
+        }
+        break;
+
+    case AF_INET6:
+        sin6 = (const struct sockaddr_in6 *)&conn->addr;
+
+        if (inet_ntop(AF_INET6, &sin6->sin6_addr, host, sizeof(host)) != NULL)
+        {
+            snprintf(
+                conn->peer, sizeof(conn->peer), "[%s]:%u", host,
+                ntohs(sin6->sin6_port)
+            );
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if (conn->peer[0] == '\0')
+    {
+        snprintf(conn->peer, sizeof(conn->peer), "unknown");
+    }
+
+    return conn->peer;
+}
+
+static void
+rx_connection_free_queue(struct rx_connection *conn)
+{
+    struct rx_response *res, *next;
+
+    for (res = conn->resp_queue_head; res != NULL; res = next)
+    {
+        next = res->next;
+
+        rx_response_destroy(res);
+    }
+
+    conn->resp_queue_head = NULL;
+    conn->resp_queue_tail = NULL;
 }
 
 void
 rx_connection_cleanup(struct rx_connection *conn)
 {
+    struct rx_tokens tokens;
+    size_t leftover, shift;
+    int pending;
+
     if (conn->request != NULL)
     {
-        conn->request->state = RX_REQUEST_STATE_DONE;
-
         rx_request_destroy(conn->request);
-        free(conn->request);
     }
 
     if (conn->response != NULL)
     {
-        conn->response->status_code = RX_HTTP_STATUS_CODE_UNSET;
-
         rx_response_destroy(conn->response);
-        free(conn->response);
     }
 
+    rx_connection_free_queue(conn);
+
+    /* A pipelined request that has been looked at already keeps what was
+       found out about it, since a body decoded in place cannot be decoded
+       again. Its tokens are carried over the reset of the arena. */
+
+    pending = conn->tokens != NULL && conn->tokens->scanned > 0;
+
+    if (pending)
+    {
+        tokens = *conn->tokens;
+    }
+
+    /* The request and the responses live in the arena, so they are all
+       released here and allocated again for the next request */
+
+    rx_arena_reset(&conn->arena);
+
     conn->request  = NULL;
     conn->response = NULL;
+    conn->tokens   = NULL;
+
+    /* Keep the bytes of pipelined requests that have not been processed yet */
+
+    leftover = conn->request_start < conn->buffer_end
+                   ? (size_t)(conn->buffer_end - conn->request_start)
+                   : 0;
+    shift    = conn->request_start - conn->buffer_start;
+
+    if (leftover > 0 && shift > 0)
+    {
+        memmove(conn->buffer_start, conn->request_start, leftover);
+    }
+
+    conn->buffer_end    = conn->buffer_start + leftover;
+    conn->request_start = conn->buffer_start;
+
+    if (pending)
+    {
+        conn->tokens = rx_arena_alloc(&conn->arena, sizeof(*conn->tokens));
+    }
+
+    if (conn->tokens != NULL)
+    {
+        *conn->tokens = tokens;
+
+        rx_tokenizer_rebase(
+            conn->tokens, conn->buffer_start + shift, conn->buffer_start
+        );
+
+        conn->request_end -= shift;
+        conn->header_end  -= shift;
+        conn->body_start  -= shift;
+    }
+    else
+    {
+        rx_connection_rewind(conn);
+    }
+
+    if (conn->buffer_start != NULL)
+    {
+        *conn->buffer_end = '\0';
+    }
+
+    conn->state    = RX_CONNECTION_STATE_READY;
     conn->task_num = 0;
 }
 
 void
 rx_connection_free(struct rx_connection *conn)
 {
-    rx_connection_cleanup(conn);
+    if (conn->request != NULL)
+    {
+        rx_request_destroy(conn->request);
+    }
+
+    if (conn->response != NULL)
+    {
+        rx_response_destroy(conn->response);
+    }
+
+    rx_connection_free_queue(conn);
+    rx_arena_destroy(&conn->arena);
+
+    if (conn->buffer_start != NULL)
+    {
+        rx_buffer_pool_put(
+            &conn->loop->buffers, conn->buffer_start, conn->buffer_cap
+        );
+    }
+
+    conn->request      = NULL;
+    conn->response     = NULL;
+    conn->buffer_start = NULL;
+    conn->buffer_cap   = 0;
+    conn->task_num     = 0;
 
     close(conn->fd);
 }
 
+int
+rx_connection_prepare(struct rx_connection *conn)
+{
+    if (conn->request == NULL)
+    {
+        conn->request = rx_arena_alloc(&conn->arena, sizeof(*conn->request));
+        if (conn->request == NULL)
+        {
+            return RX_ERROR;
+        }
+
+        (void)rx_request_init(conn->request, &conn->arena);
+    }
+
+    if (conn->response == NULL)
+    {
+        conn->response = rx_arena_alloc(&conn->arena, sizeof(*conn->response));
+        if (conn->response == NULL)
+        {
+            return RX_ERROR;
+        }
+
+        (void)rx_response_init(conn->response, &conn->arena);
+    }
+
+    return RX_OK;
+}
+
+int
+rx_connection_reserve(struct rx_connection *conn, size_t len)
+{
+    char *buf, *old;
+    size_t used, want, cap;
+
+    old  = conn->buffer_start;
+    used = old != NULL ? (size_t)(conn->buffer_end - old) : 0;
+    want = used + len + 1;
+
+    if (old != NULL && want <= conn->buffer_cap)
+    {
+        return RX_OK;
+    }
+
+    /* Once the header is complete, the size of the whole request is known,
+       so the buffer is grown at once instead of one class at a time */
+    if (old != NULL && conn->body_start != conn->request_start &&
+        !conn->chunked && conn->body_sink == NULL &&
+        conn->content_length <= RX_BODY_BUFFER_SIZE)
+    {
+        cap = (conn->body_start - old) + conn->content_length + 1;
+        if (cap > want)
+        {
+            want = cap;
+        }
+    }
+
+    buf = rx_buffer_pool_get(&conn->loop->buffers, want, &cap);
+    if (buf == NULL && want > used + len + 1)
+    {
+        buf = rx_buffer_pool_get(&conn->loop->buffers, used + len + 1, &cap);
+    }
+
+    if (buf == NULL)
+    {
+        return RX_ERROR;
+    }
+
+    if (old == NULL)
+    {
+        conn->request_start = buf;
+        conn->request_end   = buf;
+        conn->header_end    = buf;
+        conn->body_start    = buf;
+    }
+    else
+    {
+        memcpy(buf, old, used);
+
+        conn->request_start = buf + (conn->request_start - old);
+        conn->request_end   = buf + (conn->request_end - old);
+        conn->header_end    = buf + (conn->header_end - old);
+        conn->body_start    = buf + (conn->body_start - old);
+
+        if (conn->tokens != NULL)
+        {
+            rx_tokenizer_rebase(conn->tokens, old, buf);
+        }
+
+        rx_buffer_pool_put(&conn->loop->buffers, old, conn->buffer_cap);
+    }
+
+    conn->buffer_start = buf;
+    conn->buffer_end   = buf + used;
+    conn->buffer_cap   = cap;
+
+    *conn->buffer_end = '\0';
+
+    return RX_OK;
+}
+
+void
+rx_connection_release_buffer(struct rx_connection *conn)
+{
+    if (conn->buffer_start == NULL || conn->buffer_end != conn->buffer_start)
+    {
+        return;
+    }
+
+    rx_buffer_pool_put(
+        &conn->loop->buffers, conn->buffer_start, conn->buffer_cap
+    );
+
+    conn->buffer_start  = NULL;
+    conn->buffer_cap    = 0;
+    conn->buffer_end    = NULL;
+    conn->request_start = NULL;
+
+    rx_connection_rewind(conn);
+}
+
+int
+rx_connection_keep_alive(struct rx_connection *conn)
+{
+    if (rx_core_opts.keepalive_timeout == 0)
+    {
+        return 0;
+    }
+
+    if (conn->request == NULL || conn->request->keep_alive == 0)
+    {
+        return 0;
+    }
+
+    if (conn->response == NULL ||
+        conn->response->status_code == RX_HTTP_STATUS_CODE_BAD_REQUEST)
+    {
+        return 0;
+    }
+
+    /* The rest of a refused body is still on its way */
+
+    if (conn->body_status != RX_HTTP_STATUS_CODE_UNSET)
+    {
+        return 0;
+    }
+
+    return conn->nrequests < rx_core_opts.keepalive_requests;
+}
+
 void *
 rx_connection_process(struct rx_connection *conn)
 {
     pthread_t tid = pthread_self();
     int ret;
-    char *startl, *endl;
     clock_t start, end;
     struct rx_route route;
+    const struct rx_tokens *tokens;
 
     rx_log(
         LOG_LEVEL_0, LOG_TYPE_INFO,
-        "[Thread %ld]%4.sProcessing request from %s:%s (socket = %d)\n", tid,
-        "", conn->host, conn->port, conn->fd
+        "[Thread %ld]%4.sProcessing request from %s (socket = %d)\n", tid,
+        "", rx_connection_peer(conn), conn->fd
     );
 
-    if (conn->state != RX_CONNECTION_STATE_SERVING_REQUEST)
-    {
-        rx_log(
-            LOG_LEVEL_0, LOG_TYPE_ERROR,
-            "Connection is not ready to serve request\n"
-        );
-        return RX_ERROR_PTR;
-    }
+    start = clock();
 
-    start  = clock();
-    startl = conn->buffer_start;
-    endl   = startl;
+    conn->request_end = conn->body_start;
 
     memset(&route, 0, sizeof(route));
 
     rx_log(
         LOG_LEVEL_0, LOG_TYPE_DEBUG, "[Thread %ld]%4.sHeader length: %ld\n",
-        tid, "", conn->header_end - conn->buffer_start
+        tid, "", conn->header_end - conn->request_start
     );
 
     /*
@@ -132,7 +455,11 @@ rx_connection_process(struct rx_connection *conn)
            - Request body (only POST requires this part) (3)
      */
 
-    endl = strstr(startl, "\r\n");
+    /* The start line and the header fields have been split already, while
+       the head was arriving */
+
+    tokens = conn->tokens;
+    ret    = tokens->state == RX_REQUEST_STATE_BODY ? RX_OK : RX_ERROR;
 
     /* Process the request start line (1)
 
@@ -150,20 +477,22 @@ rx_connection_process(struct rx_connection *conn)
               - Request version
      */
 
-    ret = rx_request_process_start_line(conn->request, startl, endl - startl);
-    if (ret != RX_OK)
+    /* A head that does not parse is still answered, the client is told why
+       before the connection is closed */
+
+    if (rx_request_process_start_line(conn->request, tokens) != RX_OK)
     {
         rx_log(
             LOG_LEVEL_0, LOG_TYPE_ERROR,
             "[Thread %ld]%4.sFailed to process request start line\n", tid, ""
         );
-        return RX_ERROR_PTR;
-    }
 
-    /* Skip CRLF and go to the next line */
+        rx_route_4xx(
+            conn->request, conn->response, RX_HTTP_STATUS_CODE_BAD_REQUEST
+        );
 
-    startl = endl + 2;
-    endl   = strstr(startl, "\r\n");
+        goto end;
+    }
 
     /* Process the headers (2)
 
@@ -180,9 +509,8 @@ rx_connection_process(struct rx_connection *conn)
        ```
      */
 
-    ret = rx_request_process_headers(conn->request, startl, endl - startl);
-
-    if (ret != RX_OK)
+    if (ret != RX_OK ||
+        rx_request_process_headers(conn->request, tokens) != RX_OK)
     {
         rx_route_4xx(
             conn->request, conn->response, RX_HTTP_STATUS_CODE_BAD_REQUEST
@@ -191,6 +519,32 @@ rx_connection_process(struct rx_connection *conn)
         goto end;
     }
 
+    /* The part of the body that has not been handed to its consumer yet
+       follows `body_start`. Anything past that belongs to the next pipelined
+       request. */
+
+    if ((size_t)(conn->buffer_end - conn->body_start) >
+        conn->content_length - conn->body_consumed)
+    {
+        conn->request_end =
+            conn->body_start + (conn->content_length - conn->body_consumed);
+    }
+    else
+    {
+        conn->request_end = conn->buffer_end;
+    }
+
+    /* The length of a chunked body is only known once it is decoded */
+
+    conn->request->content_length = conn->content_length;
+
+    if (conn->body_status != RX_HTTP_STATUS_CODE_UNSET)
+    {
+        rx_route_4xx(conn->request, conn->response, conn->body_status);
+
+        goto end;
+    }
+
     end = clock();
 
     rx_log(
@@ -220,8 +574,7 @@ rx_connection_process(struct rx_connection *conn)
      */
 
     ret = rx_route_get(
-        &route, conn->request->uri.path,
-        (size_t)(conn->request->uri.path_end - conn->request->uri.path)
+        &route, conn->request->uri.path.data, conn->request->uri.path.len
     );
 
     if (ret != RX_OK)
@@ -232,6 +585,14 @@ rx_connection_process(struct rx_connection *conn)
         goto end;
     }
 
+    /* The client may have gone away while the request was queued, and the
+       handler is the costly part */
+
+    if (rx_connection_is_cancelled(conn))
+    {
+        return RX_ERROR_PTR;
+    }
+
     /* Route handler based on the request method
 
        If the route is found, it will store the handler in the `route`
@@ -258,21 +619,40 @@ rx_connection_process(struct rx_connection *conn)
                  application/x-www-form-urlencoded, application/json)
          */
 
-        if (conn->buffer_end > conn->body_start)
+        /* A route that takes its body as it arrives gets the rest of it,
+           which has arrived with the header or after the last read, before
+           its handler runs */
+
+        if (route.body != NULL)
+        {
+            if (conn->request_end > conn->body_start &&
+                route.body(
+                    conn->request, conn->body_start,
+                    conn->request_end - conn->body_start
+                ) != RX_OK)
+            {
+                conn->body_status = RX_HTTP_STATUS_CODE_BAD_REQUEST;
+
+                rx_route_4xx(conn->request, conn->response, conn->body_status);
+
+                goto end;
+            }
+        }
+        else if (conn->request->content_length > 0)
         {
             rx_log(
                 LOG_LEVEL_0, LOG_TYPE_INFO,
                 "[Thread %ld]%4.sBody is found in request (length = %ld)\n",
-                tid, "", conn->buffer_end - conn->body_start
+                tid, "", conn->request_end - conn->body_start
             );
 
             /* Check if the content length matches with the actual body length
 
-               If the content length is invalid, return 400 Bad Request.
+               If the body is shorter than the content length, return 400 Bad
+               Request.
              */
-            if (conn->request->content_length == 0 ||
-                ((size_t)(conn->buffer_end - conn->body_start) !=
-                 conn->request->content_length))
+            if ((size_t)(conn->request_end - conn->body_start) !=
+                conn->request->content_length)
             {
                 rx_route_4xx(
                     conn->request, conn->response,
@@ -331,7 +711,503 @@ rx_connection_process(struct rx_connection *conn)
     }
 
 end:
+    if (rx_connection_is_cancelled(conn))
+    {
+        return RX_ERROR_PTR;
+    }
+
+    conn->nrequests++;
+    conn->response->keep_alive = rx_connection_keep_alive(conn);
+
     (void)rx_response_construct(conn->response);
 
     return RX_OK_PTR;
 }
+
+/* Method and path of the request at `request_start`, from its tokens
+
+   The path is stripped of its query string, but not decoded. Return
+   `RX_ERROR` if the request line is malformed.
+ */
+static int
+rx_connection_target(
+    const struct rx_connection *conn, rx_request_method_t *method,
+    const char **path, size_t *len
+)
+{
+    const struct rx_tokens *tokens = conn->tokens;
+    const char *query;
+
+    if (tokens == NULL || tokens->uri == NULL)
+    {
+        return RX_ERROR;
+    }
+
+    (void)rx_request_proccess_method(
+        method, tokens->method, tokens->method_end - tokens->method
+    );
+
+    *path = tokens->uri;
+    *len  = tokens->uri_end - tokens->uri;
+
+    if ((query = memchr(*path, '?', *len)) != NULL)
+    {
+        *len = query - *path;
+    }
+
+    return RX_OK;
+}
+
+/* Decode the part of a chunked body that has arrived since the last call
+
+   The bytes that have not been decoded yet follow the data decoded so far,
+   which shrinks them to the data they carry.
+ */
+static int
+rx_connection_decode(struct rx_connection *conn)
+{
+    size_t decoded, consumed;
+    char *raw;
+    int ret;
+
+    raw = conn->body_start + (conn->content_length - conn->body_consumed);
+
+    ret = rx_chunked_decode(
+        &conn->chunks, raw, conn->buffer_end - raw, &decoded, &consumed
+    );
+
+    if (ret == RX_ERROR)
+    {
+        return RX_ERROR;
+    }
+
+    conn->content_length += decoded;
+    conn->buffer_end     -= consumed - decoded;
+    *conn->buffer_end     = '\0';
+
+    return ret;
+}
+
+/* Hand the part of the body in the buffer to its consumer, and drop it from
+   the buffer to make room for the rest */
+static int
+rx_connection_stream(struct rx_connection *conn)
+{
+    size_t len, left;
+
+    len  = conn->content_length - conn->body_consumed;
+    left = conn->buffer_end - conn->body_start;
+
+    if (len > left)
+    {
+        len = left;
+    }
+
+    if (len == 0)
+    {
+        return RX_OK;
+    }
+
+    if (conn->body_sink(conn->request, conn->body_start, len) != RX_OK)
+    {
+        return RX_ERROR;
+    }
+
+    memmove(conn->body_start, conn->body_start + len, left - len);
+
+    conn->buffer_end    -= len;
+    *conn->buffer_end    = '\0';
+    conn->body_consumed += len;
+
+    return RX_OK;
+}
+
+int
+rx_connection_find_request(struct rx_connection *conn)
+{
+    const struct rx_token_header *header, *length, *coding;
+    rx_request_method_t method;
+    const char *path;
+    size_t i, len;
+    int ret, conflict;
+
+    /* The header has been found by a previous call, only the body may still
+       be incomplete */
+    if (conn->body_start != conn->request_start)
+    {
+        goto body;
+    }
+
+    if (conn->request_start >= conn->buffer_end)
+    {
+        return RX_AGAIN;
+    }
+
+    if (conn->tokens == NULL)
+    {
+        conn->tokens = rx_arena_alloc(&conn->arena, sizeof(*conn->tokens));
+        if (conn->tokens == NULL)
+        {
+            return RX_ERROR;
+        }
+
+        rx_tokenizer_reset(conn->tokens);
+    }
+
+    /* Only the bytes that have arrived since the last call are tokenized */
+
+    ret = rx_tokenize(
+        conn->tokens, conn->request_start,
+        conn->buffer_end - conn->request_start
+    );
+
+    if (ret == RX_AGAIN)
+    {
+        return RX_AGAIN;
+    }
+
+    /* A malformed header is answered with a 400, which closes the
+       connection, so whatever follows it is dropped */
+
+    if (ret != RX_OK)
+    {
+        conn->header_end = conn->buffer_end;
+        conn->body_start = conn->buffer_end;
+
+        return RX_OK;
+    }
+
+    conn->header_end = (char *)conn->tokens->end - 4;
+    conn->body_start = (char *)conn->tokens->end;
+
+    /* Only `Content-Length` and `Transfer-Encoding` are needed to know where
+       the request ends. The header fields are processed by the worker later.
+     */
+
+    length   = NULL;
+    coding   = NULL;
+    conflict = 0;
+
+    for (i = 0; i < conn->tokens->nheaders; i++)
+    {
+        header = &conn->tokens->headers[i];
+
+        switch (rx_header_lookup(
+            header->name, header->name_end - header->name
+        ))
+        {
+        case RX_HEADER_CONTENT_LENGTH:
+            if (length == NULL)
+            {
+                length = header;
+                break;
+            }
+
+            len = length->value_end - length->value;
+
+            if ((size_t)(header->value_end - header->value) != len ||
+                memcmp(header->value, length->value, len) != 0)
+            {
+                conflict = 1;
+            }
+
+            break;
+
+        case RX_HEADER_TRANSFER_ENCODING:
+            coding = header;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    /* Only the chunked transfer coding is supported. A body framed both
+       ways, by copies of `Content-Length` that disagree or by a length that is
+       not a plain number, might be read differently by a proxy in front of
+       the server, so it is refused rather than guessed. */
+
+    if (conflict)
+    {
+        conn->body_status = RX_HTTP_STATUS_CODE_BAD_REQUEST;
+    }
+    else if (coding != NULL)
+    {
+        len = coding->value_end - coding->value;
+
+        if (len != sizeof("chunked") - 1 ||
+            strncasecmp(coding->value, "chunked", len) != 0)
+        {
+            conn->body_status = RX_HTTP_STATUS_CODE_NOT_IMPLEMENTED;
+        }
+        else if (length != NULL)
+        {
+            conn->body_status = RX_HTTP_STATUS_CODE_BAD_REQUEST;
+        }
+        else
+        {
+            conn->chunked = 1;
+            rx_chunked_init(&conn->chunks);
+        }
+    }
+    else if (length != NULL &&
+             rx_request_process_header_content_length(
+                 &conn->content_length, length->value,
+                 length->value_end - length->value
+             ) != RX_OK)
+    {
+        conn->body_status = RX_HTTP_STATUS_CODE_BAD_REQUEST;
+    }
+
+    if (rx_connection_target(conn, &method, &path, &len) == RX_OK)
+    {
+        conn->body_sink = rx_route_body(method, path, len);
+    }
+
+body:
+    /* A request refused because of its body is complete as it is, the rest
+       of the body is not read */
+
+    if (conn->body_status != RX_HTTP_STATUS_CODE_UNSET)
+    {
+        return RX_OK;
+    }
+
+    if (conn->chunked)
+    {
+        ret = rx_connection_decode(conn);
+    }
+    else
+    {
+        ret = (size_t)(conn->buffer_end - conn->body_start) >=
+                      conn->content_length - conn->body_consumed
+                  ? RX_OK
+                  : RX_AGAIN;
+    }
+
+    if (ret == RX_ERROR)
+    {
+        conn->body_status = RX_HTTP_STATUS_CODE_BAD_REQUEST;
+        return RX_OK;
+    }
+
+    /* While the event loop reads the body, the parts that have arrived go to
+       the consumer, which makes room for the next ones. Without a consumer,
+       the whole body has to fit in the buffer. */
+
+    if (conn->body_sink != NULL)
+    {
+        if (conn->state == RX_CONNECTION_STATE_READING_BODY &&
+            rx_connection_stream(conn) != RX_OK)
+        {
+            conn->body_status = RX_HTTP_STATUS_CODE_BAD_REQUEST;
+            return RX_OK;
+        }
+    }
+    else if (conn->content_length > RX_BODY_BUFFER_SIZE)
+    {
+        conn->body_status = RX_HTTP_STATUS_CODE_PAYLOAD_TOO_LARGE;
+        return RX_OK;
+    }
+
+    return ret;
+}
+
+/* Process the complete requests in the buffer of a connection
+
+   Processing also stops before a request that runs on another thread pool
+   than `workload`, which is left in the buffer for that pool. On the event
+   loop, `RX_WORKLOAD_LOOP`, this is any request whose route might block.
+ */
+static size_t
+rx_connection_serve(struct rx_connection *conn, rx_workload_t workload)
+{
+    pthread_t tid = pthread_self();
+    struct rx_response *res;
+    rx_workload_t next;
+    size_t nprocessed;
+    void *ret;
+
+    for (nprocessed = 0; nprocessed < RX_CONNECTION_MAX_PIPELINE;)
+    {
+        if (rx_connection_is_cancelled(conn))
+        {
+            break;
+        }
+
+        /* The event loop has located the first request already. The next
+           ones are pipelined right after it in the buffer. */
+
+        if (nprocessed > 0)
+        {
+            if (rx_connection_find_request(conn) != RX_OK)
+            {
+                break;
+            }
+
+            /* A request for another pool goes back to the event loop, which
+               hands it over to its own pool */
+
+            next = rx_connection_workload(conn);
+
+            if (next != RX_WORKLOAD_LOOP && next != workload)
+            {
+                break;
+            }
+
+            rx_request_destroy(conn->request);
+            (void)rx_request_init(conn->request, &conn->arena);
+        }
+
+        if (rx_connection_prepare(conn) != RX_OK)
+        {
+            rx_log(
+                LOG_LEVEL_0, LOG_TYPE_ERROR,
+                "[Thread %ld]%4.srx_connection_prepare: %s\n", tid, "",
+                strerror(errno)
+            );
+            break;
+        }
+
+        conn->request->state = RX_REQUEST_STATE_METHOD;
+
+        ret = rx_connection_process(conn);
+
+        /* A cancelled request is left to the event loop, which frees the
+           connection after the responses already queued. */
+
+        if (ret == RX_ERROR_PTR)
+        {
+            if (conn->resp_queue_tail != NULL)
+            {
+                conn->resp_queue_tail->keep_alive = 0;
+            }
+
+            break;
+        }
+
+        res            = conn->response;
+        conn->response = NULL;
+
+        if (conn->resp_queue_tail != NULL)
+            conn->resp_queue_tail->next = res;
+        else
+            conn->resp_queue_head = res;
+
+        conn->resp_queue_tail = res;
+        conn->request_start   = conn->request_end;
+
+        rx_connection_rewind(conn);
+
+        nprocessed++;
+
+        if (!res->keep_alive)
+        {
+            break;
+        }
+    }
+
+    rx_log(
+        LOG_LEVEL_0, LOG_TYPE_INFO,
+        "[Thread %ld]%4.sProcessed %zu request(s) on socket %d\n", tid, "",
+        nprocessed, conn->fd
+    );
+
+    return nprocessed;
+}
+
+void *
+rx_connection_process_batch(struct rx_connection *conn)
+{
+    (void)rx_connection_serve(conn, conn->workload);
+
+    return RX_OK_PTR;
+}
+
+size_t
+rx_connection_process_inline(struct rx_connection *conn)
+{
+    return rx_connection_serve(conn, RX_WORKLOAD_LOOP);
+}
+
+void
+rx_connection_cancel(struct rx_connection *conn)
+{
+    atomic_store_explicit(&conn->cancelled, 1, memory_order_relaxed);
+}
+
+int
+rx_connection_hangup(struct rx_connection *conn, uint32_t events)
+{
+    /* A client that has only closed its side may still read the responses.
+       No request follows the ones in the buffer, so the connection is closed
+       once they are sent. The worker never reads `eof`. */
+
+    if (!(events & (EPOLLERR | EPOLLHUP)))
+    {
+        if ((events & EPOLLRDHUP) &&
+            conn->state == RX_CONNECTION_STATE_SERVING_REQUEST)
+        {
+            conn->eof = 1;
+        }
+
+        return RX_OK;
+    }
+
+    /* Only the cancellation flag is shared with the worker, the state of the
+       connection is not changed under it */
+
+    if (conn->state == RX_CONNECTION_STATE_SERVING_REQUEST)
+    {
+        rx_connection_cancel(conn);
+        return RX_AGAIN;
+    }
+
+    return RX_ERROR;
+}
+
+int
+rx_connection_is_cancelled(const struct rx_connection *conn)
+{
+    return atomic_load_explicit(&conn->cancelled, memory_order_relaxed);
+}
+
+void *
+rx_connection_shed(struct rx_connection *conn)
+{
+    struct rx_response *res = conn->response;
+
+    conn->response = NULL;
+
+    rx_response_unavailable(res);
+
+    if (conn->resp_queue_tail != NULL)
+        conn->resp_queue_tail->next = res;
+    else
+        conn->resp_queue_head = res;
+
+    conn->resp_queue_tail = res;
+
+    rx_log(
+        LOG_LEVEL_0, LOG_TYPE_WARN, "Shed the requests on socket %d\n",
+        conn->fd
+    );
+
+    return RX_OK_PTR;
+}
+
+rx_workload_t
+rx_connection_workload(const struct rx_connection *conn)
+{
+    rx_request_method_t method;
+    const char *path;
+    size_t len;
+
+    /* A malformed request line is answered with a 400 */
+    if (rx_connection_target(conn, &method, &path, &len) != RX_OK)
+    {
+        return RX_WORKLOAD_LOOP;
+    }
+
+    return rx_route_workload(method, path, len);
+}
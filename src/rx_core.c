@@ -24,16 +24,144 @@
 #include <rx_config.h>
 #include <rx_core.h>
 
-int server_fd, client_fd, epoll_fd, i;
+int server_fd;
 socklen_t server_len;
-char msg[1024], host[NI_MAXHOST], service[NI_MAXSERV];
+char host[NI_MAXHOST], service[NI_MAXSERV];
 
+struct rx_core_options rx_core_opts;
+struct rx_event_loop *rx_loops;
+size_t rx_nloops;
 struct rx_view rx_view_engine;
-struct rx_ring rx_ring_buffer;
-struct rx_thread_pool rx_tp;
-struct epoll_event ev, events[RX_MAX_EVENTS];
+struct rx_thread_pool rx_tp[RX_WORKLOAD_MAX];
 struct sockaddr server;
 
+static size_t
+rx_core_parse_size(const char *name, const char *arg)
+{
+    char *end;
+    long long value;
+
+    errno = 0;
+    value = strtoll(arg, &end, 10);
+
+    if (errno != 0 || end == arg || *end != '\0' || value < 0)
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "Invalid value for --%s: \"%s\"\n",
+            name, arg
+        );
+
+        exit(EXIT_FAILURE);
+    }
+
+    return (size_t)value;
+}
+
+/* Parse `<name>:<threads>[:<depth>[:<priority>]]` into the options of the
+   thread pool called `name` */
+static void
+rx_core_parse_pool(const char *arg)
+{
+    struct rx_thread_pool_config *config = NULL;
+    const char *p = strchr(arg, ':');
+    long long value;
+    char *end;
+    size_t i;
+
+    for (i = 0; p != NULL && i < RX_WORKLOAD_MAX; i++)
+    {
+        if (strlen(rx_core_opts.pools[i].name) == (size_t)(p - arg) &&
+            strncmp(rx_core_opts.pools[i].name, arg, p - arg) == 0)
+        {
+            config = &rx_core_opts.pools[i];
+        }
+    }
+
+    /* The threads, then the depth, then the priority */
+    for (i = 0; config != NULL && i < 3 && p != NULL && *p == ':'; i++)
+    {
+        errno = 0;
+        value = strtoll(p + 1, &end, 10);
+
+        if (errno != 0 || end == p + 1 || (*end != ':' && *end != '\0'))
+        {
+            break;
+        }
+
+        if (i == 0 && value >= 0)
+            config->nthreads = (size_t)value;
+        else if (i == 1 && value >= 0)
+            config->depth = (size_t)value;
+        else if (i == 2 && value >= -20 && value <= 19)
+            config->priority = (int)value;
+        else
+            break;
+
+        p = end;
+    }
+
+    if (config == NULL || i == 0 || *p != '\0')
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "Invalid value for --pool: \"%s\"\n",
+            arg
+        );
+
+        exit(EXIT_FAILURE);
+    }
+}
+
+static size_t
+rx_core_online_cpus()
+{
+    long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return ncpus > 0 ? (size_t)ncpus : 1;
+}
+
+static int
+rx_core_bind(const struct sockaddr *addr, socklen_t addr_len)
+{
+    int fd, ret;
+    const int optval = 1;
+
+    fd = socket(addr->sa_family, SOCK_STREAM, 0);
+
+    if (fd == -1)
+    {
+        rx_log(LOG_LEVEL_0, LOG_TYPE_WARN, "socket: %s\n", strerror(errno));
+
+        return -1;
+    }
+
+    /* Every event loop binds its own socket to the same address, so the
+       kernel can balance incoming connections between the listeners. */
+
+    ret = setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval));
+
+    if (ret == -1)
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_WARN, "setsockopt: %s\n", strerror(errno)
+        );
+        assert(close(fd) == 0);
+
+        return -1;
+    }
+
+    ret = bind(fd, addr, addr_len);
+
+    if (ret == -1)
+    {
+        rx_log(LOG_LEVEL_0, LOG_TYPE_WARN, "bind: %s\n", strerror(errno));
+        assert(close(fd) == 0);
+
+        return -1;
+    }
+
+    return fd;
+}
+
 void
 dummy()
 {
@@ -43,8 +171,161 @@ dummy()
 void
 rx_core_init(int argc, const char **argv)
 {
-    NOOP(argc);
-    NOOP(argv);
+    int opt;
+
+    enum
+    {
+        RX_OPT_KA_TIMEOUT = 256,
+        RX_OPT_KA_REQUESTS,
+        RX_OPT_HEADER_TIMEOUT,
+        RX_OPT_BODY_TIMEOUT,
+        RX_OPT_SEND_TIMEOUT,
+        RX_OPT_QUEUE_DEPTH,
+        RX_OPT_QUEUE_TARGET,
+        RX_OPT_POOL,
+        RX_OPT_AFFINITY,
+        RX_OPT_DEMO_ROUTES,
+    };
+
+    /* clang-format off */
+    static const struct option long_options[] = {
+        {"loops",              required_argument, NULL, 'l'},
+        {"threads",            required_argument, NULL, 't'},
+        {"queue-depth",        required_argument, NULL, RX_OPT_QUEUE_DEPTH},
+        {"queue-target",       required_argument, NULL, RX_OPT_QUEUE_TARGET},
+        {"pool",               required_argument, NULL, RX_OPT_POOL},
+        {"affinity",           no_argument,       NULL, RX_OPT_AFFINITY},
+        {"keepalive-timeout",  required_argument, NULL, RX_OPT_KA_TIMEOUT},
+        {"keepalive-requests", required_argument, NULL, RX_OPT_KA_REQUESTS},
+        {"header-timeout",     required_argument, NULL, RX_OPT_HEADER_TIMEOUT},
+        {"body-timeout",       required_argument, NULL, RX_OPT_BODY_TIMEOUT},
+        {"send-timeout",       required_argument, NULL, RX_OPT_SEND_TIMEOUT},
+        {"demo-routes",        no_argument,       NULL, RX_OPT_DEMO_ROUTES},
+        {NULL,                 0,                 NULL, 0},
+    };
+    /* clang-format on */
+
+    memset(&rx_core_opts, 0, sizeof(rx_core_opts));
+
+    rx_core_opts.nloops             = 1;
+    rx_core_opts.nthreads           = 0;
+    rx_core_opts.queue_depth        = RX_RING_DEFAULT_CAPACITY;
+    rx_core_opts.queue_target       = RX_CODEL_DEFAULT_TARGET / 1000000;
+    rx_core_opts.affinity           = 0;
+
+    rx_core_opts.pools[RX_WORKLOAD_PAGES].name    = "pages";
+    rx_core_opts.pools[RX_WORKLOAD_AUTH].name     = "auth";
+    rx_core_opts.pools[RX_WORKLOAD_AUTH].priority = 5;
+
+    rx_core_opts.keepalive_timeout  = 5;
+    rx_core_opts.keepalive_requests = 100;
+    rx_core_opts.header_timeout     = 10;
+    rx_core_opts.body_timeout       = 30;
+    rx_core_opts.send_timeout       = 30;
+    rx_core_opts.demo_routes        = 0;
+
+    while ((opt = getopt_long(
+                argc, (char *const *)argv, "l:t:", long_options, NULL
+            )) != -1)
+    {
+        switch (opt)
+        {
+        case 'l':
+            rx_core_opts.nloops = rx_core_parse_size("loops", optarg);
+            break;
+
+        case 't':
+            rx_core_opts.nthreads = rx_core_parse_size("threads", optarg);
+            break;
+
+        case RX_OPT_QUEUE_DEPTH:
+            rx_core_opts.queue_depth =
+                rx_core_parse_size("queue-depth", optarg);
+            break;
+
+        case RX_OPT_QUEUE_TARGET:
+            rx_core_opts.queue_target =
+                rx_core_parse_size("queue-target", optarg);
+            break;
+
+        case RX_OPT_POOL:
+            rx_core_parse_pool(optarg);
+            break;
+
+        case RX_OPT_AFFINITY:
+            rx_core_opts.affinity = 1;
+            break;
+
+        case RX_OPT_KA_TIMEOUT:
+            rx_core_opts.keepalive_timeout =
+                rx_core_parse_size("keepalive-timeout", optarg);
+            break;
+
+        case RX_OPT_KA_REQUESTS:
+            rx_core_opts.keepalive_requests =
+                rx_core_parse_size("keepalive-requests", optarg);
+            break;
+
+        case RX_OPT_HEADER_TIMEOUT:
+            rx_core_opts.header_timeout =
+                rx_core_parse_size("header-timeout", optarg);
+            break;
+
+        case RX_OPT_BODY_TIMEOUT:
+            rx_core_opts.body_timeout =
+                rx_core_parse_size("body-timeout", optarg);
+            break;
+
+        case RX_OPT_SEND_TIMEOUT:
+            rx_core_opts.send_timeout =
+                rx_core_parse_size("send-timeout", optarg);
+            break;
+
+        case RX_OPT_DEMO_ROUTES:
+            rx_core_opts.demo_routes = 1;
+            break;
+
+        default:
+            rx_log(
+                LOG_LEVEL_0, LOG_TYPE_ERROR,
+                "Usage: %s [-l loops] [-t threads] [--queue-depth=n] "
+                "[--queue-target=ms] [--pool=name:threads[:depth[:prio]]] "
+                "[--affinity] [--keepalive-timeout=secs] "
+                "[--keepalive-requests=n] [--header-timeout=secs] "
+                "[--body-timeout=secs] [--send-timeout=secs] "
+                "[--demo-routes]\n",
+                argv[0]
+            );
+
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (rx_core_opts.nloops == 0)
+    {
+        rx_core_opts.nloops = rx_core_online_cpus();
+    }
+
+    if (rx_core_opts.nthreads == 0)
+    {
+        rx_core_opts.nthreads = rx_core_online_cpus();
+    }
+
+    if (rx_core_opts.queue_depth == 0)
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "--queue-depth must be at least 1\n"
+        );
+
+        exit(EXIT_FAILURE);
+    }
+
+    rx_tokenizer_init();
+
+    rx_log(
+        LOG_LEVEL_0, LOG_TYPE_INFO, "Tokenize requests with %s\n",
+        rx_tokenizer_name()
+    );
 
     rx_log(LOG_LEVEL_0, LOG_TYPE_INFO, "Initialize core... OK\n");
 }
@@ -52,8 +333,6 @@ rx_core_init(int argc, const char **argv)
 void
 rx_core_gai()
 {
-    int ret;
-    const int optval = 1;
     struct addrinfo hints, *res, *p;
 
     memset(&hints, 0, sizeof(hints));
@@ -73,39 +352,12 @@ rx_core_gai()
 
     for (p = res; p != NULL; p = p->ai_next)
     {
-        server_fd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
-
-        if (server_fd == -1)
-        {
-            rx_log(LOG_LEVEL_0, LOG_TYPE_WARN, "socket: %s\n", strerror(errno));
-
-            continue;
-        }
+        server_fd = rx_core_bind(p->ai_addr, p->ai_addrlen);
 
-        ret = setsockopt(
-            server_fd, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)
-        );
-
-        if (ret == -1)
+        if (server_fd != -1)
         {
-            assert(close(server_fd) == 0);
-            rx_log(
-                LOG_LEVEL_0, LOG_TYPE_WARN, "setsockopt: %s\n", strerror(errno)
-            );
-
-            continue;
+            break;
         }
-
-        ret = bind(server_fd, p->ai_addr, p->ai_addrlen);
-        if (ret == -1)
-        {
-            assert(close(server_fd) == 0);
-            rx_log(LOG_LEVEL_0, LOG_TYPE_WARN, "bind: %s\n", strerror(errno));
-
-            continue;
-        }
-
-        break;
     }
 
     if (p == NULL)
@@ -129,7 +381,7 @@ rx_core_gni()
 
     ret = getnameinfo(
         &server, server_len, host, NI_MAXHOST, service, NI_MAXSERV,
-        NI_NUMERICSERV
+        NI_NUMERICHOST | NI_NUMERICSERV
     );
 
     if (ret != 0)
@@ -158,32 +410,54 @@ rx_core_set_nonblocking()
 }
 
 void
-rx_core_epoll_create()
+rx_core_load_event_loops()
 {
-    int ret;
+    int fd, ret;
 
-    epoll_fd = epoll_create1(0);
+    rx_nloops = rx_core_opts.nloops;
+    rx_loops  = calloc(rx_nloops, sizeof(struct rx_event_loop));
 
-    if (epoll_fd == -1)
+    if (rx_loops == NULL)
     {
-        rx_log(
-            LOG_LEVEL_0, LOG_TYPE_ERROR, "epoll_create1: %s\n", strerror(errno)
-        );
+        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "calloc: %s\n", strerror(errno));
 
         exit(EXIT_FAILURE);
     }
 
-    ev.events  = EPOLLIN;
-    ev.data.fd = server_fd;
+    for (size_t i = 0; i < rx_nloops; i++)
+    {
+        /* The first loop takes over the socket created by `rx_core_gai()`,
+           the others bind a new socket to the same address. */
 
-    ret = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_fd, &ev);
+        fd = i == 0 ? server_fd : rx_core_bind(&server, server_len);
 
-    if (ret == -1)
-    {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "epoll_ctl: %s\n", strerror(errno));
+        if (fd == -1)
+        {
+            rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "Failed to bind socket\n");
 
-        exit(EXIT_FAILURE);
+            exit(EXIT_FAILURE);
+        }
+
+        if (fcntl(fd, F_SETFL, O_NONBLOCK) == -1)
+        {
+            rx_log(
+                LOG_LEVEL_0, LOG_TYPE_ERROR, "fcntl: %s\n", strerror(errno)
+            );
+
+            exit(EXIT_FAILURE);
+        }
+
+        ret = rx_event_loop_init(&rx_loops[i], i, fd);
+
+        if (ret != RX_OK)
+        {
+            exit(EXIT_FAILURE);
+        }
     }
+
+    rx_log(
+        LOG_LEVEL_0, LOG_TYPE_INFO, "Load %zu event loop(s)... OK\n", rx_nloops
+    );
 }
 
 void
@@ -248,49 +522,112 @@ rx_core_load_view()
 }
 
 void
-rx_core_load_ring_buffer()
+rx_core_load_thread_pool()
 {
-    memset(&rx_ring_buffer, 0, sizeof(rx_ring_buffer));
-    rx_ring_init(&rx_ring_buffer);
+    struct rx_thread_pool_config config;
+    size_t i;
 
-    rx_log(LOG_LEVEL_0, LOG_TYPE_INFO, "Load ring buffer... OK\n");
+    memset(rx_tp, 0, sizeof(rx_tp));
+
+    for (i = 0; i < RX_WORKLOAD_MAX; i++)
+    {
+        config = rx_core_opts.pools[i];
+
+        if (config.nthreads == 0)
+        {
+            config.nthreads = rx_core_opts.nthreads;
+        }
+
+        if (config.depth == 0)
+        {
+            config.depth = rx_core_opts.queue_depth;
+        }
+
+        config.affinity = rx_core_opts.affinity;
+        config.target   = rx_core_opts.queue_target * 1000000;
+
+        if (rx_thread_pool_init(&rx_tp[i], &config) != RX_OK)
+        {
+            rx_log(
+                LOG_LEVEL_0, LOG_TYPE_ERROR, "rx_thread_pool_init(%s): %s\n",
+                config.name, strerror(errno)
+            );
+
+            exit(EXIT_FAILURE);
+        }
+
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_INFO,
+            "Load thread pool %s of %zu worker(s), %zu task(s) per queue, "
+            "priority %d, %zu ms queue target... OK\n",
+            config.name, rx_tp[i].nthreads,
+            rx_ring_capacity(&rx_tp[i].workers[0]->ring), config.priority,
+            rx_core_opts.queue_target
+        );
+    }
 }
 
 void
-rx_core_load_thread_pool()
+rx_core_boot()
 {
     int ret;
 
-    memset(&rx_tp, 0, sizeof(rx_tp));
-
-    ret = rx_thread_pool_init(&rx_tp, &rx_ring_buffer);
+    /* A file is sent with `sendfile()`, which has no `MSG_NOSIGNAL`. A client
+       that resets the connection meanwhile would raise SIGPIPE and kill the
+       server, so the signal is ignored and the write fails with EPIPE, which
+       only closes that connection. */
 
-    if (ret != RX_OK)
+    if (signal(SIGPIPE, SIG_IGN) == SIG_ERR)
     {
-        rx_log(
-            LOG_LEVEL_0, LOG_TYPE_ERROR, "rx_thread_pool_init: %s\n",
-            strerror(errno)
-        );
+        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "signal: %s\n", strerror(errno));
 
         exit(EXIT_FAILURE);
     }
 
-    rx_log(LOG_LEVEL_0, LOG_TYPE_INFO, "Load thread pool... OK\n");
+    for (size_t i = 0; i < rx_nloops; i++)
+    {
+        ret = listen(rx_loops[i].server_fd, 1024);
+
+        if (ret == -1)
+        {
+            rx_log(
+                LOG_LEVEL_0, LOG_TYPE_ERROR, "listen: %s\n", strerror(errno)
+            );
+
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    rx_log(LOG_LEVEL_0, LOG_TYPE_INFO, "Make server fd listen... OK\n");
 }
 
-void
-rx_core_boot()
+int
+rx_core_run()
 {
     int ret;
+    void *status;
 
-    ret = listen(server_fd, 1024);
+    /* Loop 0 runs on the main thread, every other loop gets its own thread */
 
-    if (ret == -1)
+    for (size_t i = 1; i < rx_nloops; i++)
     {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "listen: %s\n", strerror(errno));
+        ret = pthread_create(
+            &rx_loops[i].thread, NULL, rx_event_loop_run, &rx_loops[i]
+        );
 
-        exit(EXIT_FAILURE);
+        if (ret != 0)
+        {
+            rx_log(
+                LOG_LEVEL_0, LOG_TYPE_ERROR, "pthread_create: %s\n",
+                strerror(ret)
+            );
+
+            return RX_ERROR;
+        }
     }
 
-    rx_log(LOG_LEVEL_0, LOG_TYPE_INFO, "Make server fd listen... OK\n");
+    rx_loops[0].thread = pthread_self();
+    status             = rx_event_loop_run(&rx_loops[0]);
+
+    return status == RX_OK_PTR ? RX_OK : RX_ERROR;
 }
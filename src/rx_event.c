@@ -0,0 +1,1317 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static void
+rx_event_loop_close(struct rx_event_loop *loop, struct rx_connection *conn)
+{
+    int fd = conn->fd;
+
+    rx_timer_wheel_del(&loop->timers, &conn->timer);
+
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, NULL) == -1)
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_WARN, "epoll_ctl (at %s:%d): %s\n", __FILE__,
+            __LINE__, strerror(errno)
+        );
+    }
+
+    rx_connection_free(conn);
+    rx_slab_free(&loop->conns, conn);
+
+    rx_log(LOG_LEVEL_0, LOG_TYPE_INFO, "Connection closed on fd %d\n", fd);
+}
+
+/* Close a connection whose deadline has passed
+
+   The connection timer is armed with a different timeout depending on what
+   the server is waiting for, so the state tells which one has expired.
+ */
+static void
+rx_event_loop_expire(struct rx_timer *timer)
+{
+    struct rx_connection *conn = timer->data;
+    const char *reason;
+
+    switch (conn->state)
+    {
+    case RX_CONNECTION_STATE_READING_BODY:
+        reason = "body read";
+        break;
+
+    case RX_CONNECTION_STATE_WRITING_RESPONSE:
+        reason = "send";
+        break;
+
+    case RX_CONNECTION_STATE_READY:
+        reason = conn->nrequests > 0 ? "keep-alive" : "header read";
+        break;
+
+    default:
+        reason = "header read";
+        break;
+    }
+
+    rx_log(
+        LOG_LEVEL_0, LOG_TYPE_INFO, "Connection on fd %d timed out (%s)\n",
+        conn->fd, reason
+    );
+
+    rx_event_loop_close(conn->loop, conn);
+}
+
+/* Watch the listening socket of a loop again after a back-off */
+static void
+rx_event_loop_resume(struct rx_timer *timer)
+{
+    struct rx_event_loop *loop = timer->data;
+    struct epoll_event ev;
+
+    ev.events  = EPOLLIN;
+    ev.data.fd = loop->server_fd;
+
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, loop->server_fd, &ev) == -1)
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "epoll_ctl (at %s:%d): %s\n",
+            __FILE__, __LINE__, strerror(errno)
+        );
+    }
+}
+
+/* Stop watching the listening socket of a loop for a moment
+
+   The process is out of file descriptors. The listening socket would keep
+   being reported while the pending clients cannot be accepted, so they are
+   left in the backlog until connections have been closed.
+ */
+static void
+rx_event_loop_pause(struct rx_event_loop *loop)
+{
+    struct epoll_event ev;
+
+    ev.events  = 0;
+    ev.data.fd = loop->server_fd;
+
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, loop->server_fd, &ev) == -1)
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "epoll_ctl (at %s:%d): %s\n",
+            __FILE__, __LINE__, strerror(errno)
+        );
+    }
+
+    rx_timer_wheel_add(
+        &loop->timers, &loop->accept_timer,
+        rx_timer_now() + RX_EVENT_LOOP_ACCEPT_BACKOFF
+    );
+}
+
+/* Arm the timer of a connection to expire in `timeout` seconds
+
+   A timeout of `0` disables the timer, so the connection can wait forever in
+   its current state.
+ */
+static void
+rx_event_loop_arm(
+    struct rx_event_loop *loop, struct rx_connection *conn, size_t timeout
+)
+{
+    if (timeout == 0)
+    {
+        rx_timer_wheel_del(&loop->timers, &conn->timer);
+        return;
+    }
+
+    rx_timer_wheel_add(
+        &loop->timers, &conn->timer, rx_timer_now() + timeout * 1000
+    );
+}
+
+/* Start reading the body of the request at the start of the buffer, whose
+   header is complete
+
+   A route that consumes its body as it arrives is handed what has arrived of
+   it with the header, which leaves room in the buffer for the rest.
+ */
+static int
+rx_event_loop_body(struct rx_connection *conn)
+{
+    conn->state = RX_CONNECTION_STATE_READING_BODY;
+
+    if (conn->body_sink == NULL)
+    {
+        return RX_OK;
+    }
+
+    if (rx_connection_prepare(conn) != RX_OK)
+    {
+        return RX_ERROR;
+    }
+
+    return rx_connection_find_request(conn) != RX_ERROR ? RX_OK : RX_ERROR;
+}
+
+/* Read everything the client has sent into the buffer of a connection
+
+   The client sockets are edge-triggered, so the socket is read until it is
+   drained, that is until `recv()` fails with `EAGAIN` or returns 0: another
+   `EPOLLIN` event only comes when new data arrives. The data
+   is received straight into the request buffer, which grows as needed.
+
+   Reading stops early, leaving the rest in the socket, when the buffer is
+   full and already holds a complete request (the pipelined requests after it
+   are read once it has been served), or an incomplete header that is already
+   too large. A full buffer that holds a body with a consumer is handed to the
+   consumer instead of growing. `eof` is set when the client has closed its
+   side.
+
+   Return `RX_ERROR` if `recv()` fails or the request does not fit into the
+   largest buffer.
+ */
+static int
+rx_event_loop_read(struct rx_connection *conn, int *eof)
+{
+    size_t used, room;
+    ssize_t nread;
+
+    *eof = 0;
+
+    for (;;)
+    {
+        used = conn->buffer_end - conn->buffer_start;
+        room = conn->buffer_start != NULL ? conn->buffer_cap - used - 1 : 0;
+
+        if (room == 0)
+        {
+            if (rx_connection_find_request(conn) == RX_OK)
+            {
+                return RX_OK;
+            }
+
+            if (conn->body_start != conn->request_start &&
+                conn->state != RX_CONNECTION_STATE_READING_BODY)
+            {
+                if (rx_event_loop_body(conn) != RX_OK)
+                {
+                    return RX_ERROR;
+                }
+
+                continue;
+            }
+
+            if (conn->body_start == conn->request_start &&
+                (size_t)(conn->buffer_end - conn->request_start) >=
+                    RX_HEADER_BUFFER_SIZE)
+            {
+                return RX_OK;
+            }
+
+            if (rx_connection_reserve(conn, 1) != RX_OK)
+            {
+                errno = EMSGSIZE;
+                return RX_ERROR;
+            }
+
+            continue;
+        }
+
+        nread = recv(conn->fd, conn->buffer_end, room, 0);
+
+        if (nread == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return RX_OK;
+            }
+
+            return RX_ERROR;
+        }
+
+        if (nread == 0)
+        {
+            *eof = 1;
+            return RX_OK;
+        }
+
+        conn->buffer_end  += nread;
+        *conn->buffer_end  = '\0';
+
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_DEBUG, "Received %zd bytes from fd %d\n",
+            nread, conn->fd
+        );
+
+        /* A short read does not mean that the socket is drained: a FIN
+           queued behind the data is only seen by the next call, and the
+           edge-triggered socket would not report it again */
+    }
+}
+
+/* Serve the complete requests of a connection on a worker, then hand the
+   connection back to its event loop, which sends the responses */
+static void *
+rx_event_loop_serve(void *arg)
+{
+    struct rx_connection *conn = arg;
+
+    rx_connection_process_batch(conn);
+
+    if (rx_event_loop_post(conn->loop, conn) != RX_OK)
+    {
+        return RX_ERROR_PTR;
+    }
+
+    return RX_OK_PTR;
+}
+
+/* Refuse the requests of a connection, then hand it back to its event loop
+   like a served one */
+static void *
+rx_event_loop_shed(void *arg)
+{
+    struct rx_connection *conn = arg;
+
+    rx_connection_shed(conn);
+
+    if (rx_event_loop_post(conn->loop, conn) != RX_OK)
+    {
+        return RX_ERROR_PTR;
+    }
+
+    return RX_OK_PTR;
+}
+
+/* Hand the complete requests of a connection over to the thread pool of
+   `workload`
+
+   When the queues of the thread pool are full, the requests are refused on
+   the loop thread instead, so the loop never blocks on a route.
+ */
+static int
+rx_event_loop_submit(
+    struct rx_event_loop *loop, struct rx_connection *conn,
+    rx_workload_t workload
+)
+{
+    struct rx_task *task = &conn->task;
+
+    if (rx_connection_prepare(conn) != RX_OK)
+    {
+        sprintf(loop->msg, "rx_connection_prepare: %s\n", strerror(errno));
+        return RX_ERROR;
+    }
+
+    rx_log(
+        LOG_LEVEL_2, LOG_TYPE_DEBUG, "Header Length: %ld\n",
+        conn->header_end - conn->request_start
+    );
+    rx_log(
+        LOG_LEVEL_2, LOG_TYPE_DEBUG, "Body Length: %ld\n",
+        conn->buffer_end - conn->body_start
+    );
+
+    /* Processing time is not bounded by the client timeouts */
+    rx_timer_wheel_del(&loop->timers, &conn->timer);
+
+    conn->state          = RX_CONNECTION_STATE_SERVING_REQUEST;
+    conn->request->state = RX_REQUEST_STATE_METHOD;
+
+    conn->workload = workload;
+
+    task->arg    = conn;
+    task->handle = rx_event_loop_serve;
+    task->shed   = rx_event_loop_shed;
+
+    if (rx_thread_pool_submit(&rx_tp[workload], task) == RX_OK)
+    {
+        return RX_OK;
+    }
+
+    /* The workers are saturated. Serving the requests here could block the
+       loop on a route, while the refusal is written out already and costs
+       the loop next to nothing. */
+
+    rx_log(
+        LOG_LEVEL_0, LOG_TYPE_WARN,
+        "Thread pool %s is full, shedding on event loop %zu\n",
+        rx_tp[workload].name, loop->id
+    );
+
+    return task->shed(task->arg) == RX_OK_PTR ? RX_OK : RX_ERROR;
+}
+
+/* Send the queued responses of a connection
+
+   The segments of the pending responses, the header blocks and the content
+   they point at, are gathered into one `sendmsg()` call, so pipelined
+   requests cost one system call per batch rather than one per response and
+   no content is copied. A response whose content is a file ends the batch:
+   once its header block is out, the file follows with `sendfile()` straight
+   from its descriptor, and the offset kept in the response lets a large file
+   continue on the next call. `MSG_MORE` is set whenever more data follows the
+   batch, so the kernel does not push a short header segment on its own. Each
+   response is released as soon as it has been sent completely.
+
+   When the socket buffer is full, the function returns `RX_AGAIN` and the
+   queue keeps everything that is left, down to the offset inside a segment or
+   a file. The connection stays registered for `EPOLLOUT`, so the loop goes
+   back to `epoll_wait()` and the flush resumes only when the kernel reports
+   the socket as writable again: a slow reader costs nothing while it waits.
+   The send timeout is restarted whenever some bytes are written, and the
+   connection timer closes a client that stops reading altogether.
+ */
+static int
+rx_event_loop_flush(
+    struct rx_event_loop *loop, struct rx_connection *conn, size_t *nbytes
+)
+{
+    struct iovec iov[RX_CONNECTION_MAX_PIPELINE * RX_RESPONSE_MAX_SEGMENTS];
+    const size_t niov_max = sizeof(iov) / sizeof(*iov);
+
+    struct msghdr msg;
+    struct rx_response *res;
+    ssize_t nsend;
+    size_t niov, nseg, left;
+    off_t offset;
+    int more;
+
+    while ((res = conn->resp_queue_head) != NULL)
+    {
+        if (res->segment == res->nsegments)
+        {
+            /* Only the file content of the first response is left */
+
+            offset = res->content_offset;
+            nsend  = sendfile(
+                conn->fd, res->content_fd, &offset,
+                res->content_length - (size_t)res->content_offset
+            );
+
+            if (nsend == 0)
+            {
+                /* The file has been truncated since it was opened */
+
+                errno = EIO;
+                return RX_ERROR;
+            }
+        }
+        else
+        {
+            niov = 0;
+            more = 0;
+
+            for (; res != NULL; res = res->next)
+            {
+                if (niov + RX_RESPONSE_MAX_SEGMENTS > niov_max)
+                {
+                    more = 1;
+                    break;
+                }
+
+                nseg = res->nsegments - res->segment;
+
+                memcpy(
+                    &iov[niov], &res->segments[res->segment],
+                    nseg * sizeof(*iov)
+                );
+                niov += nseg;
+
+                if (res->content_fd != -1 && res->content_length > 0)
+                {
+                    more = 1;
+                    break;
+                }
+            }
+
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov    = iov;
+            msg.msg_iovlen = niov;
+
+            nsend = sendmsg(
+                conn->fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0)
+            );
+        }
+
+        if (nsend == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return RX_AGAIN;
+            }
+
+            return RX_ERROR;
+        }
+
+        if (nsend > 0)
+        {
+            rx_event_loop_arm(loop, conn, rx_core_opts.send_timeout);
+        }
+
+        *nbytes += (size_t)nsend;
+        left     = (size_t)nsend;
+
+        while ((res = conn->resp_queue_head) != NULL)
+        {
+            left -= rx_response_advance(res, left);
+
+            if (!rx_response_is_sent(res))
+            {
+                break;
+            }
+
+            conn->resp_queue_head = res->next;
+
+            /* The response object itself belongs to the arena of the
+               connection, only its content file is closed here */
+
+            rx_response_destroy(res);
+        }
+    }
+
+    conn->resp_queue_tail = NULL;
+
+    return RX_OK;
+}
+
+/* Change the events the socket of a connection is registered for
+
+   The registration is only changed when it differs from the current one, so
+   a connection that is served without waiting for the socket costs no
+   `epoll_ctl()` call.
+ */
+static int
+rx_event_loop_watch(
+    struct rx_event_loop *loop, struct rx_connection *conn, uint32_t events
+)
+{
+    struct epoll_event ev;
+
+    if (conn->events == events)
+    {
+        return RX_OK;
+    }
+
+    ev.events   = events;
+    ev.data.ptr = conn;
+
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev) == -1)
+    {
+        return RX_ERROR;
+    }
+
+    conn->events = events;
+
+    return RX_OK;
+}
+
+/* Send the responses of a connection and decide what comes next
+
+   The responses are written right away. If the socket buffer fills up, the
+   socket is watched for `EPOLLOUT` and the function is called again when it
+   is writable. Once everything is sent, the connection is either closed, or
+   reset to serve the next request. When a pipelined request is already
+   complete in the buffer, the function returns `RX_AGAIN` and the caller
+   dispatches it with `rx_event_loop_dispatch()`. Otherwise the socket is
+   watched for `EPOLLIN` again.
+
+   Only a failure that stops the loop is returned as `RX_ERROR`, with the
+   reason in the message buffer of the loop.
+ */
+static int
+rx_event_loop_write(struct rx_event_loop *loop, struct rx_connection *conn)
+{
+    int fd       = conn->fd;
+    size_t nsend = 0;
+    int ret, keep_alive;
+
+    /* The last response of the batch decides whether the connection stays
+       open. */
+
+    keep_alive = conn->resp_queue_tail != NULL &&
+                 conn->resp_queue_tail->keep_alive;
+
+    /* The timer is only started by the first attempt of a batch, after that
+       it is restarted by the progress of the flush */
+
+    if (!rx_timer_is_active(&conn->timer))
+    {
+        rx_event_loop_arm(loop, conn, rx_core_opts.send_timeout);
+    }
+
+    ret = rx_event_loop_flush(loop, conn, &nsend);
+
+    if (ret == RX_AGAIN)
+    {
+        /* The socket buffer is full. The rest of the queue is sent on the
+           next EPOLLOUT event. */
+
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_DEBUG,
+            "Sent %zu bytes to fd %d, waiting for writability\n", nsend, fd
+        );
+
+        if (rx_event_loop_watch(loop, conn, EPOLLOUT | EPOLLET) != RX_OK)
+        {
+            rx_log(
+                LOG_LEVEL_0, LOG_TYPE_ERROR, "epoll_ctl (at %s:%d): %s\n",
+                __FILE__, __LINE__, strerror(errno)
+            );
+
+            rx_event_loop_close(loop, conn);
+        }
+
+        return RX_OK;
+    }
+
+    if (ret != RX_OK)
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "send (at %s:%d): %s\n", __FILE__,
+            __LINE__, strerror(errno)
+        );
+
+        rx_event_loop_close(loop, conn);
+        return RX_OK;
+    }
+
+    rx_log(
+        LOG_LEVEL_0, LOG_TYPE_DEBUG, "Sent %zu bytes to fd %d\n", nsend, fd
+    );
+
+    conn->task_num--;
+
+    if (!keep_alive)
+    {
+        rx_event_loop_close(loop, conn);
+        return RX_OK;
+    }
+
+    /*
+       The connection is persistent: reset the request and response in place
+       and wait for the next request on the same socket.
+     */
+
+    rx_connection_cleanup(conn);
+
+    /* More pipelined requests might be in the buffer already, so process them
+       before reading from the socket again. */
+
+    if (rx_connection_find_request(conn) == RX_OK)
+    {
+        conn->task_num++;
+
+        return RX_AGAIN;
+    }
+
+    /* The client has closed its side after the requests it sent, so there is
+       nothing left to wait for */
+
+    if (conn->eof)
+    {
+        rx_event_loop_close(loop, conn);
+        return RX_OK;
+    }
+
+    /* An idle connection does not need a buffer until the next request
+       arrives */
+    rx_connection_release_buffer(conn);
+
+    /* Modifying the registration reports the data that the client sent while
+       the connection was busy, which the edge-triggered socket would not
+       report again otherwise */
+
+    if (conn->readable)
+    {
+        conn->readable = 0;
+        conn->events   = 0;
+    }
+
+    if (rx_event_loop_watch(loop, conn, RX_CONNECTION_EVENTS) != RX_OK)
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "epoll_ctl (at %s:%d): %s\n",
+            __FILE__, __LINE__, strerror(errno)
+        );
+
+        rx_event_loop_close(loop, conn);
+        return RX_OK;
+    }
+
+    rx_event_loop_arm(loop, conn, rx_core_opts.keepalive_timeout);
+
+    return RX_OK;
+}
+
+/* Serve the complete requests of a connection
+
+   Requests whose routes do not block are answered right here on the loop
+   thread, and their responses written at once, which costs no handoff to the
+   thread pool. As soon as the next request might block, the connection is
+   submitted to the thread pool instead.
+ */
+static int
+rx_event_loop_dispatch(struct rx_event_loop *loop, struct rx_connection *conn)
+{
+    rx_workload_t workload;
+    int ret;
+
+    while ((workload = rx_connection_workload(conn)) == RX_WORKLOAD_LOOP)
+    {
+        if (rx_connection_prepare(conn) != RX_OK)
+        {
+            sprintf(loop->msg, "rx_connection_prepare: %s\n", strerror(errno));
+            return RX_ERROR;
+        }
+
+        rx_timer_wheel_del(&loop->timers, &conn->timer);
+
+        conn->state          = RX_CONNECTION_STATE_SERVING_REQUEST;
+        conn->request->state = RX_REQUEST_STATE_METHOD;
+
+        (void)rx_connection_process_inline(conn);
+
+        conn->state = RX_CONNECTION_STATE_WRITING_RESPONSE;
+
+        ret = rx_event_loop_write(loop, conn);
+
+        if (ret != RX_AGAIN)
+        {
+            return ret;
+        }
+    }
+
+    return rx_event_loop_submit(loop, conn, workload);
+}
+
+/* Take back the connections that the workers have served
+
+   The event file descriptor is reset before the queue is taken, so a worker
+   that pushes to the queue after that rings it again and nothing is missed.
+ */
+static int
+rx_event_loop_drain(struct rx_event_loop *loop)
+{
+    struct rx_mpsc_node *node, *next;
+    struct rx_connection *conn;
+    uint64_t count;
+    size_t nsend;
+    int ret;
+
+    if (read(loop->notify_fd, &count, sizeof(count)) == -1 && errno != EAGAIN)
+    {
+        sprintf(loop->msg, "read(eventfd): %s\n", strerror(errno));
+        return RX_ERROR;
+    }
+
+    for (node = rx_mpsc_take(&loop->completions); node != NULL; node = next)
+    {
+        next = node->next;
+        conn = (struct rx_connection *)(
+            (char *)node - offsetof(struct rx_connection, completion)
+        );
+
+        /* The client went away while the worker was serving it. The socket
+           has been removed from the epoll instance already, so the responses
+           finished before the cancellation get a single attempt. */
+
+        if (rx_connection_is_cancelled(conn))
+        {
+            nsend = 0;
+            (void)rx_event_loop_flush(loop, conn, &nsend);
+            rx_timer_wheel_del(&loop->timers, &conn->timer);
+
+            rx_log(
+                LOG_LEVEL_0, LOG_TYPE_INFO, "Connection closed on fd %d\n",
+                conn->fd
+            );
+
+            rx_connection_free(conn);
+            rx_slab_free(&loop->conns, conn);
+            continue;
+        }
+
+        conn->state = RX_CONNECTION_STATE_WRITING_RESPONSE;
+
+        ret = rx_event_loop_write(loop, conn);
+
+        if (ret == RX_AGAIN)
+        {
+            ret = rx_event_loop_dispatch(loop, conn);
+        }
+
+        if (ret != RX_OK)
+        {
+            return RX_ERROR;
+        }
+    }
+
+    return RX_OK;
+}
+
+int
+rx_event_loop_post(struct rx_event_loop *loop, struct rx_connection *conn)
+{
+    uint64_t one = 1;
+
+    if (rx_mpsc_push(&loop->completions, &conn->completion) &&
+        write(loop->notify_fd, &one, sizeof(one)) == -1)
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "write(eventfd): %s\n",
+            strerror(errno)
+        );
+
+        return RX_ERROR;
+    }
+
+    return RX_OK;
+}
+
+int
+rx_event_loop_init(struct rx_event_loop *loop, size_t id, int server_fd)
+{
+    int ret;
+
+    loop->id        = id;
+    loop->server_fd = server_fd;
+    loop->client_fd = -1;
+    loop->epoll_fd  = epoll_create1(0);
+
+    loop->notify_fd = -1;
+
+    memset(loop->msg, 0, sizeof(loop->msg));
+    rx_timer_wheel_init(&loop->timers, rx_timer_now());
+    rx_slab_init(&loop->conns, sizeof(struct rx_connection));
+    rx_buffer_pool_init(&loop->buffers);
+    rx_mpsc_init(&loop->completions);
+    rx_timer_init(&loop->accept_timer, rx_event_loop_resume, loop);
+
+    if (loop->epoll_fd == -1)
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "epoll_create1: %s\n", strerror(errno)
+        );
+
+        return RX_ERROR;
+    }
+
+    loop->ev.events  = EPOLLIN;
+    loop->ev.data.fd = server_fd;
+
+    ret = epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, server_fd, &loop->ev);
+
+    if (ret == -1)
+    {
+        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "epoll_ctl: %s\n", strerror(errno));
+        assert(close(loop->epoll_fd) == 0);
+
+        return RX_ERROR;
+    }
+
+    /* Workers ring the event file descriptor to hand connections back */
+
+    loop->notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (loop->notify_fd == -1)
+    {
+        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "eventfd: %s\n", strerror(errno));
+        assert(close(loop->epoll_fd) == 0);
+
+        return RX_ERROR;
+    }
+
+    loop->ev.events  = EPOLLIN;
+    loop->ev.data.fd = loop->notify_fd;
+
+    ret = epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->notify_fd, &loop->ev);
+
+    if (ret == -1)
+    {
+        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "epoll_ctl: %s\n", strerror(errno));
+        assert(close(loop->notify_fd) == 0);
+        assert(close(loop->epoll_fd) == 0);
+
+        return RX_ERROR;
+    }
+
+    return RX_OK;
+}
+
+void
+rx_event_loop_destroy(struct rx_event_loop *loop)
+{
+    if (loop->epoll_fd != -1)
+    {
+        assert(close(loop->epoll_fd) == 0);
+        loop->epoll_fd = -1;
+    }
+
+    if (loop->server_fd != -1)
+    {
+        assert(close(loop->server_fd) == 0);
+        loop->server_fd = -1;
+    }
+
+    if (loop->notify_fd != -1)
+    {
+        assert(close(loop->notify_fd) == 0);
+        loop->notify_fd = -1;
+    }
+
+    rx_slab_destroy(&loop->conns);
+    rx_buffer_pool_destroy(&loop->buffers);
+}
+
+void *
+rx_event_loop_run(void *arg)
+{
+    struct rx_event_loop *loop = arg;
+
+    struct rx_connection *failed;
+    int ret, n, i, completed;
+    struct sockaddr_storage client;
+    socklen_t client_len;
+
+    ret = RX_OK;
+    n   = 0;
+    i   = 0;
+
+    rx_log(
+        LOG_LEVEL_0, LOG_TYPE_INFO, "Event loop %zu is running on fd %d\n",
+        loop->id, loop->server_fd
+    );
+
+    /* Main event loop */
+    for (;;)
+    {
+        /*
+           Get a list of file descriptors with events that need to be processed.
+
+           Otherwise, epoll_wait() will block until an event arrives or the
+           next connection timer of the loop expires.
+         */
+        n = epoll_wait(
+            loop->epoll_fd, loop->events, RX_MAX_EVENTS,
+            rx_timer_wheel_timeout(&loop->timers)
+        );
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            sprintf(loop->msg, "epoll_wait: %s\n", strerror(errno));
+            goto err_epoll;
+        }
+
+        completed = 0;
+
+        for (i = 0; i < n; ++i)
+        {
+            /*
+               If the event comes from the event file descriptor, workers have
+               handed connections back. They are taken after the other events,
+               so none of these can refer to a connection closed meanwhile.
+             */
+
+            if (loop->events[i].data.fd == loop->notify_fd)
+            {
+                completed = 1;
+                continue;
+            }
+
+            /*
+               If the event comes from the server file descriptor, there is a
+               new client that wants to establish a connection with the
+               server.
+
+               The remaining events are from client file descriptors.
+             */
+
+            if (loop->events[i].data.fd == loop->server_fd)
+            {
+                memset(&client, 0, sizeof(client));
+                client_len = sizeof(client);
+                loop->client_fd = accept(
+                    loop->server_fd, (struct sockaddr *)&client, &client_len
+                );
+
+                if (loop->client_fd == -1)
+                {
+                    if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    {
+                        continue;
+                    }
+
+                    rx_log(
+                        LOG_LEVEL_0, LOG_TYPE_WARN, "accept: %s\n",
+                        strerror(errno)
+                    );
+
+                    /* The clients wait in the backlog until connections are
+                       closed and free some descriptors */
+
+                    if (errno == EMFILE || errno == ENFILE)
+                    {
+                        rx_event_loop_pause(loop);
+                        continue;
+                    }
+
+                    /* Only the client that was being accepted is lost, the
+                       loop keeps serving the others */
+
+                    if (errno == ECONNABORTED || errno == EINTR ||
+                        errno == EPROTO || errno == EPERM ||
+                        errno == ENOBUFS || errno == ENOMEM)
+                    {
+                        continue;
+                    }
+
+                    sprintf(loop->msg, "accept: %s\n", strerror(errno));
+                    goto err_epoll;
+                }
+
+                /* Set client file descriptor to non blocking mode */
+
+                ret = fcntl(loop->client_fd, F_SETFL, O_NONBLOCK);
+                if (ret == -1)
+                {
+                    rx_log(
+                        LOG_LEVEL_0, LOG_TYPE_WARN, "fcntl: %s\n",
+                        strerror(errno)
+                    );
+
+                    close(loop->client_fd);
+                    continue;
+                }
+
+                struct rx_connection *conn = rx_slab_alloc(&loop->conns);
+
+                if (conn == NULL)
+                {
+                    rx_log(
+                        LOG_LEVEL_0, LOG_TYPE_WARN, "malloc: %s\n",
+                        strerror(errno)
+                    );
+
+                    close(loop->client_fd);
+                    continue;
+                }
+
+                rx_connection_init(
+                    conn, loop, loop->client_fd, (struct sockaddr *)&client,
+                    client_len
+                );
+
+                rx_timer_init(&conn->timer, rx_event_loop_expire, conn);
+
+                /*
+                   Each epoll_event struct allows client file descriptors to
+                   store a pointer. Therefore we can store a pointer to the
+                   connection.
+                 */
+
+                loop->ev.events   = RX_CONNECTION_EVENTS;
+                loop->ev.data.ptr = conn;
+
+                ret = epoll_ctl(
+                    loop->epoll_fd, EPOLL_CTL_ADD, loop->client_fd, &loop->ev
+                );
+                if (ret != 0)
+                {
+                    rx_log(
+                        LOG_LEVEL_0, LOG_TYPE_WARN, "epoll_ctl: %s\n",
+                        strerror(errno)
+                    );
+
+                    rx_connection_free(conn);
+                    rx_slab_free(&loop->conns, conn);
+                    loop->ev.data.ptr = NULL;
+                    continue;
+                }
+
+                conn->events = loop->ev.events;
+
+                /* The first request has to arrive within the header timeout */
+                rx_event_loop_arm(loop, conn, rx_core_opts.header_timeout);
+
+                rx_log(
+                    LOG_LEVEL_0, LOG_TYPE_INFO, "New connection from %s\n",
+                    rx_connection_peer(conn)
+                );
+
+                continue;
+            }
+
+            /*
+               If the event is an EPOLLERR or EPOLLHUP event, the socket has
+               failed and nobody will read the responses. An EPOLLRDHUP event
+               only ends the input: a connection that a worker serves is
+               closed after its responses, an idle one reads what is left in
+               the EPOLLIN branch below.
+
+               This is checked before the EPOLLIN branch, which only marks a
+               busy connection as readable.
+             */
+
+            else if ((ret = rx_connection_hangup(
+                          loop->events[i].data.ptr, loop->events[i].events
+                      )) != RX_OK)
+            {
+                struct rx_connection *conn = loop->events[i].data.ptr;
+                int fd                     = conn->fd;
+
+                rx_timer_wheel_del(&loop->timers, &conn->timer);
+
+                if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, fd, NULL) == -1)
+                {
+                    sprintf(loop->msg, "epoll_ctl: %s\n", strerror(errno));
+                    goto err_loop;
+                }
+
+                rx_log(
+                    LOG_LEVEL_0, LOG_TYPE_WARN,
+                    "Connection closed on fd %d with error %s (event "
+                    "code = %ld)\n",
+                    fd,
+                    loop->events[i].events & EPOLLERR ? "EPOLLERR"
+                                                      : "EPOLLHUP",
+                    loop->events[i].events
+                );
+
+                /* A worker still uses the connection, so it is only released
+                   when the worker hands it back */
+
+                if (ret == RX_AGAIN)
+                {
+                    continue;
+                }
+
+                rx_connection_free(conn);
+                rx_slab_free(&loop->conns, conn);
+                loop->events[i].data.ptr = NULL;
+
+                continue;
+            }
+
+            /*
+               If the event is an EPOLLIN event, the client has sent data
+               (request), and the server needs to read it.
+             */
+
+            else if (loop->events[i].events & EPOLLIN)
+            {
+                struct rx_connection *conn = loop->events[i].data.ptr;
+                int fd                     = conn->fd;
+                int eof;
+
+                if (conn->state == RX_CONNECTION_STATE_READING_HEADER ||
+                    conn->state == RX_CONNECTION_STATE_READING_BODY)
+                {
+                    goto continue_reading;
+                }
+
+                /*
+                   A worker is still processing the requests in the buffer.
+                   The new bytes stay in the socket and are reported again
+                   when EPOLLIN is re-armed after the responses are sent.
+                 */
+                if (conn->task_num > 0)
+                {
+                    rx_log(
+                        LOG_LEVEL_0, LOG_TYPE_DEBUG,
+                        "Connection on fd %d is busy\n", fd
+                    );
+
+                    conn->readable = 1;
+                    continue;
+                }
+
+                conn->state = RX_CONNECTION_STATE_READING_HEADER;
+                conn->task_num++;
+
+                rx_event_loop_arm(loop, conn, rx_core_opts.header_timeout);
+
+                rx_log(
+                    LOG_LEVEL_0, LOG_TYPE_INFO, "No. tasks from fd %d: %ld\n",
+                    fd, conn->task_num
+                );
+
+            continue_reading:
+                if (rx_event_loop_read(conn, &eof) != RX_OK)
+                {
+                    rx_log(
+                        LOG_LEVEL_0, LOG_TYPE_ERROR,
+                        "Failed to read from fd %d: %s\n", fd, strerror(errno)
+                    );
+
+                    rx_event_loop_close(loop, conn);
+                    continue;
+                }
+
+                conn->eof = eof;
+
+                if (rx_connection_find_request(conn) == RX_OK)
+                {
+                    if (rx_event_loop_dispatch(loop, conn) != RX_OK)
+                    {
+                        goto err_loop;
+                    }
+
+                    continue;
+                }
+
+                if (eof)
+                {
+                    rx_log(
+                        LOG_LEVEL_0, LOG_TYPE_WARN,
+                        "Connection closed by peer on fd %d\n", fd
+                    );
+
+                    rx_event_loop_close(loop, conn);
+                    continue;
+                }
+
+                /* The header is complete but the body is not. The body
+                   timeout is restarted every time a part of it arrives. */
+
+                if (conn->body_start > conn->request_start)
+                {
+                    if (conn->state != RX_CONNECTION_STATE_READING_BODY &&
+                        rx_event_loop_body(conn) != RX_OK)
+                    {
+                        rx_log(
+                            LOG_LEVEL_0, LOG_TYPE_ERROR,
+                            "Failed to read the body on fd %d\n", fd
+                        );
+
+                        rx_event_loop_close(loop, conn);
+                        continue;
+                    }
+
+                    rx_event_loop_arm(loop, conn, rx_core_opts.body_timeout);
+                    continue;
+                }
+
+                if (conn->buffer_end - conn->request_start >=
+                    RX_HEADER_BUFFER_SIZE)
+                {
+                    rx_log(
+                        LOG_LEVEL_0, LOG_TYPE_ERROR, "Header buffer overflow\n"
+                    );
+
+                    rx_event_loop_close(loop, conn);
+                    continue;
+                }
+
+                rx_log(
+                    LOG_LEVEL_0, LOG_TYPE_DEBUG, "No end of header found\n\t%s",
+                    conn->request_start
+                );
+            }
+
+            /*
+               If the evenet is an EPOLLOUT event, the socket has room again
+               for the responses that did not fit when the worker handed the
+               connection back.
+             */
+
+            else if (loop->events[i].events & EPOLLOUT)
+            {
+                struct rx_connection *conn = loop->events[i].data.ptr;
+
+                if (conn->state != RX_CONNECTION_STATE_WRITING_RESPONSE)
+                {
+                    continue;
+                }
+
+                ret = rx_event_loop_write(loop, conn);
+
+                if (ret == RX_AGAIN)
+                {
+                    ret = rx_event_loop_dispatch(loop, conn);
+                }
+
+                if (ret != RX_OK)
+                {
+                    goto err_loop;
+                }
+            }
+        }
+
+        if (completed && rx_event_loop_drain(loop) != RX_OK)
+        {
+            goto err_loop;
+        }
+
+        /* Close the connections whose timers have expired. This runs after
+           the events are dispatched, so no pending event can refer to a
+           connection freed by a timer. */
+
+        rx_timer_wheel_advance(&loop->timers, rx_timer_now());
+    }
+
+    goto exit_with_grace;
+
+err_loop:
+    /* Only the event being handled when the loop failed is known to refer to
+       a live connection, the ones before it may have been closed already. The
+       event of a client holds its connection, not a descriptor. A connection
+       held by a worker is left to it. */
+
+    if (i < n && loop->events[i].data.fd != loop->server_fd &&
+        loop->events[i].data.fd != loop->notify_fd)
+    {
+        failed = loop->events[i].data.ptr;
+
+        if (failed != NULL &&
+            failed->state != RX_CONNECTION_STATE_SERVING_REQUEST)
+        {
+            rx_event_loop_close(loop, failed);
+        }
+    }
+
+err_epoll:
+    /* The loop is not destroyed, the connections held by workers are still
+       handed back to it */
+    rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, loop->msg);
+    ret = RX_ERROR;
+
+exit_with_grace:
+    return ret == RX_OK ? RX_OK_PTR : RX_ERROR_PTR;
+}
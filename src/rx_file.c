@@ -125,13 +125,7 @@ rx_file_open(struct rx_file *fstruct, const char *path, int flags)
         return RX_FATAL_WITH_ERROR;
     }
 
-    fstruct->path = strdup(path);
-    if (fstruct->path == NULL)
-    {
-        close(fd);
-        return RX_ALLOC_FAILED;
-    }
-
+    fstruct->path  = path;
     fstruct->flags = flags;
     fstruct->name  = basename(fstruct->path);
     fstruct->ext   = strrchr(fstruct->name, '.');
@@ -145,6 +139,7 @@ rx_file_open(struct rx_file *fstruct, const char *path, int flags)
     // TODO: Add support for file types
     fstruct->mime = rx_file_mime(fstruct->name, strlen(fstruct->name));
     fstruct->size = st.st_size;
+    fstruct->mode = st.st_mode;
 
     memset(&fstruct->mod, 0, sizeof(struct timespec));
     memcpy(&fstruct->mod, &st.st_mtim, sizeof(struct timespec));
@@ -155,11 +150,6 @@ rx_file_open(struct rx_file *fstruct, const char *path, int flags)
 int
 rx_file_close(struct rx_file *fstruct)
 {
-    if (fstruct->path != NULL)
-    {
-        free(fstruct->path);
-    }
-
     if (fstruct->fd >= 0)
     {
         close(fstruct->fd);
@@ -0,0 +1,181 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+struct rx_header_entry
+{
+    const char *name;
+    size_t len;
+};
+
+/* clang-format off */
+static const struct rx_header_entry rx_header_names[RX_HEADER_MAX] = {
+    [RX_HEADER_UNKNOWN] = {NULL, 0},
+    [RX_HEADER_ACCEPT] = {"Accept", 6},
+    [RX_HEADER_ACCEPT_CHARSET] = {"Accept-Charset", 14},
+    [RX_HEADER_ACCEPT_ENCODING] = {"Accept-Encoding", 15},
+    [RX_HEADER_ACCEPT_LANGUAGE] = {"Accept-Language", 15},
+    [RX_HEADER_ACCESS_CONTROL_REQUEST_HEADERS] =
+        {"Access-Control-Request-Headers", 30},
+    [RX_HEADER_ACCESS_CONTROL_REQUEST_METHOD] =
+        {"Access-Control-Request-Method", 29},
+    [RX_HEADER_AUTHORIZATION] = {"Authorization", 13},
+    [RX_HEADER_CACHE_CONTROL] = {"Cache-Control", 13},
+    [RX_HEADER_CONNECTION] = {"Connection", 10},
+    [RX_HEADER_CONTENT_ENCODING] = {"Content-Encoding", 16},
+    [RX_HEADER_CONTENT_LENGTH] = {"Content-Length", 14},
+    [RX_HEADER_CONTENT_TYPE] = {"Content-Type", 12},
+    [RX_HEADER_COOKIE] = {"Cookie", 6},
+    [RX_HEADER_DATE] = {"Date", 4},
+    [RX_HEADER_DNT] = {"DNT", 3},
+    [RX_HEADER_EXPECT] = {"Expect", 6},
+    [RX_HEADER_FORWARDED] = {"Forwarded", 9},
+    [RX_HEADER_FROM] = {"From", 4},
+    [RX_HEADER_HOST] = {"Host", 4},
+    [RX_HEADER_IF_MATCH] = {"If-Match", 8},
+    [RX_HEADER_IF_MODIFIED_SINCE] = {"If-Modified-Since", 17},
+    [RX_HEADER_IF_NONE_MATCH] = {"If-None-Match", 13},
+    [RX_HEADER_IF_RANGE] = {"If-Range", 8},
+    [RX_HEADER_IF_UNMODIFIED_SINCE] = {"If-Unmodified-Since", 19},
+    [RX_HEADER_KEEP_ALIVE] = {"Keep-Alive", 10},
+    [RX_HEADER_MAX_FORWARDS] = {"Max-Forwards", 12},
+    [RX_HEADER_ORIGIN] = {"Origin", 6},
+    [RX_HEADER_PRAGMA] = {"Pragma", 6},
+    [RX_HEADER_PRIORITY] = {"Priority", 8},
+    [RX_HEADER_PROXY_AUTHORIZATION] = {"Proxy-Authorization", 19},
+    [RX_HEADER_RANGE] = {"Range", 5},
+    [RX_HEADER_REFERER] = {"Referer", 7},
+    [RX_HEADER_SEC_CH_UA] = {"Sec-CH-UA", 9},
+    [RX_HEADER_SEC_CH_UA_MOBILE] = {"Sec-CH-UA-Mobile", 16},
+    [RX_HEADER_SEC_CH_UA_PLATFORM] = {"Sec-CH-UA-Platform", 18},
+    [RX_HEADER_SEC_FETCH_DEST] = {"Sec-Fetch-Dest", 14},
+    [RX_HEADER_SEC_FETCH_MODE] = {"Sec-Fetch-Mode", 14},
+    [RX_HEADER_SEC_FETCH_SITE] = {"Sec-Fetch-Site", 14},
+    [RX_HEADER_SEC_FETCH_USER] = {"Sec-Fetch-User", 14},
+    [RX_HEADER_TE] = {"TE", 2},
+    [RX_HEADER_TRAILER] = {"Trailer", 7},
+    [RX_HEADER_TRANSFER_ENCODING] = {"Transfer-Encoding", 17},
+    [RX_HEADER_UPGRADE] = {"Upgrade", 7},
+    [RX_HEADER_UPGRADE_INSECURE_REQUESTS] = {"Upgrade-Insecure-Requests", 25},
+    [RX_HEADER_USER_AGENT] = {"User-Agent", 10},
+    [RX_HEADER_VIA] = {"Via", 3},
+    [RX_HEADER_X_FORWARDED_FOR] = {"X-Forwarded-For", 15},
+    [RX_HEADER_X_FORWARDED_HOST] = {"X-Forwarded-Host", 16},
+    [RX_HEADER_X_FORWARDED_PROTO] = {"X-Forwarded-Proto", 17},
+    [RX_HEADER_X_REQUESTED_WITH] = {"X-Requested-With", 16},
+};
+
+/* Header of each slot of the hash, by the length, first character and
+   second to last character of its lowercased name */
+static const uint8_t rx_header_slots[1 << RX_HEADER_HASH_BITS] = {
+    [RX_HEADER_SLOT(6, 'a', 'p')] = RX_HEADER_ACCEPT,
+    [RX_HEADER_SLOT(14, 'a', 'e')] = RX_HEADER_ACCEPT_CHARSET,
+    [RX_HEADER_SLOT(15, 'a', 'n')] = RX_HEADER_ACCEPT_ENCODING,
+    [RX_HEADER_SLOT(15, 'a', 'g')] = RX_HEADER_ACCEPT_LANGUAGE,
+    [RX_HEADER_SLOT(30, 'a', 'r')] = RX_HEADER_ACCESS_CONTROL_REQUEST_HEADERS,
+    [RX_HEADER_SLOT(29, 'a', 'o')] = RX_HEADER_ACCESS_CONTROL_REQUEST_METHOD,
+    [RX_HEADER_SLOT(13, 'a', 'o')] = RX_HEADER_AUTHORIZATION,
+    [RX_HEADER_SLOT(13, 'c', 'o')] = RX_HEADER_CACHE_CONTROL,
+    [RX_HEADER_SLOT(10, 'c', 'o')] = RX_HEADER_CONNECTION,
+    [RX_HEADER_SLOT(16, 'c', 'n')] = RX_HEADER_CONTENT_ENCODING,
+    [RX_HEADER_SLOT(14, 'c', 't')] = RX_HEADER_CONTENT_LENGTH,
+    [RX_HEADER_SLOT(12, 'c', 'p')] = RX_HEADER_CONTENT_TYPE,
+    [RX_HEADER_SLOT(6, 'c', 'i')] = RX_HEADER_COOKIE,
+    [RX_HEADER_SLOT(4, 'd', 't')] = RX_HEADER_DATE,
+    [RX_HEADER_SLOT(3, 'd', 'n')] = RX_HEADER_DNT,
+    [RX_HEADER_SLOT(6, 'e', 'c')] = RX_HEADER_EXPECT,
+    [RX_HEADER_SLOT(9, 'f', 'e')] = RX_HEADER_FORWARDED,
+    [RX_HEADER_SLOT(4, 'f', 'o')] = RX_HEADER_FROM,
+    [RX_HEADER_SLOT(4, 'h', 's')] = RX_HEADER_HOST,
+    [RX_HEADER_SLOT(8, 'i', 'c')] = RX_HEADER_IF_MATCH,
+    [RX_HEADER_SLOT(17, 'i', 'c')] = RX_HEADER_IF_MODIFIED_SINCE,
+    [RX_HEADER_SLOT(13, 'i', 'c')] = RX_HEADER_IF_NONE_MATCH,
+    [RX_HEADER_SLOT(8, 'i', 'g')] = RX_HEADER_IF_RANGE,
+    [RX_HEADER_SLOT(19, 'i', 'c')] = RX_HEADER_IF_UNMODIFIED_SINCE,
+    [RX_HEADER_SLOT(10, 'k', 'v')] = RX_HEADER_KEEP_ALIVE,
+    [RX_HEADER_SLOT(12, 'm', 'd')] = RX_HEADER_MAX_FORWARDS,
+    [RX_HEADER_SLOT(6, 'o', 'i')] = RX_HEADER_ORIGIN,
+    [RX_HEADER_SLOT(6, 'p', 'm')] = RX_HEADER_PRAGMA,
+    [RX_HEADER_SLOT(8, 'p', 't')] = RX_HEADER_PRIORITY,
+    [RX_HEADER_SLOT(19, 'p', 'o')] = RX_HEADER_PROXY_AUTHORIZATION,
+    [RX_HEADER_SLOT(5, 'r', 'g')] = RX_HEADER_RANGE,
+    [RX_HEADER_SLOT(7, 'r', 'e')] = RX_HEADER_REFERER,
+    [RX_HEADER_SLOT(9, 's', 'u')] = RX_HEADER_SEC_CH_UA,
+    [RX_HEADER_SLOT(16, 's', 'l')] = RX_HEADER_SEC_CH_UA_MOBILE,
+    [RX_HEADER_SLOT(18, 's', 'r')] = RX_HEADER_SEC_CH_UA_PLATFORM,
+    [RX_HEADER_SLOT(14, 's', 's')] = RX_HEADER_SEC_FETCH_DEST,
+    [RX_HEADER_SLOT(14, 's', 'd')] = RX_HEADER_SEC_FETCH_MODE,
+    [RX_HEADER_SLOT(14, 's', 't')] = RX_HEADER_SEC_FETCH_SITE,
+    [RX_HEADER_SLOT(14, 's', 'e')] = RX_HEADER_SEC_FETCH_USER,
+    [RX_HEADER_SLOT(2, 't', 't')] = RX_HEADER_TE,
+    [RX_HEADER_SLOT(7, 't', 'e')] = RX_HEADER_TRAILER,
+    [RX_HEADER_SLOT(17, 't', 'n')] = RX_HEADER_TRANSFER_ENCODING,
+    [RX_HEADER_SLOT(7, 'u', 'd')] = RX_HEADER_UPGRADE,
+    [RX_HEADER_SLOT(25, 'u', 't')] = RX_HEADER_UPGRADE_INSECURE_REQUESTS,
+    [RX_HEADER_SLOT(10, 'u', 'n')] = RX_HEADER_USER_AGENT,
+    [RX_HEADER_SLOT(3, 'v', 'i')] = RX_HEADER_VIA,
+    [RX_HEADER_SLOT(15, 'x', 'o')] = RX_HEADER_X_FORWARDED_FOR,
+    [RX_HEADER_SLOT(16, 'x', 's')] = RX_HEADER_X_FORWARDED_HOST,
+    [RX_HEADER_SLOT(17, 'x', 't')] = RX_HEADER_X_FORWARDED_PROTO,
+    [RX_HEADER_SLOT(16, 'x', 't')] = RX_HEADER_X_REQUESTED_WITH,
+};
+/* clang-format on */
+
+rx_header_t
+rx_header_lookup(const char *name, size_t len)
+{
+    rx_header_t header;
+
+    if (name == NULL || len < 2 || len > RX_HEADER_MAX_NAME_LENGTH)
+    {
+        return RX_HEADER_UNKNOWN;
+    }
+
+    /* Setting bit 5 lowercases a letter and keeps `-` as it is. Any other
+       byte lands on some slot, and fails the comparison below. */
+
+    header = rx_header_slots[RX_HEADER_SLOT(
+        len, name[0] | 0x20, name[len - 2] | 0x20
+    )];
+
+    if (rx_header_names[header].len != len ||
+        strncasecmp(rx_header_names[header].name, name, len) != 0)
+    {
+        return RX_HEADER_UNKNOWN;
+    }
+
+    return header;
+}
+
+const char *
+rx_header_name(rx_header_t header)
+{
+    if (header <= RX_HEADER_UNKNOWN || header >= RX_HEADER_MAX)
+    {
+        return NULL;
+    }
+
+    return rx_header_names[header].name;
+}
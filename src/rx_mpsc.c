@@ -0,0 +1,67 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+void
+rx_mpsc_init(struct rx_mpsc *queue)
+{
+    atomic_init(&queue->head, NULL);
+}
+
+int
+rx_mpsc_push(struct rx_mpsc *queue, struct rx_mpsc_node *node)
+{
+    struct rx_mpsc_node *head = atomic_load_explicit(
+        &queue->head, memory_order_relaxed
+    );
+
+    do
+    {
+        node->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(
+        &queue->head, &head, node, memory_order_release, memory_order_relaxed
+    ));
+
+    return head == NULL;
+}
+
+struct rx_mpsc_node *
+rx_mpsc_take(struct rx_mpsc *queue)
+{
+    struct rx_mpsc_node *node, *next, *prev;
+
+    node = atomic_exchange_explicit(&queue->head, NULL, memory_order_acquire);
+
+    /* The nodes are linked from the newest one, reverse them */
+
+    for (prev = NULL; node != NULL; node = next)
+    {
+        next       = node->next;
+        node->next = prev;
+        prev       = node;
+    }
+
+    return prev;
+}
@@ -0,0 +1,212 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+/* Alignment of the objects handed out by a slab */
+#define RX_SLAB_ALIGN (_Alignof(max_align_t))
+
+/* Size classes of a buffer pool, and how many free buffers each one keeps
+
+   The last class holds the largest request the server accepts: a full header
+   buffer followed by a full body buffer, plus the terminating null byte.
+ */
+static const size_t rx_buffer_class_sizes[RX_BUFFER_POOL_CLASSES] = {
+    4 * 1024,
+    16 * 1024,
+    64 * 1024,
+    256 * 1024,
+    RX_HEADER_BUFFER_SIZE + RX_BODY_BUFFER_SIZE + 1,
+};
+
+static const size_t rx_buffer_class_max_free[RX_BUFFER_POOL_CLASSES] = {
+    1024,
+    256,
+    64,
+    16,
+    4,
+};
+
+void
+rx_slab_init(struct rx_slab *slab, size_t size)
+{
+    if (size < sizeof(void *))
+    {
+        size = sizeof(void *);
+    }
+
+    slab->size   = (size + RX_SLAB_ALIGN - 1) & ~(RX_SLAB_ALIGN - 1);
+    slab->free   = NULL;
+    slab->chunks = NULL;
+    slab->nused  = 0;
+}
+
+void *
+rx_slab_alloc(struct rx_slab *slab)
+{
+    char *chunk, *obj;
+
+    if (slab->free == NULL)
+    {
+        /* The first `RX_SLAB_ALIGN` bytes of a chunk link it to the previous
+           chunk, the objects follow */
+        chunk = malloc(RX_SLAB_ALIGN + slab->size * RX_SLAB_CHUNK_OBJECTS);
+        if (chunk == NULL)
+        {
+            return NULL;
+        }
+
+        *(void **)chunk = slab->chunks;
+        slab->chunks    = chunk;
+
+        obj = chunk + RX_SLAB_ALIGN;
+        for (size_t i = 0; i < RX_SLAB_CHUNK_OBJECTS; ++i)
+        {
+            *(void **)obj = slab->free;
+            slab->free    = obj;
+            obj += slab->size;
+        }
+    }
+
+    obj        = slab->free;
+    slab->free = *(void **)obj;
+    slab->nused++;
+
+    return obj;
+}
+
+void
+rx_slab_free(struct rx_slab *slab, void *obj)
+{
+    *(void **)obj = slab->free;
+    slab->free    = obj;
+    slab->nused--;
+}
+
+void
+rx_slab_destroy(struct rx_slab *slab)
+{
+    void *chunk, *next;
+
+    for (chunk = slab->chunks; chunk != NULL; chunk = next)
+    {
+        next = *(void **)chunk;
+        free(chunk);
+    }
+
+    slab->free   = NULL;
+    slab->chunks = NULL;
+    slab->nused  = 0;
+}
+
+void
+rx_buffer_pool_init(struct rx_buffer_pool *pool)
+{
+    for (size_t i = 0; i < RX_BUFFER_POOL_CLASSES; ++i)
+    {
+        pool->classes[i].size     = rx_buffer_class_sizes[i];
+        pool->classes[i].max_free = rx_buffer_class_max_free[i];
+        pool->classes[i].nfree    = 0;
+        pool->classes[i].free     = NULL;
+    }
+}
+
+char *
+rx_buffer_pool_get(struct rx_buffer_pool *pool, size_t size, size_t *cap)
+{
+    struct rx_buffer_class *class;
+    char *buf;
+
+    for (size_t i = 0; i < RX_BUFFER_POOL_CLASSES; ++i)
+    {
+        class = &pool->classes[i];
+        if (class->size < size)
+        {
+            continue;
+        }
+
+        if (class->free != NULL)
+        {
+            buf         = class->free;
+            class->free = *(void **)buf;
+            class->nfree--;
+        }
+        else if ((buf = malloc(class->size)) == NULL)
+        {
+            return NULL;
+        }
+
+        *cap = class->size;
+        return buf;
+    }
+
+    return NULL;
+}
+
+void
+rx_buffer_pool_put(struct rx_buffer_pool *pool, char *buf, size_t cap)
+{
+    struct rx_buffer_class *class;
+
+    for (size_t i = 0; i < RX_BUFFER_POOL_CLASSES; ++i)
+    {
+        class = &pool->classes[i];
+        if (class->size != cap)
+        {
+            continue;
+        }
+
+        if (class->nfree < class->max_free)
+        {
+            *(void **)buf = class->free;
+            class->free   = buf;
+            class->nfree++;
+            return;
+        }
+
+        break;
+    }
+
+    free(buf);
+}
+
+void
+rx_buffer_pool_destroy(struct rx_buffer_pool *pool)
+{
+    struct rx_buffer_class *class;
+    void *buf, *next;
+
+    for (size_t i = 0; i < RX_BUFFER_POOL_CLASSES; ++i)
+    {
+        class = &pool->classes[i];
+        for (buf = class->free; buf != NULL; buf = next)
+        {
+            next = *(void **)buf;
+            free(buf);
+        }
+
+        class->free  = NULL;
+        class->nfree = 0;
+    }
+}
@@ -24,10 +24,23 @@
 #include <rx_config.h>
 #include <rx_core.h>
 
+static struct rx_qlist_node *
+rx_qlist_node_alloc(struct rx_qlist *list)
+{
+    if (list->arena != NULL)
+    {
+        return rx_arena_alloc(list->arena, sizeof(struct rx_qlist_node));
+    }
+
+    return malloc(sizeof(struct rx_qlist_node));
+}
+
 int
-rx_qlist_create(struct rx_qlist *list)
+rx_qlist_create(struct rx_qlist *list, struct rx_arena *arena)
 {
-    struct rx_qlist_node *node = malloc(sizeof(struct rx_qlist_node));
+    list->arena = arena;
+
+    struct rx_qlist_node *node = rx_qlist_node_alloc(list);
 
     if (node == NULL)
         return RX_ALLOC_FAILED;
@@ -47,16 +60,19 @@ rx_qlist_destroy(struct rx_qlist *list)
 {
     struct rx_qlist_node *node, *next;
 
-    node = list->head->next;
-
-    while (node != NULL)
+    if (list->head != NULL && list->arena == NULL)
     {
-        next = node->next;
-        free(node);
-        node = next;
-    }
+        node = list->head->next;
 
-    free(list->head);
+        while (node != NULL)
+        {
+            next = node->next;
+            free(node);
+            node = next;
+        }
+
+        free(list->head);
+    }
 
     list->head = NULL;
     list->tail = NULL;
@@ -71,7 +87,7 @@ rx_qlist_add(struct rx_qlist *list, const char *value, size_t len, float weight)
 
     struct rx_qlist_node *newNode, *curr;
 
-    newNode = malloc(sizeof(struct rx_qlist_node));
+    newNode = rx_qlist_node_alloc(list);
 
     if (newNode == NULL)
         return RX_ALLOC_FAILED;
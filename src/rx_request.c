@@ -39,7 +39,7 @@ rx_memset_header_accept_encoding(
 );
 
 static void
-rx_memset_header_accept(struct rx_qlist *accept);
+rx_memset_header_accept(struct rx_qlist *accept, struct rx_arena *arena);
 
 static void
 rx_parse_ae_header(
@@ -52,24 +52,89 @@ rx_parse_accept_header(struct rx_qlist *accept, const char *buffer, size_t len);
 static double
 rx_parse_q_value(const char *buffer, size_t len);
 
+/* Process the value of a known header into the request */
+typedef int (*rx_request_header_handler_t)(
+    struct rx_request *request, const char *value, size_t len
+);
+
+static int
+rx_request_header_host(
+    struct rx_request *request, const char *value, size_t len
+);
+
+static int
+rx_request_header_accept(
+    struct rx_request *request, const char *value, size_t len
+);
+
+static int
+rx_request_header_accept_encoding(
+    struct rx_request *request, const char *value, size_t len
+);
+
+static int
+rx_request_header_if_modified_since(
+    struct rx_request *request, const char *value, size_t len
+);
+
+static int
+rx_request_header_content_length(
+    struct rx_request *request, const char *value, size_t len
+);
+
+static int
+rx_request_header_content_type(
+    struct rx_request *request, const char *value, size_t len
+);
+
+static int
+rx_request_header_connection(
+    struct rx_request *request, const char *value, size_t len
+);
+
+static int
+rx_request_header_user_agent(
+    struct rx_request *request, const char *value, size_t len
+);
+
+/* Headers the server acts on. The others are known, but ignored. */
+static const rx_request_header_handler_t
+    rx_request_header_handlers[RX_HEADER_MAX] = {
+        [RX_HEADER_ACCEPT]            = rx_request_header_accept,
+        [RX_HEADER_ACCEPT_ENCODING]   = rx_request_header_accept_encoding,
+        [RX_HEADER_CONNECTION]        = rx_request_header_connection,
+        [RX_HEADER_CONTENT_LENGTH]    = rx_request_header_content_length,
+        [RX_HEADER_CONTENT_TYPE]      = rx_request_header_content_type,
+        [RX_HEADER_HOST]              = rx_request_header_host,
+        [RX_HEADER_IF_MODIFIED_SINCE] = rx_request_header_if_modified_since,
+        [RX_HEADER_USER_AGENT]        = rx_request_header_user_agent,
+};
+
 int
-rx_request_init(struct rx_request *request)
+rx_request_init(struct rx_request *request, struct rx_arena *arena)
 {
+    request->arena  = arena;
     request->method = RX_REQUEST_METHOD_INVALID;
 
     memset(&request->uri, 0, sizeof(request->uri));
     memset(&request->version, 0, sizeof(request->version));
     memset(&request->host, 0, sizeof(request->host));
+    memset(&request->user_agent, 0, sizeof(request->user_agent));
     memset(&request->accept, 0, sizeof(request->accept));
 
     rx_memset_uri(&request->uri);
     rx_memset_version(&request->version);
     rx_memset_header_host(&request->host);
     rx_memset_header_accept_encoding(&request->accept_encoding);
-    rx_memset_header_accept(&request->accept);
+    rx_memset_header_accept(&request->accept, arena);
 
     request->if_modified_since = NULL;
 
+    request->content_length = 0;
+    request->content_type   = RX_HTTP_MIME_NONE;
+    request->content        = NULL;
+    request->keep_alive     = 1;
+
     request->state = RX_REQUEST_STATE_READY;
 
     return RX_OK;
@@ -80,19 +145,14 @@ rx_request_destroy(struct rx_request *request)
 {
     rx_qlist_destroy(&request->accept);
 
-    if (request->if_modified_since != NULL)
-    {
-        free(request->if_modified_since);
-        request->if_modified_since = NULL;
-    }
-
-    /* content does not need to be free'd as it's a pointer to the temporary
-       buffer allocated by the connection. */
+    /* The header values are released with the arena of the request, and
+       content is a pointer to the request buffer of the connection. */
+    request->if_modified_since = NULL;
 }
 
 int
 rx_request_process_start_line(
-    struct rx_request *request, const char *buffer, size_t len
+    struct rx_request *request, const struct rx_tokens *tokens
 )
 {
 #if defined(RX_DEBUG)
@@ -103,203 +163,77 @@ rx_request_process_start_line(
         "[Thread %ld]%4.sProcessing request line\n", tid, ""
     );
 #endif
-    if (buffer == NULL || len == 0)
-    {
-        return RX_ERROR;
-    }
-
     int ret;
-    const char *begin, *end;
-    size_t i;
-
-    i     = 0;
-    begin = end = buffer;
-    ret         = RX_OK;
 
-    for (; i < len && buffer[i] != ' ' && buffer[i] != '\0'; ++i)
+    if (tokens == NULL || tokens->version == NULL)
     {
-        end = end + 1;
-    }
-
-    if (i == len || buffer[i] == '\0')
-    {
-        request->state = RX_REQUEST_STATE_DONE;
         return RX_ERROR;
     }
 
-    ret = rx_request_proccess_method(&request->method, begin, end - begin);
+    ret = rx_request_proccess_method(
+        &request->method, tokens->method, tokens->method_end - tokens->method
+    );
 
     if (ret != RX_OK)
     {
         return RX_ERROR;
     }
 
-    begin = end + 1;
-    end   = end + 1;
-    i     = i + 1;
-
-    for (; i < len && buffer[i] != ' ' && buffer[i] != '\0'; ++i)
-    {
-        end = end + 1;
-    }
-
-    if (i == len || buffer[i] == '\0')
-    {
-        request->state = RX_REQUEST_STATE_DONE;
-        return RX_ERROR;
-    }
-
-    ret = rx_request_process_uri(&request->uri, begin, end - begin);
+    ret = rx_request_process_uri(
+        &request->uri, tokens->uri, tokens->uri_end - tokens->uri
+    );
 
     if (ret != RX_OK)
     {
         return RX_ERROR;
     }
 
-    begin = end + 1;
-    end   = buffer + len;
-
-    ret = rx_request_process_version(&request->version, begin, end - begin);
+    (void)rx_request_process_version(
+        &request->version, tokens->version,
+        tokens->version_end - tokens->version
+    );
 
     return RX_OK;
 }
 
 int
 rx_request_process_headers(
-    struct rx_request *request, const char *buffer, size_t len
+    struct rx_request *request, const struct rx_tokens *tokens
 )
 {
+    const struct rx_token_header *header;
+    rx_request_header_handler_t handler;
+    size_t i;
     int ret;
-    const char *key_begin, *key_end, *value_begin, *value_end;
-
-    ret       = RX_OK;
-    key_begin = key_end = value_begin = value_end = buffer;
 
-    if (buffer == NULL || len == 0)
+    if (tokens == NULL)
     {
-        ret = RX_ERROR;
-        goto end;
+        return RX_ERROR;
     }
 
-    value_end = strstr(key_begin, "\r\n");
-
-    while (value_end != NULL && value_end - key_begin > 0)
+    for (i = 0; i < tokens->nheaders; i++)
     {
+        header  = &tokens->headers[i];
+        handler = rx_request_header_handlers[rx_header_lookup(
+            header->name, header->name_end - header->name
+        )];
 
-        ret = rx_request_parse_header(
-            key_begin, value_end - key_begin, &key_begin, &key_end,
-            &value_begin, &value_end
-        );
-
-        if (ret != RX_OK)
-        {
-            goto end;
-        }
-
-        /* clang-format off */
-        if (strlen("Host") == (key_end - key_begin) 
-            && strncasecmp("Host", key_begin, key_end - key_begin) == 0)
-        {
-
-            ret = rx_request_process_header_host(&request->host, value_begin,
-                                                 value_end - value_begin);
-
-            if (ret != RX_OK)
-            {
-                goto end;
-            }
-        }
-        else if (strlen("Accept-Encoding") == (key_end - key_begin) 
-                 && strncasecmp("Accept-Encoding", 
-                                key_begin, 
-                                key_end - key_begin) == 0)
+        if (handler == NULL)
         {
-            ret = rx_request_process_header_accept_encoding(
-                &request->accept_encoding, value_begin,
-                value_end - value_begin);
-
-            if (ret != RX_OK)
-            {
-                goto end;
-            }
+            continue;
         }
-        else if (strlen("If-Modified-Since") == (key_end - key_begin) 
-                 && strncasecmp("If-Modified-Since", 
-                                key_begin, 
-                                key_end - key_begin) == 0)
-        {
-            request->if_modified_since = malloc(sizeof(struct rx_header_gmt));
-            
-            if (request->if_modified_since == NULL)
-            {
-                ret = RX_ERROR;
-                goto end;
-            }
 
-            memset(request->if_modified_since, 0, sizeof(struct rx_header_gmt));
-
-
-            ret = rx_request_process_header_if_modified_since(
-                request->if_modified_since, value_begin,
-                value_end - value_begin);
-
-            if (ret != RX_OK)
-            {
-                goto end;
-            }
-        }
-        else if (strlen("Accept") == (key_end - key_begin)
-                 && strncasecmp("Accept", key_begin, key_end - key_begin) == 0)
-        {
-            ret = rx_request_process_header_accept(
-                &request->accept, value_begin, value_end - value_begin);
+        ret = handler(
+            request, header->value, header->value_end - header->value
+        );
 
-            if (ret != RX_OK)
-            {
-                goto end;
-            }
-        }
-        else if (strlen("Content-Length") == (key_end - key_begin)
-                 && strncasecmp("Content-Length",
-                                key_begin,
-                                key_end - key_begin) == 0)
-        {
-            ret = rx_request_process_header_content_length(
-                    &request->content_length, 
-                    value_begin, 
-                    value_end - value_begin
-            );
-
-            if (ret != RX_OK)
-            {
-                goto end;
-            }
-        }
-        else if (strlen("Content-Type") == (key_end - key_begin)
-                 && strncasecmp("Content-Type", 
-                                key_begin, 
-                                key_end - key_begin) == 0)
+        if (ret != RX_OK)
         {
-            ret = rx_request_process_header_content_type(
-                &request->content_type, 
-                value_begin,
-                value_end - value_begin
-            );
-
-            if (ret != RX_OK)
-            {
-                goto end;
-            }
+            return ret;
         }
-
-        /* clang-format on */
-
-        key_begin = value_end + 2;
-        value_end = strstr(key_begin, "\r\n");
     }
 
-end:
-    return ret;
+    return RX_OK;
 }
 
 int
@@ -325,7 +259,7 @@ rx_request_parse_header(
         goto end;
     }
 
-    colon = strchr(buffer, ':');
+    colon = memchr(buffer, ':', len);
     end   = buffer + len;
 
     if (colon == NULL || end == NULL)
@@ -412,10 +346,9 @@ rx_request_process_uri(
 )
 {
     int ret;
-    char *path_ptr, *query_string_ptr;
+    const char *path, *query_string;
 
-    ret      = RX_OK;
-    path_ptr = query_string_ptr = NULL;
+    ret = RX_OK;
 
     if (buffer == NULL)
     {
@@ -441,28 +374,29 @@ rx_request_process_uri(
         goto end;
     }
 
-    memcpy(uri->raw_uri, buffer, len);
-    uri->length       = len;
-    uri->raw_uri[len] = '\0';
+    /* The URI is not copied: its parts are views into `buffer` */
 
-    path_ptr = strchr(uri->raw_uri, '/');
+    uri->raw.data = buffer;
+    uri->raw.len  = len;
 
-    if (path_ptr == NULL)
-        path_ptr = uri->raw_uri;
+    query_string = memchr(buffer, '?', len);
 
-    query_string_ptr = strchr(uri->raw_uri, '?');
-
-    if (query_string_ptr != NULL)
+    if (query_string != NULL)
     {
-        uri->path_end         = query_string_ptr;
-        uri->query_string     = query_string_ptr + 1;
-        uri->query_string_end = uri->raw_uri + len;
+        uri->query_string.data = query_string + 1;
+        uri->query_string.len  = buffer + len - query_string - 1;
     }
     else
-        uri->path_end = uri->raw_uri + len;
+        query_string = buffer + len;
+
+    path = memchr(buffer, '/', query_string - buffer);
 
-    uri->path   = path_ptr;
-    uri->result = RX_REQUEST_URI_RESULT_OK;
+    if (path == NULL)
+        path = buffer;
+
+    uri->path.data = path;
+    uri->path.len  = query_string - path;
+    uri->result    = RX_REQUEST_URI_RESULT_OK;
 
 end:
 #if defined(RX_DEBUG)
@@ -483,13 +417,13 @@ end:
 
     rx_log(
         LOG_LEVEL_0, LOG_TYPE_DEBUG, "[Thread %ld]%8.s%sPath: \"%.*s\"\n", tid,
-        "", color, (int)(uri->path_end - uri->path), uri->path
+        "", color, (int)uri->path.len, uri->path.data
     );
 
     rx_log(
         LOG_LEVEL_0, LOG_TYPE_DEBUG,
         "[Thread %ld]%8.s%sQuery string: \"%.*s\"\n", tid, "", color,
-        (int)(uri->query_string_end - uri->query_string), uri->query_string
+        (int)uri->query_string.len, uri->query_string.data
     );
 #endif
     return ret;
@@ -513,7 +447,7 @@ rx_request_process_version(
         goto end;
     }
 
-    slash = strchr(buffer, '/');
+    slash = rx_strnchr(buffer, len, '/');
 
     if (slash == NULL)
     {
@@ -522,7 +456,7 @@ rx_request_process_version(
         goto end;
     }
 
-    if (strncmp("HTTP", buffer, slash - buffer) != 0)
+    if (slash - buffer != 4 || strncmp("HTTP", buffer, 4) != 0)
     {
         version->result = RX_REQUEST_VERSION_RESULT_INVALID;
         ret             = RX_ERROR;
@@ -531,7 +465,7 @@ rx_request_process_version(
     }
 
     major = slash + 1;
-    dot   = strchr(slash, '.');
+    dot   = rx_strnchr(slash, buffer + len - slash, '.');
 
     if (dot == NULL)
     {
@@ -574,7 +508,7 @@ rx_request_process_header_host(
 )
 {
     int ret;
-    char *colon;
+    const char *colon;
 
     if (buffer == NULL || len == 0)
     {
@@ -586,15 +520,10 @@ rx_request_process_header_host(
 
     ret = RX_OK;
 
-    memcpy(host->raw_host, buffer, len);
-    host->raw_host[len] = '\0';
-    host->len           = len;
-
-    colon = strchr(host->raw_host, ':');
+    colon = memchr(buffer, ':', len);
 
     // Colon exists but it is at the first or last position
-    if (colon == host->raw_host || colon == host->raw_host + len - 1)
-
+    if (colon == buffer || colon == buffer + len - 1)
     {
         host->result = RX_REQUEST_HEADER_HOST_RESULT_INVALID;
         ret          = RX_ERROR;
@@ -602,30 +531,31 @@ rx_request_process_header_host(
         goto end;
     }
 
-    if (colon == NULL)
+    if (colon != NULL)
     {
-        host->raw_host[len]       = ':';
-        host->raw_host[len + 1]   = '8';
-        host->raw_host[len + 2]   = '0';
-        colon                     = host->raw_host + len;
-        host->len                 = len + 3;
-        host->raw_host[host->len] = '\0';
+        host->host.data = buffer;
+        host->host.len  = colon - buffer;
+        host->port.data = colon + 1;
+        host->port.len  = buffer + len - colon - 1;
     }
+    else
+    {
+        static const rx_str_t port = rx_string("80");
 
-    host->host     = host->raw_host;
-    host->host_end = host->raw_host + (colon - host->raw_host);
-    host->port     = colon + 1;
-    host->port_end = host->raw_host + host->len;
+        host->host.data = buffer;
+        host->host.len  = len;
+        host->port      = port;
+    }
 
-    if (strncmp("localhost", host->host, host->host_end - host->host) == 0)
+    if (strncmp("localhost", host->host.data, host->host.len) == 0)
     {
         host->result = RX_REQUEST_HEADER_HOST_RESULT_OK;
     }
-    else if (strncmp("0.0.0.0", host->host, host->host_end - host->host) == 0)
+    else if (strncmp("0.0.0.0", host->host.data, host->host.len) == 0)
     {
         host->result = RX_REQUEST_HEADER_HOST_RESULT_OK;
     }
-    else if (strncmp("127.0.0.1", host->host, host->host_end - host->host) == 0)
+    else if (strncmp("127.0.0.1", host->host.data, host->host.len) == 0)
     {
         host->result = RX_REQUEST_HEADER_HOST_RESULT_OK;
     }
@@ -637,19 +567,12 @@ rx_request_process_header_host(
         goto end;
     }
 
-    if (host->port != NULL && host->port_end != NULL)
+    if (strncmp("8080", host->port.data, host->port.len) != 0)
     {
-        if (strncmp("8080", host->port, host->port_end - host->port) != 0)
-        {
-            host->result = RX_REQUEST_HEADER_HOST_RESULT_UNSUPPORTED;
-            ret          = RX_ERROR;
+        host->result = RX_REQUEST_HEADER_HOST_RESULT_UNSUPPORTED;
+        ret          = RX_ERROR;
 
-            goto end;
-        }
-        else
-        {
-            host->result = RX_REQUEST_HEADER_HOST_RESULT_OK;
-        }
+        goto end;
     }
 
 end:
@@ -672,24 +595,26 @@ rx_request_process_header_accept_encoding(
         return RX_OK;
     }
 
+    /* The value is a view into the request buffer, it is not terminated */
+
     begin = buffer;
     end   = buffer + len;
-    comma = strchr(begin, ',');
 
-    while (comma != NULL)
+    while (begin < end)
     {
-        rx_parse_ae_header(accept_encoding, begin, comma - begin);
+        comma = rx_strnchr(begin, end - begin, ',');
 
-        for (comma = comma + 1; *comma == ' '; ++comma)
-            ;
+        rx_parse_ae_header(
+            accept_encoding, begin, (comma != NULL ? comma : end) - begin
+        );
 
-        begin = comma;
-        comma = strchr(begin, ',');
-    }
+        if (comma == NULL)
+        {
+            break;
+        }
 
-    if (comma == NULL && begin != end)
-    {
-        rx_parse_ae_header(accept_encoding, begin, end - begin);
+        for (begin = comma + 1; begin < end && *begin == ' '; ++begin)
+            ;
     }
 
     if (accept_encoding->encoding == RX_ENCODING_UNSET)
@@ -716,7 +641,6 @@ rx_request_process_header_accept(
 #endif
 
     const char *begin, *end, *comma;
-    size_t offset;
 
     // Accept header is present but no value is given
     if (buffer == NULL || len == 0)
@@ -726,25 +650,27 @@ rx_request_process_header_accept(
         return RX_OK;
     }
 
-    begin  = buffer;
-    offset = 0;
-    end    = buffer + len;
-    comma  = rx_strnchr(begin, len, ',');
+    /* The value is a view into the request buffer, it is not terminated */
 
-    while (comma != NULL)
+    begin = buffer;
+    end   = buffer + len;
+
+    while (begin < end)
     {
-        rx_parse_accept_header(accept, begin, comma - begin);
+        comma = rx_strnchr(begin, end - begin, ',');
 
-        for (comma = comma + 1; *comma == ' '; ++comma)
-            ;
+        rx_parse_accept_header(
+            accept, begin, (comma != NULL ? comma : end) - begin
+        );
 
-        offset = comma - buffer - 1;
-        begin  = comma;
-        comma  = rx_strnchr(buffer + offset + 1, len - offset, ',');
-    }
+        if (comma == NULL)
+        {
+            break;
+        }
 
-    if (comma == NULL && begin != end)
-        rx_parse_accept_header(accept, begin, end - begin);
+        for (begin = comma + 1; begin < end && *begin == ' '; ++begin)
+            ;
+    }
 
     return RX_OK;
 }
@@ -770,9 +696,21 @@ rx_request_process_header_if_modified_since(
     }
 
     struct tm tm;
+    char date[64];
+
+    /* `strptime()` needs a terminated string, the value is a view into the
+       request buffer */
+
+    if (len >= sizeof(date))
+    {
+        return RX_ERROR;
+    }
+
+    memcpy(date, buffer, len);
+    date[len] = '\0';
 
     memset(&tm, 0, sizeof(tm));
-    if (strptime(buffer, "%a, %d %b %Y %H:%M:%S %Z", &tm) == NULL)
+    if (strptime(date, "%a, %d %b %Y %H:%M:%S %Z", &tm) == NULL)
     {
 #if defined(RX_DEBUG)
         rx_log(
@@ -785,7 +723,6 @@ rx_request_process_header_if_modified_since(
     }
 
     memcpy(&ims->tm, &tm, sizeof(struct tm));
-    memcpy(ims->raw_gmt, buffer, len);
 
     return RX_OK;
 }
@@ -795,6 +732,8 @@ rx_request_process_header_content_length(
     size_t *content_length, const char *buffer, size_t len
 )
 {
+    size_t i, value;
+
 #if defined(RX_DEBUG)
     pthread_t tid = pthread_self();
 
@@ -805,18 +744,29 @@ rx_request_process_header_content_length(
     );
 #endif
 
-    if (content_length == NULL)
+    if (content_length == NULL || buffer == NULL || len == 0)
     {
         return RX_ERROR;
     }
 
-    if (buffer == NULL || len == 0)
+    /* The value is a run of digits and nothing else. The span is not
+       terminated, and a sign, a trailing suffix or a value too large for
+       `size_t` would frame the body differently than a peer would. */
+
+    value = 0;
+
+    for (i = 0; i < len; i++)
     {
-        *content_length = 0;
-        return RX_OK;
+        if (buffer[i] < '0' || buffer[i] > '9' ||
+            value > (SIZE_MAX - (size_t)(buffer[i] - '0')) / 10)
+        {
+            return RX_ERROR;
+        }
+
+        value = value * 10 + (size_t)(buffer[i] - '0');
     }
 
-    *content_length = atoi(buffer);
+    *content_length = value;
 
     return RX_OK;
 }
@@ -855,6 +805,70 @@ rx_request_process_header_content_type(
     return RX_OK;
 }
 
+int
+rx_request_process_header_connection(
+    int *keep_alive, const char *buffer, size_t len
+)
+{
+#if defined(RX_DEBUG)
+    pthread_t tid = pthread_self();
+
+    rx_log(
+        LOG_LEVEL_0, LOG_TYPE_DEBUG,
+        "[Thread %ld]%4.sConnection header: %.*s\n", tid, "", (int)len, buffer
+    );
+#endif
+
+    const char *begin, *end, *token_end, *comma;
+    size_t token_len;
+
+    if (keep_alive == NULL)
+    {
+        return RX_ERROR;
+    }
+
+    if (buffer == NULL || len == 0)
+    {
+        return RX_OK;
+    }
+
+    /* The header is a comma-separated list of connection options, e.g.
+       `Connection: keep-alive, Upgrade`. The `close` option always wins. */
+
+    begin = buffer;
+    end   = buffer + len;
+
+    while (begin < end)
+    {
+        comma     = rx_strnchr(begin, end - begin, ',');
+        token_end = comma != NULL ? comma : end;
+
+        for (; begin < token_end && *begin == ' '; ++begin)
+            ;
+
+        for (; token_end > begin && *(token_end - 1) == ' '; --token_end)
+            ;
+
+        token_len = token_end - begin;
+
+        if (token_len == 5 && strncasecmp("close", begin, token_len) == 0)
+        {
+            *keep_alive = 0;
+
+            return RX_OK;
+        }
+
+        if (token_len == 10 && strncasecmp("keep-alive", begin, token_len) == 0)
+        {
+            *keep_alive = 1;
+        }
+
+        begin = comma != NULL ? comma + 1 : end;
+    }
+
+    return RX_OK;
+}
+
 int
 rx_request_process_content(
     char *content, size_t content_length, const char *buffer, size_t len
@@ -927,62 +941,67 @@ rx_request_mime_str(rx_http_mime_t mime)
 rx_http_mime_t
 rx_request_mime(const char *mime_str, size_t len)
 {
-    if (mime_str == NULL || len == 0 || strncasecmp("*/*", mime_str, 3) == 0)
+    /* The value is a view into the request buffer, so a type is only
+       compared when the value is long enough to hold it */
+
+    if (mime_str == NULL || len == 0 ||
+        (len >= 3 && strncasecmp("*/*", mime_str, 3) == 0))
     {
         return RX_HTTP_MIME_ALL;
     }
 
-    if (strncasecmp("application/x-www-form-urlencoded", mime_str, 33) == 0)
+    if (len >= 33 &&
+        strncasecmp("application/x-www-form-urlencoded", mime_str, 33) == 0)
     {
         return RX_HTTP_MIME_APPLICATION_XFORM;
     }
 
-    if (strncasecmp("application/json", mime_str, 16) == 0)
+    if (len >= 16 && strncasecmp("application/json", mime_str, 16) == 0)
     {
         return RX_HTTP_MIME_APPLICATION_JSON;
     }
 
-    if (strncasecmp("text/*", mime_str, 6) == 0)
+    if (len >= 6 && strncasecmp("text/*", mime_str, 6) == 0)
     {
         return RX_HTTP_MIME_TEXT_ALL;
     }
 
-    if (strncasecmp("text/html", mime_str, 9) == 0)
+    if (len >= 9 && strncasecmp("text/html", mime_str, 9) == 0)
     {
         return RX_HTTP_MIME_TEXT_HTML;
     }
 
-    if (strncasecmp("text/plain", mime_str, 10) == 0)
+    if (len >= 10 && strncasecmp("text/plain", mime_str, 10) == 0)
     {
         return RX_HTTP_MIME_TEXT_PLAIN;
     }
 
-    if (strncasecmp("text/css", mime_str, 8) == 0)
+    if (len >= 8 && strncasecmp("text/css", mime_str, 8) == 0)
     {
         return RX_HTTP_MIME_TEXT_CSS;
     }
 
-    if (strncasecmp("text/javascript", mime_str, 15) == 0)
+    if (len >= 15 && strncasecmp("text/javascript", mime_str, 15) == 0)
     {
         return RX_HTTP_MIME_TEXT_JS;
     }
 
-    if (strncasecmp("image/*", mime_str, 7) == 0)
+    if (len >= 7 && strncasecmp("image/*", mime_str, 7) == 0)
     {
         return RX_HTTP_MIME_IMAGE_ALL;
     }
 
-    if (strncasecmp("image/jpeg", mime_str, 10) == 0)
+    if (len >= 10 && strncasecmp("image/jpeg", mime_str, 10) == 0)
     {
         return RX_HTTP_MIME_IMAGE_JPEG;
     }
 
-    if (strncasecmp("image/png", mime_str, 9) == 0)
+    if (len >= 9 && strncasecmp("image/png", mime_str, 9) == 0)
     {
         return RX_HTTP_MIME_IMAGE_PNG;
     }
 
-    if (strncasecmp("image/gif", mime_str, 9) == 0)
+    if (len >= 9 && strncasecmp("image/gif", mime_str, 9) == 0)
     {
         return RX_HTTP_MIME_IMAGE_GIF;
     }
@@ -993,13 +1012,13 @@ rx_request_mime(const char *mime_str, size_t len)
 static void
 rx_memset_uri(struct rx_request_uri *uri)
 {
-    memset(uri->raw_uri, 0, sizeof(uri->raw_uri));
-
-    uri->path             = 0;
-    uri->path             = uri->raw_uri;
-    uri->path_end         = uri->raw_uri;
-    uri->query_string     = uri->raw_uri;
-    uri->query_string_end = uri->raw_uri;
+    uri->result            = RX_REQUEST_URI_RESULT_NONE;
+    uri->raw.data          = NULL;
+    uri->raw.len           = 0;
+    uri->path.data         = NULL;
+    uri->path.len          = 0;
+    uri->query_string.data = NULL;
+    uri->query_string.len  = 0;
 }
 
 static void
@@ -1013,13 +1032,11 @@ rx_memset_version(struct rx_request_version *version)
 static void
 rx_memset_header_host(struct rx_header_host *host)
 {
-    memset(host->raw_host, 0, sizeof(host->raw_host));
-
-    host->result   = RX_REQUEST_HEADER_HOST_RESULT_NONE;
-    host->host     = host->raw_host;
-    host->host_end = host->raw_host;
-    host->port     = NULL;
-    host->port_end = NULL;
+    host->result    = RX_REQUEST_HEADER_HOST_RESULT_NONE;
+    host->host.data = NULL;
+    host->host.len  = 0;
+    host->port.data = NULL;
+    host->port.len  = 0;
 }
 
 static void
@@ -1032,9 +1049,9 @@ rx_memset_header_accept_encoding(
 }
 
 static void
-rx_memset_header_accept(struct rx_qlist *accept)
+rx_memset_header_accept(struct rx_qlist *accept, struct rx_arena *arena)
 {
-    rx_qlist_create(accept);
+    rx_qlist_create(accept, arena);
 }
 
 static void
@@ -1044,12 +1061,13 @@ rx_parse_ae_header(
 {
     const char *begin, *semi, *end;
     double qvalue;
+    size_t n;
 
     begin = buffer;
     end   = buffer + len;
-    semi  = strchr(begin, ';');
+    semi  = rx_strnchr(begin, len, ';');
 
-    if (semi == NULL || semi == end)
+    if (semi == NULL)
     {
         qvalue = 1.0;
         semi   = end;
@@ -1059,34 +1077,41 @@ rx_parse_ae_header(
         qvalue = rx_parse_q_value(semi + 1, end - semi - 1);
     }
 
+    for (; semi > begin && *(semi - 1) == ' '; --semi)
+        ;
+
+    /* The whole coding has to match, not only a prefix of the name */
+
+    n = semi - begin;
+
     if (qvalue > ae->qvalue)
     {
-        if (strncmp("gzip", begin, semi - begin) == 0)
+        if (n == 4 && strncmp("gzip", begin, n) == 0)
         {
             ae->encoding = RX_ENCODING_GZIP;
             ae->qvalue   = qvalue;
         }
-        else if (strncmp("deflate", begin, semi - begin) == 0)
+        else if (n == 7 && strncmp("deflate", begin, n) == 0)
         {
             ae->encoding = RX_ENCODING_DEFLATE;
             ae->qvalue   = qvalue;
         }
-        else if (strncmp("br", begin, semi - begin) == 0)
+        else if (n == 2 && strncmp("br", begin, n) == 0)
         {
             ae->encoding = RX_ENCODING_BROTLI;
             ae->qvalue   = qvalue;
         }
-        else if (strncmp("identity", begin, semi - begin) == 0)
+        else if (n == 8 && strncmp("identity", begin, n) == 0)
         {
             ae->encoding = RX_ENCODING_IDENTITY;
             ae->qvalue   = qvalue;
         }
-        else if (strncmp("*", begin, semi - begin) == 0)
+        else if (n == 1 && strncmp("*", begin, n) == 0)
         {
             ae->encoding = RX_ENCODING_ANY;
             ae->qvalue   = qvalue;
         }
-        else if (strncmp("compress", begin, semi - begin) == 0)
+        else if (n == 8 && strncmp("compress", begin, n) == 0)
         {
             ae->encoding = RX_ENCODING_COMPRESS;
             ae->qvalue   = qvalue;
@@ -1136,14 +1161,15 @@ rx_parse_q_value(const char *buffer, size_t len)
 
     begin   = buffer;
     end     = buffer + len;
-    equal   = strchr(begin, '=');
     bufsize = 0;
     ans     = 0.0;
 
-    if (equal == NULL || equal == begin || equal == end)
-        return -1;
+    for (; begin < end && *begin == ' '; ++begin)
+        ;
 
-    if (strncmp("q", begin, equal - begin) != 0)
+    equal = rx_strnchr(begin, end - begin, '=');
+
+    if (equal == NULL || equal - begin != 1 || *begin != 'q')
         return -1;
 
     bufsize = end - equal - 1 > 5 ? 5 : end - equal - 1;
@@ -1159,3 +1185,91 @@ rx_parse_q_value(const char *buffer, size_t len)
 
     return ans;
 }
+
+static int
+rx_request_header_host(
+    struct rx_request *request, const char *value, size_t len
+)
+{
+    return rx_request_process_header_host(&request->host, value, len);
+}
+
+static int
+rx_request_header_accept(
+    struct rx_request *request, const char *value, size_t len
+)
+{
+    return rx_request_process_header_accept(&request->accept, value, len);
+}
+
+static int
+rx_request_header_accept_encoding(
+    struct rx_request *request, const char *value, size_t len
+)
+{
+    return rx_request_process_header_accept_encoding(
+        &request->accept_encoding, value, len
+    );
+}
+
+static int
+rx_request_header_if_modified_since(
+    struct rx_request *request, const char *value, size_t len
+)
+{
+    request->if_modified_since = rx_arena_alloc(
+        request->arena, sizeof(struct rx_header_gmt)
+    );
+
+    if (request->if_modified_since == NULL)
+    {
+        return RX_ERROR;
+    }
+
+    memset(request->if_modified_since, 0, sizeof(struct rx_header_gmt));
+
+    return rx_request_process_header_if_modified_since(
+        request->if_modified_since, value, len
+    );
+}
+
+static int
+rx_request_header_content_length(
+    struct rx_request *request, const char *value, size_t len
+)
+{
+    return rx_request_process_header_content_length(
+        &request->content_length, value, len
+    );
+}
+
+static int
+rx_request_header_content_type(
+    struct rx_request *request, const char *value, size_t len
+)
+{
+    return rx_request_process_header_content_type(
+        &request->content_type, value, len
+    );
+}
+
+static int
+rx_request_header_connection(
+    struct rx_request *request, const char *value, size_t len
+)
+{
+    return rx_request_process_header_connection(
+        &request->keep_alive, value, len
+    );
+}
+
+static int
+rx_request_header_user_agent(
+    struct rx_request *request, const char *value, size_t len
+)
+{
+    request->user_agent.data = value;
+    request->user_agent.len  = len;
+
+    return RX_OK;
+}
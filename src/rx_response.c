@@ -25,7 +25,7 @@
 #include <rx_core.h>
 
 int
-rx_response_init(struct rx_response *res)
+rx_response_init(struct rx_response *res, struct rx_arena *arena)
 {
     if (res == NULL)
     {
@@ -35,17 +35,21 @@ rx_response_init(struct rx_response *res)
     res->status_code    = RX_HTTP_STATUS_CODE_UNSET;
     res->status_message = NULL;
 
-    res->location = NULL;
+    res->location      = NULL;
+    res->last_modified = NULL;
 
-    res->is_content_mmapd = 0;
-    res->content          = NULL;
-    res->content_length   = 0;
-    res->content_type     = 0;
+    res->content        = NULL;
+    res->content_length = 0;
+    res->content_type   = 0;
+    res->content_fd     = -1;
+    res->content_offset = 0;
 
-    res->is_resp_alloc   = 0;
-    res->resp_buf        = NULL;
-    res->resp_buf_offset = 0;
-    res->resp_buf_size   = 0;
+    res->nsegments = 0;
+    res->segment   = 0;
+
+    res->keep_alive = 0;
+    res->next       = NULL;
+    res->arena      = arena;
 
     return RX_OK;
 }
@@ -53,36 +57,21 @@ rx_response_init(struct rx_response *res)
 void
 rx_response_destroy(struct rx_response *res)
 {
-    if (res->content != NULL)
-    {
-        if (res->is_content_mmapd == 1)
-            munmap(res->content, res->content_length);
-        else
-            free(res->content);
-
-        res->content        = NULL;
-        res->content_length = 0;
-    }
-
-    if (res->resp_buf != NULL && res->is_resp_alloc == 1)
-    {
-        free(res->resp_buf);
-        res->resp_buf        = NULL;
-        res->resp_buf_offset = 0;
-        res->resp_buf_size   = 0;
-    }
+    /* Everything but the content file is released with the arena */
 
-    if (res->location != NULL)
+    if (res->content_fd != -1)
     {
-        free(res->location);
-        res->location = NULL;
+        close(res->content_fd);
     }
 
-    if (res->last_modified != NULL)
-    {
-        free(res->last_modified);
-        res->location = NULL;
-    }
+    res->content_fd     = -1;
+    res->content_offset = 0;
+    res->content        = NULL;
+    res->content_length = 0;
+    res->nsegments      = 0;
+    res->segment        = 0;
+    res->location       = NULL;
+    res->last_modified  = NULL;
 }
 
 const char *
@@ -138,8 +127,16 @@ rx_response_status_message(rx_http_status_t status_code)
         return RX_HTTP_STATUS_MSG_FOUND;
     case RX_HTTP_STATUS_CODE_METHOD_NOT_ALLOWED:
         return RX_HTTP_STATUS_MSG_METHOD_NOT_ALLOWED;
+    case RX_HTTP_STATUS_CODE_PAYLOAD_TOO_LARGE:
+        return RX_HTTP_STATUS_MSG_PAYLOAD_TOO_LARGE;
+    case RX_HTTP_STATUS_CODE_UNSUPPORTED_MEDIA_TYPE:
+        return RX_HTTP_STATUS_MSG_UNSUPPORTED_MEDIA_TYPE;
     case RX_HTTP_STATUS_CODE_INTERNAL_SERVER_ERROR:
         return RX_HTTP_STATUS_MSG_INTERNAL_SERVER_ERROR;
+    case RX_HTTP_STATUS_CODE_NOT_IMPLEMENTED:
+        return RX_HTTP_STATUS_MSG_NOT_IMPLEMENTED;
+    case RX_HTTP_STATUS_CODE_SERVICE_UNAVAILABLE:
+        return RX_HTTP_STATUS_MSG_SERVICE_UNAVAILABLE;
     default:
         return RX_HTTP_STATUS_CODE_UNSET;
     }
@@ -175,13 +172,17 @@ rx_response_render(struct rx_response *res, const char *path)
         goto end;
     }
 
-    buflen = asprintf(
-        &res->content, rx_view_engine.base_template.data, content, file.size
+    buflen = rx_arena_sprintf(
+        res->arena, &res->content, rx_view_engine.base_template.data, content,
+        file.size
     );
 
     if (buflen == -1)
     {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "asprintf: %s\n", strerror(errno));
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "rx_arena_sprintf: %s\n",
+            strerror(errno)
+        );
 
         res->content = NULL;
 
@@ -207,21 +208,18 @@ end:
 void
 rx_response_send(struct rx_response *res, const char *msg, size_t len)
 {
-    char *buf = malloc(len + 1);
+    char *buf = rx_arena_strndup(res->arena, msg, len);
 
     if (buf == NULL)
     {
         rx_log(
-            LOG_LEVEL_0, LOG_TYPE_ERROR, "%s malloc: %s\n", __func__,
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "%s rx_arena_strndup: %s\n", __func__,
             strerror(errno)
         );
 
         return;
     }
 
-    memcpy(buf, msg, len);
-    buf[len] = '\0';
-
     if (res->content_type == RX_HTTP_MIME_NONE)
         res->content_type = RX_HTTP_MIME_TEXT_PLAIN;
 
@@ -244,20 +242,18 @@ rx_response_redirect(struct rx_response *res, const char *location)
     res->status_message =
         (char *)rx_response_status_message(RX_HTTP_STATUS_CODE_FOUND);
 
-    res->location = malloc(strlen(location) + 1);
+    res->location = rx_arena_strndup(res->arena, location, strlen(location));
 
     if (res->location == NULL)
     {
         rx_log(
-            LOG_LEVEL_0, LOG_TYPE_ERROR, "%s malloc: %s\n", __func__,
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "%s rx_arena_strndup: %s\n", __func__,
             strerror(errno)
         );
 
         return;
     }
 
-    strcpy(res->location, location);
-
     /* Content, by default, is not set. If the caller wishes to add content to
        a redirect response, it should construct the body itself before calling
        this function.
@@ -267,6 +263,36 @@ rx_response_redirect(struct rx_response *res, const char *location)
         RX_HTTP_MIME_NONE ? RX_HTTP_MIME_TEXT_HTML : res->content_type;
 }
 
+/* Shedding happens when the server is short of time, so the response is
+   written out once and never formatted. It carries no date, which a fixed
+   buffer cannot keep current. */
+static const char rx_response_unavailable_buf[] =
+    "HTTP/1.1 503 Service Unavailable\r\n"
+    "Server: Reactor\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 20\r\n"
+    "Retry-After: " RX_RESPONSE_RETRY_AFTER "\r\n"
+    "Connection: close\r\n"
+    "\r\n"
+    "Service Unavailable\n";
+
+void
+rx_response_unavailable(struct rx_response *res)
+{
+    rx_response_destroy(res);
+
+    res->status_code    = RX_HTTP_STATUS_CODE_SERVICE_UNAVAILABLE;
+    res->status_message = (char *)rx_response_status_message(
+        RX_HTTP_STATUS_CODE_SERVICE_UNAVAILABLE
+    );
+    res->content_type   = RX_HTTP_MIME_TEXT_PLAIN;
+    res->keep_alive     = 0;
+
+    res->segments[0].iov_base = (void *)rx_response_unavailable_buf;
+    res->segments[0].iov_len  = sizeof(rx_response_unavailable_buf) - 1;
+    res->nsegments            = 1;
+}
+
 int
 rx_response_construct(struct rx_response *res)
 {
@@ -277,14 +303,14 @@ rx_response_construct(struct rx_response *res)
                               "Content-Type: %s\r\n"
                               "Content-Length: %zu\r\n"
                               "Date: %s\r\n"
-                              "Connection: close\r\n"
+                              "Connection: %s\r\n"
                               "%s" /* Additional headers */
                           "\r\n";
 
     pthread_t tid;
     time_t now;
     struct tm *tm;
-    char date_buf[128], extra_header_buf[2048], *buf, *full_buf;
+    char date_buf[128], extra_header_buf[2048], *buf;
     ssize_t buf_len, ehb_offset;
 
     memset(extra_header_buf, '\0', sizeof(extra_header_buf));
@@ -324,19 +350,28 @@ rx_response_construct(struct rx_response *res)
         );
     }
 
+    if (res->keep_alive)
+    {
+        ehb_offset += snprintf(
+            extra_header_buf + ehb_offset, 1024 - ehb_offset,
+            "Keep-Alive: timeout=%zu\r\n", rx_core_opts.keepalive_timeout
+        );
+    }
+
     extra_header_buf[ehb_offset] = '\0';
 
     // Build response headers
-    buf_len = asprintf(
-        &buf, headers, status_code, status_message, content_type,
-        content_length, date_buf, extra_header_buf
+    buf_len = rx_arena_sprintf(
+        res->arena, &buf, headers, status_code, status_message, content_type,
+        content_length, date_buf, res->keep_alive ? "keep-alive" : "close",
+        extra_header_buf
     );
 
     if (buf_len == -1)
     {
         rx_log(
             LOG_LEVEL_0, LOG_TYPE_ERROR,
-            "[Thread %ld]%4.sasprintf() failed to allocate "
+            "[Thread %ld]%4.srx_arena_sprintf() failed to allocate "
             "memory for response buffer",
             tid, ""
         );
@@ -344,40 +379,64 @@ rx_response_construct(struct rx_response *res)
         return RX_ERROR;
     }
 
-    // Build full response buffer
-    full_buf = malloc((size_t)buf_len + res->content_length + 1);
+    // The content is not copied behind the headers, it is sent from where
+    // the router left it, or from its file with sendfile(). HEAD responses
+    // announce a length without content.
 
-    if (full_buf == NULL)
-    {
-        rx_log(
-            LOG_LEVEL_0, LOG_TYPE_ERROR,
-            "[Thread %ld]%4.sfailed to allocate memory for "
-            "response buffer",
-            tid, ""
-        );
+    res->segments[0].iov_base = buf;
+    res->segments[0].iov_len  = (size_t)buf_len;
+    res->nsegments            = 1;
+    res->segment              = 0;
 
-        return RX_ERROR;
+    if (res->content_fd == -1 && res->content != NULL &&
+        res->content_length > 0)
+    {
+        res->segments[1].iov_base = res->content;
+        res->segments[1].iov_len  = res->content_length;
+        res->nsegments            = 2;
     }
 
-    // Copy headers and content into full buffer
-    memcpy(full_buf, buf, (size_t)buf_len);
+    return RX_OK;
+}
 
-    // Copy content into full buffer. The content should be available from
-    // router at this point.
+size_t
+rx_response_advance(struct rx_response *res, size_t nbytes)
+{
+    struct iovec *seg;
+    size_t used = 0, left;
 
-    if (res->content != NULL)
+    while (res->segment < res->nsegments && used < nbytes)
     {
-        memcpy(full_buf + buf_len, res->content, res->content_length);
-        full_buf[buf_len + res->content_length] = '\0';
-        buf_len += res->content_length;
+        seg = &res->segments[res->segment];
+
+        if (nbytes - used < seg->iov_len)
+        {
+            seg->iov_base  = (char *)seg->iov_base + (nbytes - used);
+            seg->iov_len  -= nbytes - used;
+
+            return nbytes;
+        }
+
+        used += seg->iov_len;
+        res->segment++;
     }
 
-    free(buf);
+    if (res->content_fd != -1 && res->segment == res->nsegments)
+    {
+        left = res->content_length - (size_t)res->content_offset;
+        left = left < nbytes - used ? left : nbytes - used;
+
+        res->content_offset += (off_t)left;
+        used                += left;
+    }
 
-    res->is_resp_alloc   = 1;
-    res->resp_buf        = full_buf;
-    res->resp_buf_offset = 0;
-    res->resp_buf_size   = (size_t)buf_len;
+    return used;
+}
 
-    return RX_OK;
+int
+rx_response_is_sent(const struct rx_response *res)
+{
+    return res->segment == res->nsegments &&
+           (res->content_fd == -1 ||
+            (size_t)res->content_offset == res->content_length);
 }
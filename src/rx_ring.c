@@ -24,45 +24,159 @@
 #include <rx_config.h>
 #include <rx_core.h>
 
-void
-rx_ring_init(struct rx_ring *ring)
+int
+rx_ring_init(struct rx_ring *ring, size_t capacity)
 {
-    ring->size = 0;
-    ring->cap  = 256;
-    ring->in   = 0;
-    ring->out  = 0;
+    size_t size = 2;
 
-    for (size_t i = 0; i < ring->cap; i++)
+    if (capacity > SIZE_MAX / 2 / sizeof(struct rx_ring_cell))
     {
-        ring->tasks[i] = NULL;
+        errno = ENOMEM;
+        return RX_ERROR;
     }
+
+    /* A single slot would read as filled to the producer of the next lap, so
+       a ring has at least two */
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    ring->cells = malloc(size * sizeof(struct rx_ring_cell));
+
+    if (ring->cells == NULL)
+    {
+        return RX_ERROR;
+    }
+
+    ring->mask = size - 1;
+
+    atomic_init(&ring->in, 0);
+    atomic_init(&ring->out, 0);
+
+    for (size_t i = 0; i < size; i++)
+    {
+        atomic_init(&ring->cells[i].seq, i);
+        ring->cells[i].task = NULL;
+    }
+
+    return RX_OK;
 }
 
 void
+rx_ring_destroy(struct rx_ring *ring)
+{
+    free(ring->cells);
+
+    ring->cells = NULL;
+    ring->mask  = 0;
+}
+
+size_t
+rx_ring_capacity(const struct rx_ring *ring)
+{
+    return ring->mask + 1;
+}
+
+int
 rx_ring_push(struct rx_ring *ring, struct rx_task *task)
 {
-    if (ring->size == ring->cap)
+    struct rx_ring_cell *cell;
+    size_t pos, seq;
+    intptr_t diff;
+
+    pos = atomic_load_explicit(&ring->in, memory_order_relaxed);
+
+    for (;;)
     {
-        return;
+        cell = &ring->cells[pos & ring->mask];
+        seq  = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0)
+        {
+            /* The slot is free, claim the position */
+            if (atomic_compare_exchange_weak_explicit(
+                    &ring->in, &pos, pos + 1, memory_order_relaxed,
+                    memory_order_relaxed
+                ))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            /* The slot still holds the task pushed one lap before */
+            return RX_AGAIN;
+        }
+        else
+        {
+            /* Another producer has claimed the position meanwhile */
+            pos = atomic_load_explicit(&ring->in, memory_order_relaxed);
+        }
     }
 
-    ring->tasks[ring->in] = task;
-    ring->in              = (ring->in + 1) % ring->cap;
-    ring->size++;
+    cell->task = task;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+
+    return RX_OK;
 }
 
 struct rx_task *
 rx_ring_pop(struct rx_ring *ring)
 {
-    if (ring->size == 0)
+    struct rx_ring_cell *cell;
+    struct rx_task *task;
+    size_t pos, seq;
+    intptr_t diff;
+
+    pos = atomic_load_explicit(&ring->out, memory_order_relaxed);
+
+    for (;;)
     {
-        return NULL;
+        cell = &ring->cells[pos & ring->mask];
+        seq  = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0)
+        {
+            /* The slot has been filled, claim the position */
+            if (atomic_compare_exchange_weak_explicit(
+                    &ring->out, &pos, pos + 1, memory_order_relaxed,
+                    memory_order_relaxed
+                ))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            /* Nothing has been pushed to the slot yet */
+            return NULL;
+        }
+        else
+        {
+            /* Another consumer has claimed the position meanwhile */
+            pos = atomic_load_explicit(&ring->out, memory_order_relaxed);
+        }
     }
 
-    struct rx_task *task   = ring->tasks[ring->out];
-    ring->tasks[ring->out] = NULL;
-    ring->out              = (ring->out + 1) % ring->cap;
-    ring->size--;
+    task       = cell->task;
+    cell->task = NULL;
+
+    /* Hand the slot over to the producers of the next lap */
+    atomic_store_explicit(
+        &cell->seq, pos + ring->mask + 1, memory_order_release
+    );
 
     return task;
 }
+
+size_t
+rx_ring_size(struct rx_ring *ring)
+{
+    size_t in  = atomic_load_explicit(&ring->in, memory_order_acquire);
+    size_t out = atomic_load_explicit(&ring->out, memory_order_acquire);
+
+    return in > out ? in - out : 0;
+}
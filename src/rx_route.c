@@ -29,6 +29,7 @@ const struct rx_route router_table[] = {
 {
     .endpoint = "/",
     .resource = "pages/index.html",
+    .workload = RX_WORKLOAD_PAGES,
     .handler  = {
         .get    = rx_route_index_get,
         .post   = NULL,
@@ -41,6 +42,7 @@ const struct rx_route router_table[] = {
 {
     .endpoint = "/login",
     .resource = "pages/login.html",
+    .workload = RX_WORKLOAD_AUTH,
     .handler  = {
         .get    = rx_route_login_get,
         .post   = rx_route_login_post,
@@ -54,6 +56,7 @@ const struct rx_route router_table[] = {
 {
     .endpoint = "/about",
     .resource = "pages/about.html",
+    .workload = RX_WORKLOAD_PAGES,
     .handler  = {
         .get    = rx_route_about_get,
         .post   = NULL,
@@ -62,9 +65,39 @@ const struct rx_route router_table[] = {
         .head   = NULL
     }
 },
+{
+    .endpoint = "/upload",
+    .resource = NULL,
+    .workload = RX_WORKLOAD_LOOP,
+    .demo     = 1,
+    .body     = rx_route_upload_body,
+    .handler  = {
+        .get    = NULL,
+        .post   = rx_route_upload_post,
+        .put    = NULL,
+        .patch  = NULL,
+        .delete = NULL,
+        .head   = NULL
+    }
+},
+{
+    .endpoint = "/stats",
+    .resource = NULL,
+    .workload = RX_WORKLOAD_LOOP,
+    .demo     = 1,
+    .handler  = {
+        .get    = rx_route_stats_get,
+        .post   = NULL,
+        .put    = NULL,
+        .patch  = NULL,
+        .delete = NULL,
+        .head   = NULL
+    }
+},
 {
     .endpoint = NULL,
     .resource = NULL,
+    .workload = RX_WORKLOAD_LOOP,
     .handler  = {
         .get    = NULL,
         .post   = NULL,
@@ -86,11 +119,19 @@ rx_route_get(struct rx_route *storage, const char *endpoint, size_t ep_len)
 
     for (i = 0; router_table[i].endpoint != NULL; i++)
     {
+        if (router_table[i].demo && !rx_core_opts.demo_routes)
+        {
+            continue;
+        }
+
         if (strncasecmp(router_table[i].endpoint, endpoint, ep_len) == 0)
         {
             storage->endpoint = router_table[i].endpoint;
             storage->resource = router_table[i].resource;
             storage->handler  = router_table[i].handler;
+            storage->workload = router_table[i].workload;
+            storage->body     = router_table[i].body;
+            storage->demo     = router_table[i].demo;
 
             return RX_OK;
         }
@@ -100,6 +141,9 @@ rx_route_get(struct rx_route *storage, const char *endpoint, size_t ep_len)
     {
         storage->endpoint = "/public/";
         storage->resource = endpoint;
+        storage->workload = RX_WORKLOAD_LOOP;
+        storage->body     = NULL;
+        storage->demo     = 0;
 
         memset(&storage->handler, 0, sizeof(struct rx_router_handler));
 
@@ -116,6 +160,65 @@ rx_route_get(struct rx_route *storage, const char *endpoint, size_t ep_len)
     return RX_ERROR;
 }
 
+rx_workload_t
+rx_route_workload(
+    rx_request_method_t method, const char *endpoint, size_t ep_len
+)
+{
+    struct rx_route route;
+    void *(*handler)(struct rx_request *, struct rx_response *);
+
+    if (rx_route_get(&route, endpoint, ep_len) != RX_OK)
+    {
+        return RX_WORKLOAD_LOOP;
+    }
+
+    switch (method)
+    {
+    case RX_REQUEST_METHOD_GET:
+        handler = route.handler.get;
+        break;
+    case RX_REQUEST_METHOD_POST:
+        handler = route.handler.post;
+        break;
+    case RX_REQUEST_METHOD_PUT:
+        handler = route.handler.put;
+        break;
+    case RX_REQUEST_METHOD_DELETE:
+        handler = route.handler.delete;
+        break;
+    case RX_REQUEST_METHOD_HEAD:
+        handler = route.handler.head;
+        break;
+    default:
+        handler = NULL;
+        break;
+    }
+
+    return handler != NULL ? route.workload : RX_WORKLOAD_LOOP;
+}
+
+rx_body_sink_t
+rx_route_body(rx_request_method_t method, const char *endpoint, size_t ep_len)
+{
+    struct rx_route route;
+
+    if (rx_route_get(&route, endpoint, ep_len) != RX_OK)
+    {
+        return NULL;
+    }
+
+    switch (method)
+    {
+    case RX_REQUEST_METHOD_POST:
+        return route.handler.post != NULL ? route.body : NULL;
+    case RX_REQUEST_METHOD_PUT:
+        return route.handler.put != NULL ? route.body : NULL;
+    default:
+        return NULL;
+    }
+}
+
 void *
 rx_route_index_get(struct rx_request *req, struct rx_response *res)
 {
@@ -156,17 +259,87 @@ rx_route_about_get(struct rx_request *req, struct rx_response *res)
     return NULL;
 }
 
+void *
+rx_route_upload_post(struct rx_request *req, struct rx_response *res)
+{
+    char buf[64];
+    int len;
+
+    len = snprintf(
+        buf, sizeof(buf), "Received %zu bytes\n", req->content_length
+    );
+
+    rx_response_send(res, buf, len);
+
+    return NULL;
+}
+
+int
+rx_route_upload_body(struct rx_request *req, const char *data, size_t len)
+{
+    NOOP(req);
+    NOOP(data);
+    NOOP(len);
+
+    return RX_OK;
+}
+
+void *
+rx_route_stats_get(struct rx_request *req, struct rx_response *res)
+{
+    struct rx_thread_pool_stats stats;
+    struct rx_thread_pool *pool;
+    char buf[RX_WORKLOAD_MAX * 256];
+    size_t len = 0;
+    int i;
+
+    NOOP(req);
+
+    for (i = 0; i < RX_WORKLOAD_MAX; i++)
+    {
+        pool = &rx_tp[i];
+
+        if (pool->workers == NULL)
+        {
+            continue;
+        }
+
+        rx_thread_pool_stats(pool, &stats);
+
+        /* Averages over every task since the start, in microseconds */
+        len += snprintf(
+            buf + len, sizeof(buf) - len,
+            "%s threads=%zu depth=%zu priority=%d queued=%zu tasks=%" PRIu64
+            " shed=%" PRIu64 " wait_avg_us=%" PRIu64 " wait_max_us=%" PRIu64
+            " service_avg_us=%" PRIu64 "\n",
+            pool->name, pool->nthreads,
+            rx_ring_capacity(&pool->workers[0]->ring), pool->priority,
+            stats.queued, stats.ntasks, stats.nshed,
+            stats.ntasks ? stats.wait / stats.ntasks / 1000 : 0,
+            stats.wait_max / 1000,
+            stats.ntasks ? stats.service / stats.ntasks / 1000 : 0
+        );
+    }
+
+    rx_response_send(res, buf, len);
+
+    return NULL;
+}
+
 void *
 rx_route_static_get(struct rx_request *req, struct rx_response *res)
 {
-    const size_t resource_len = req->uri.path_end - req->uri.path - 1;
+    const size_t resource_len = req->uri.path.len - 1;
 
     int ret;
     struct rx_file file;
-    char resource[resource_len], *buf;
+    char resource[resource_len + 1];
+
+    /* The path is a view into the request buffer, but opening the file needs
+       a NUL-terminated name */
 
     memset(&file, 0, sizeof(file));
-    memcpy(resource, req->uri.path + 1, req->uri.path_end - req->uri.path);
+    memcpy(resource, req->uri.path.data + 1, resource_len);
     resource[resource_len] = '\0';
 
     rx_log(
@@ -176,58 +349,70 @@ rx_route_static_get(struct rx_request *req, struct rx_response *res)
 
     ret = rx_file_open(&file, resource, O_RDONLY);
 
-    if (ret == RX_FATAL_WITH_ERROR)
+    /* A directory opens like a file, but has no content to send */
+
+    if (ret == RX_OK && !S_ISREG(file.mode))
     {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "Failed to open file\n");
-        return RX_ERROR_PTR;
+        rx_file_close(&file);
+        ret = RX_ERROR;
     }
 
-    buf = (char *)mmap(NULL, file.size, PROT_READ, MAP_PRIVATE, file.fd, 0);
-
-    if (buf == MAP_FAILED)
+    if (ret != RX_OK)
     {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "mmap: %s\n", strerror(errno));
-        return RX_ERROR_PTR;
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_INFO,
+            "[Thread %ld]%4.sNo file to serve: %s\n", pthread_self(), "",
+            resource
+        );
+
+        rx_route_4xx(req, res, RX_HTTP_STATUS_CODE_NOT_FOUND);
+
+        return RX_OK_PTR;
     }
 
-    res->last_modified = malloc(sizeof(struct timespec));
+    res->last_modified = rx_arena_alloc(res->arena, sizeof(struct timespec));
 
     if (res->last_modified == NULL)
     {
         rx_log(
-            LOG_LEVEL_0, LOG_TYPE_ERROR, "(%s) malloc: %s\n", __func__,
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "(%s) rx_arena_alloc: %s\n", __func__,
             strerror(errno)
         );
 
+        rx_file_close(&file);
         return RX_ERROR_PTR;
     }
 
     memcpy(res->last_modified, &file.mod, sizeof(struct timespec));
 
-    res->is_content_mmapd = 1;
-    res->content          = buf;
-    res->content_length   = file.size;
-    res->content_type     = file.mime;
-    res->status_code      = RX_HTTP_STATUS_CODE_OK;
+    /* The file is not read here: the event loop sends it straight from the
+       descriptor, which the response now owns */
+
+    res->content_fd     = file.fd;
+    res->content_offset = 0;
+    res->content_length = file.size;
+    res->content_type   = file.mime;
+    res->status_code    = RX_HTTP_STATUS_CODE_OK;
     res->status_message =
         (char *)rx_response_status_message(RX_HTTP_STATUS_CODE_OK);
 
-    rx_file_close(&file);
-
     return RX_OK_PTR;
 }
 
 void *
 rx_route_static_head(struct rx_request *req, struct rx_response *res)
 {
-    const size_t resource_len = req->uri.path_end - req->uri.path - 1;
+    const size_t resource_len = req->uri.path.len - 1;
 
     int ret;
     struct rx_file file;
-    char resource[resource_len], *buf;
+    char resource[resource_len + 1];
+
+    /* The path is a view into the request buffer, but opening the file needs
+       a NUL-terminated name */
 
     memset(&file, 0, sizeof(file));
-    memcpy(resource, req->uri.path + 1, req->uri.path_end - req->uri.path);
+    memcpy(resource, req->uri.path.data + 1, resource_len);
     resource[resource_len] = '\0';
 
     rx_log(
@@ -237,25 +422,33 @@ rx_route_static_head(struct rx_request *req, struct rx_response *res)
 
     ret = rx_file_open(&file, resource, O_RDONLY);
 
-    if (ret == RX_FATAL_WITH_ERROR)
+    /* A directory opens like a file, but has no content to send */
+
+    if (ret == RX_OK && !S_ISREG(file.mode))
     {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "Failed to open file\n");
-        return RX_ERROR_PTR;
+        rx_file_close(&file);
+        ret = RX_ERROR;
     }
 
-    buf = (char *)mmap(NULL, file.size, PROT_READ, MAP_PRIVATE, file.fd, 0);
-
-    if (buf == MAP_FAILED)
+    if (ret != RX_OK)
     {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "mmap: %s\n", strerror(errno));
-        return RX_ERROR_PTR;
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_INFO,
+            "[Thread %ld]%4.sNo file to serve: %s\n", pthread_self(), "",
+            resource
+        );
+
+        rx_route_4xx(req, res, RX_HTTP_STATUS_CODE_NOT_FOUND);
+
+        return RX_OK_PTR;
     }
 
-    res->is_content_mmapd = 0;
-    res->content          = NULL;
-    res->content_length   = file.size;
-    res->content_type     = file.mime;
-    res->status_code      = RX_HTTP_STATUS_CODE_OK;
+    /* Only the size of the file is announced, its content is not needed */
+
+    res->content        = NULL;
+    res->content_length = file.size;
+    res->content_type   = file.mime;
+    res->status_code    = RX_HTTP_STATUS_CODE_OK;
     res->status_message =
         (char *)rx_response_status_message(RX_HTTP_STATUS_CODE_OK);
 
@@ -287,14 +480,15 @@ rx_route_static_head(struct rx_request *req, struct rx_response *res)
             );
         }
 
-        res->is_content_mmapd = 0;
-        res->last_modified    = malloc(sizeof(struct timespec));
+        res->last_modified = rx_arena_alloc(
+            res->arena, sizeof(struct timespec)
+        );
 
         if (res->last_modified == NULL)
         {
             rx_log(
-                LOG_LEVEL_0, LOG_TYPE_ERROR, "(%s) malloc: %s\n", __func__,
-                strerror(errno)
+                LOG_LEVEL_0, LOG_TYPE_ERROR, "(%s) rx_arena_alloc: %s\n",
+                __func__, strerror(errno)
             );
 
             goto end;
@@ -326,8 +520,8 @@ rx_route_4xx(struct rx_request *req, struct rx_response *res, int code)
     case RX_HTTP_STATUS_CODE_NOT_FOUND:
         sprintf(msg, "Not Found");
         sprintf(
-            reason, "The requested resource (%s) could not be found.",
-            req->uri.raw_uri
+            reason, "The requested resource (%.*s) could not be found.",
+            (int)req->uri.raw.len, req->uri.raw.data
         );
 
         break;
@@ -336,9 +530,10 @@ rx_route_4xx(struct rx_request *req, struct rx_response *res, int code)
         sprintf(msg, "Method Not Allowed");
         sprintf(
             reason,
-            "The requested resource (%s) does not support the "
+            "The requested resource (%.*s) does not support the "
             "method %s.",
-            req->uri.raw_uri, rx_request_method_str(req->method)
+            (int)req->uri.raw.len, req->uri.raw.data,
+            rx_request_method_str(req->method)
         );
 
         break;
@@ -352,6 +547,24 @@ rx_route_4xx(struct rx_request *req, struct rx_response *res, int code)
 
         break;
 
+    case RX_HTTP_STATUS_CODE_PAYLOAD_TOO_LARGE:
+        sprintf(msg, "Payload Too Large");
+        sprintf(
+            reason, "The body of the request is larger than the server is "
+                    "willing to process."
+        );
+
+        break;
+
+    case RX_HTTP_STATUS_CODE_NOT_IMPLEMENTED:
+        sprintf(msg, "Not Implemented");
+        sprintf(
+            reason, "The server does not support the transfer coding of the "
+                    "request."
+        );
+
+        break;
+
     case RX_HTTP_STATUS_CODE_BAD_REQUEST:
     default:
         sprintf(msg, "Bad Request");
@@ -362,21 +575,30 @@ rx_route_4xx(struct rx_request *req, struct rx_response *res, int code)
         break;
     }
 
-    buflen = asprintf(
-        &buf, rx_view_engine.client_error_template.data, code, msg, reason
+    buflen = rx_arena_sprintf(
+        res->arena, &buf, rx_view_engine.client_error_template.data, code, msg,
+        reason
     );
 
     if (buflen == RX_ERROR)
     {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "asprintf: %s\n", strerror(errno));
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "rx_arena_sprintf: %s\n",
+            strerror(errno)
+        );
         return RX_ERROR_PTR;
     }
 
-    buflen = asprintf(&res->content, rx_view_engine.base_template.data, buf);
+    buflen = rx_arena_sprintf(
+        res->arena, &res->content, rx_view_engine.base_template.data, buf
+    );
 
     if (buflen == RX_ERROR)
     {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "asprintf: %s\n", strerror(errno));
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "rx_arena_sprintf: %s\n",
+            strerror(errno)
+        );
         return RX_ERROR_PTR;
     }
 
@@ -385,7 +607,5 @@ rx_route_4xx(struct rx_request *req, struct rx_response *res, int code)
     res->status_code    = code;
     res->status_message = (char *)rx_response_status_message(code);
 
-    free(buf);
-
     return NULL;
 }
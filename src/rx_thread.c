@@ -24,167 +24,500 @@
 #include <rx_config.h>
 #include <rx_core.h>
 
-void *
-rx_thread_pool_worker(void *arg)
+/* Next worker that tasks submitted by this thread go to */
+static _Thread_local size_t rx_thread_pool_cursor;
+
+static void
+rx_thread_pool_park(struct rx_thread_pool *pool, uint32_t wakeups)
 {
-    struct rx_thread_pool *pool = arg;
-    pthread_t tid               = pthread_self();
+    /* The wait returns at once when a wakeup has happened since `wakeups` was
+       read, so a task pushed in between is not missed */
+    (void)syscall(
+        SYS_futex, &pool->wakeups, FUTEX_WAIT_PRIVATE, wakeups, NULL, NULL, 0
+    );
+}
 
-    for (;;)
+static void
+rx_thread_pool_wake(struct rx_thread_pool *pool, int nworkers)
+{
+    atomic_fetch_add_explicit(&pool->wakeups, 1, memory_order_release);
+
+    (void)syscall(
+        SYS_futex, &pool->wakeups, FUTEX_WAKE_PRIVATE, nworkers, NULL, NULL, 0
+    );
+}
+
+static int
+rx_thread_pool_stopping(struct rx_thread_pool *pool)
+{
+    return atomic_load(&pool->state) == RX_THREAD_POOL_STATE_STOPPING;
+}
+
+/* Pop a task from the ring of `worker`, or steal one from another worker */
+static struct rx_task *
+rx_thread_pool_find(struct rx_thread_worker *worker)
+{
+    struct rx_thread_pool *pool = worker->pool;
+    struct rx_task *task;
+    size_t i, victim;
+
+    if ((task = rx_ring_pop(&worker->ring)) != NULL)
     {
-        sem_wait(&pool->full);
-        pthread_mutex_lock(&pool->lock);
+        return task;
+    }
 
-        struct rx_task *task = rx_ring_pop(pool->ring);
+    /* Start with the next worker, so thieves spread over the victims
+       rather than all falling on the first one */
 
-        pthread_mutex_unlock(&pool->lock);
-        sem_post(&pool->empty);
+    for (i = 1; i < pool->nthreads; i++)
+    {
+        victim = (worker->id + i) % pool->nthreads;
 
-        if (task == NULL)
+        if ((task = rx_ring_pop(&pool->workers[victim]->ring)) != NULL)
         {
-            continue;
+            return task;
         }
+    }
 
-        task->handle(task->arg);
+    return NULL;
+}
 
-        struct epoll_event event;
-        struct rx_connection *conn = task->arg;
-        int ret;
+/* Take the next task, waiting for one if necessary
 
-        conn->state = conn->state == RX_CONNECTION_STATE_CLOSING
-                          ? RX_CONNECTION_STATE_CLOSING
-                          : RX_CONNECTION_STATE_WRITING_RESPONSE;
+   Returns `NULL` when the pool is being destroyed.
+ */
+static struct rx_task *
+rx_thread_pool_take(struct rx_thread_worker *worker)
+{
+    struct rx_thread_pool *pool = worker->pool;
+    struct rx_task *task;
+    uint32_t wakeups;
+    size_t i;
 
-        if (conn->state == RX_CONNECTION_STATE_CLOSING)
+    for (;;)
+    {
+        /* Every round polls all the rings, so larger pools take fewer
+           rounds before parking */
+        for (i = 0; i < RX_THREAD_POOL_SPIN; i += pool->nthreads)
         {
-            event.events = EPOLLERR | EPOLLRDHUP | EPOLLET;
+            if ((task = rx_thread_pool_find(worker)) != NULL)
+            {
+                return task;
+            }
         }
-        else
+
+        /* Announce the worker as parked before checking the rings one last
+           time, so a producer that pushes after the check sees it and
+           wakes it up */
+
+        wakeups = atomic_load_explicit(&pool->wakeups, memory_order_acquire);
+        atomic_fetch_add(&pool->nparked, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        task = rx_thread_pool_find(worker);
+
+        if (task == NULL && !rx_thread_pool_stopping(pool))
         {
-            event.events = EPOLLOUT | EPOLLET;
+            rx_thread_pool_park(pool, wakeups);
         }
 
-        event.data.ptr = conn;
+        atomic_fetch_sub(&pool->nparked, 1);
+
+        if (task != NULL || rx_thread_pool_stopping(pool))
+        {
+            return task;
+        }
+    }
+}
+
+/* Allocate the worker of the calling thread and wait for the others
 
-        ret = epoll_ctl(conn->efd, EPOLL_CTL_MOD, conn->fd, &event);
+   Memory is placed on the NUMA node of the thread that first writes it, so
+   the worker sets up its own ring rather than getting one from the thread
+   that starts the pool. Returns `NULL` if the pool does not start.
+ */
+static struct rx_thread_worker *
+rx_thread_pool_setup(struct rx_thread_pool *pool)
+{
+    struct rx_thread_worker *worker;
+    size_t id = atomic_fetch_add(&pool->nstarted, 1);
+
+    worker = aligned_alloc(
+        _Alignof(struct rx_thread_worker), sizeof(struct rx_thread_worker)
+    );
+
+    if (worker != NULL && rx_ring_init(&worker->ring, pool->depth) != RX_OK)
+    {
+        free(worker);
+        worker = NULL;
+    }
+
+    if (worker != NULL)
+    {
+        worker->pool = pool;
+        worker->id   = id;
+        worker->cpu  = pool->affinity ? sched_getcpu() : -1;
+
+        memset(&worker->stats, 0, sizeof(worker->stats));
+    }
 
-        if (ret == -1)
+    /* On Linux the nice value belongs to the thread. Raising the priority
+       needs privileges, which the server is not expected to have. */
+
+    if (pool->priority != 0 &&
+        setpriority(
+            PRIO_PROCESS, (id_t)syscall(SYS_gettid), pool->priority
+        ) == -1)
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_WARN,
+            "[Worker %zu]%4.sCannot run %s at priority %d: %s\n", id, "",
+            pool->name, pool->priority, strerror(errno)
+        );
+    }
+
+    pool->workers[id] = worker;
+    atomic_fetch_add_explicit(&pool->nready, 1, memory_order_release);
+
+    /* No worker may steal before every ring exists */
+    while (atomic_load(&pool->state) == RX_THREAD_POOL_STATE_STARTING)
+    {
+        sched_yield();
+    }
+
+    return rx_thread_pool_stopping(pool) ? NULL : worker;
+}
+
+static uint64_t
+rx_thread_pool_read(_Atomic uint64_t *counter)
+{
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+/* Add `value` to a counter that only the calling worker writes */
+static void
+rx_thread_pool_add(_Atomic uint64_t *counter, uint64_t value)
+{
+    atomic_store_explicit(
+        counter, rx_thread_pool_read(counter) + value, memory_order_relaxed
+    );
+}
+
+/* Count a task that waited `wait` and ran for `service` */
+static void
+rx_thread_pool_account(
+    struct rx_thread_worker *worker, uint64_t wait, uint64_t service, int shed
+)
+{
+    struct rx_thread_worker_stats *stats = &worker->stats;
+
+    rx_thread_pool_add(&stats->ntasks, 1);
+    rx_thread_pool_add(&stats->nshed, shed);
+    rx_thread_pool_add(&stats->wait, wait);
+    rx_thread_pool_add(&stats->service, service);
+
+    if (wait > rx_thread_pool_read(&stats->wait_max))
+    {
+        atomic_store_explicit(&stats->wait_max, wait, memory_order_relaxed);
+    }
+}
+
+void *
+rx_thread_pool_worker(void *arg)
+{
+    struct rx_thread_worker *worker;
+    struct rx_task *task;
+    uint64_t start, wait;
+    void *ret;
+    int shed;
+
+    if ((worker = rx_thread_pool_setup(arg)) == NULL)
+    {
+        return RX_ERROR_PTR;
+    }
+
+    rx_log(
+        LOG_LEVEL_0, LOG_TYPE_DEBUG, "[Worker %zu]%4.sStarted on CPU %d\n",
+        worker->id, "", worker->cpu
+    );
+
+    while ((task = rx_thread_pool_take(worker)) != NULL)
+    {
+        start = rx_codel_now();
+        wait  = start - task->enqueued;
+        shed  = task->shed != NULL &&
+               rx_codel_shed(&worker->pool->codel, start, wait);
+
+        /* The task belongs to its submitter again once handled */
+        ret = shed ? task->shed(task->arg) : task->handle(task->arg);
+
+        rx_thread_pool_account(worker, wait, rx_codel_now() - start, shed);
+
+        /* A failure only concerns the connection of the task, which its
+           handler has answered or given up on. The worker goes on with the
+           next task, or the pool would run out of workers. */
+
+        if (ret == RX_ERROR_PTR)
         {
             rx_log(
-                LOG_LEVEL_0, LOG_TYPE_ERROR, "epoll_ctl: %s\n", strerror(errno)
+                LOG_LEVEL_0, LOG_TYPE_WARN, "[Worker %zu]%4.sTask failed\n",
+                worker->id, ""
             );
-            return RX_ERROR_PTR;
+
+            continue;
         }
 
         rx_log(
-            LOG_LEVEL_0, LOG_TYPE_INFO,
-            "[Thread %ld]%4.sSubmit finished task to event poll\n", tid, ""
+            LOG_LEVEL_0, LOG_TYPE_DEBUG,
+            "[Worker %zu]%4.sFinished task\n", worker->id, ""
         );
+    }
 
-        free(task);
+    return RX_OK_PTR;
+}
+
+/* Stop the first `nthreads` threads of `pool`, which are the ones running,
+   and release the workers */
+static void
+rx_thread_pool_stop(struct rx_thread_pool *pool, size_t nthreads)
+{
+    size_t i;
+
+    atomic_store(&pool->state, RX_THREAD_POOL_STATE_STOPPING);
+    rx_thread_pool_wake(pool, INT_MAX);
+
+    for (i = 0; i < nthreads; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
     }
+
+    for (i = 0; i < pool->nthreads; i++)
+    {
+        if (pool->workers[i] != NULL)
+        {
+            rx_ring_destroy(&pool->workers[i]->ring);
+            free(pool->workers[i]);
+        }
+    }
+
+    free(pool->workers);
+    free(pool->threads);
+
+    pool->workers  = NULL;
+    pool->threads  = NULL;
+    pool->nthreads = 0;
 }
 
-int
-rx_thread_pool_init(struct rx_thread_pool *pool, struct rx_ring *ring)
+/* Pin the `n`-th thread of `attr` to the `n`-th CPU the process may use,
+   wrapping around when there are more threads than CPUs */
+static int
+rx_thread_pool_pin(pthread_attr_t *attr, const cpu_set_t *allowed, size_t n)
 {
-    int ret;
+    cpu_set_t cpus;
+    int cpu;
+
+    n %= CPU_COUNT(allowed);
+
+    for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (CPU_ISSET(cpu, allowed) && n-- == 0)
+        {
+            break;
+        }
+    }
 
-    pool->nthreads = 8;
-    pool->ring     = ring;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
 
-    ret = pthread_mutex_init(&pool->lock, NULL);
+    return pthread_attr_setaffinity_np(attr, sizeof(cpus), &cpus);
+}
 
-    if (ret == -1)
+int
+rx_thread_pool_init(
+    struct rx_thread_pool *pool, const struct rx_thread_pool_config *config
+)
+{
+    const size_t nthreads = config->nthreads;
+    const int affinity    = config->affinity;
+    pthread_attr_t attr;
+    cpu_set_t allowed;
+    size_t i;
+    int ret = 0;
+
+    if (nthreads == 0)
     {
-        rx_log(
-            LOG_LEVEL_0, LOG_TYPE_ERROR, "pthread_mutex_init: %s\n",
-            strerror(errno)
-        );
+        errno = EINVAL;
         return RX_ERROR;
     }
 
-    ret = sem_init(&pool->empty, 0, 0);
-
-    if (ret == -1)
+    if (affinity && sched_getaffinity(0, sizeof(allowed), &allowed) == -1)
     {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "sem_init: %s\n", strerror(errno));
         return RX_ERROR;
     }
 
-    ret = sem_init(&pool->full, 0, 256);
+    pool->workers = calloc(nthreads, sizeof(struct rx_thread_worker *));
+    pool->threads = calloc(nthreads, sizeof(pthread_t));
 
-    if (ret == -1)
+    if (pool->workers == NULL || pool->threads == NULL)
     {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "sem_init: %s\n", strerror(errno));
+        free(pool->workers);
+        free(pool->threads);
         return RX_ERROR;
     }
 
-    for (size_t i = 0; i < 8; i++)
+    pool->name     = config->name;
+    pool->nthreads = nthreads;
+    pool->depth    = config->depth;
+    pool->priority = config->priority;
+    pool->affinity = affinity;
+
+    atomic_init(&pool->wakeups, 0);
+    atomic_init(&pool->nparked, 0);
+    atomic_init(&pool->nstarted, 0);
+    atomic_init(&pool->nready, 0);
+    atomic_init(&pool->state, RX_THREAD_POOL_STATE_STARTING);
+
+    rx_codel_init(&pool->codel, config->target, RX_CODEL_DEFAULT_INTERVAL);
+
+    for (i = 0; i < nthreads; i++)
     {
-        ret = pthread_create(
-            &pool->threads[i], NULL, rx_thread_pool_worker, pool
-        );
+        if ((ret = pthread_attr_init(&attr)) != 0)
+        {
+            break;
+        }
+
+        if (affinity)
+        {
+            ret = rx_thread_pool_pin(&attr, &allowed, i);
+        }
+
+        if (ret == 0)
+        {
+            ret = pthread_create(
+                &pool->threads[i], &attr, rx_thread_pool_worker, pool
+            );
+        }
+
+        pthread_attr_destroy(&attr);
 
         if (ret != 0)
+        {
+            break;
+        }
+    }
+
+    if (ret != 0)
+    {
+        rx_log(
+            LOG_LEVEL_0, LOG_TYPE_ERROR, "pthread_create: %s\n", strerror(ret)
+        );
+
+        rx_thread_pool_stop(pool, i);
+        return RX_ERROR;
+    }
+
+    while (atomic_load_explicit(&pool->nready, memory_order_acquire) <
+           nthreads)
+    {
+        sched_yield();
+    }
+
+    for (i = 0; i < nthreads; i++)
+    {
+        if (pool->workers[i] == NULL)
         {
             rx_log(
-                LOG_LEVEL_0, LOG_TYPE_ERROR, "pthread_create: %s\n",
-                strerror(errno)
+                LOG_LEVEL_0, LOG_TYPE_ERROR, "Failed to set up worker %zu\n",
+                i
             );
-            pool->nthreads--;
+
+            rx_thread_pool_stop(pool, nthreads);
+
+            /* The worker could only have run out of memory, and its errno
+               is not this thread's */
+            errno = ENOMEM;
+            return RX_ERROR;
         }
     }
 
+    atomic_store(&pool->state, RX_THREAD_POOL_STATE_RUNNING);
+
     return RX_OK;
 }
 
 int
 rx_thread_pool_submit(struct rx_thread_pool *pool, struct rx_task *task)
 {
-    int ret;
+    size_t i, id;
 
-    ret = sem_wait(&pool->empty);
+    /* Stamped before the push, since a worker may take the task right away */
+    task->enqueued = rx_codel_now();
 
-    if (ret == -1)
+    for (i = 0; i < pool->nthreads; i++)
     {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "sem_wait: %s\n", strerror(errno));
-        return RX_ERROR;
-    }
+        id = rx_thread_pool_cursor++ % pool->nthreads;
 
-    ret = pthread_mutex_lock(&pool->lock);
+        if (rx_ring_push(&pool->workers[id]->ring, task) == RX_OK)
+        {
+            break;
+        }
+    }
 
-    if (ret == -1)
+    if (i == pool->nthreads)
     {
-        rx_log(
-            LOG_LEVEL_0, LOG_TYPE_ERROR, "pthread_mutex_lock: %s\n",
-            strerror(errno)
-        );
-        return RX_ERROR;
+        return RX_AGAIN;
     }
 
-    rx_ring_push(pool->ring, task);
+    /* Pairs with the announcement of a parking worker: either the worker
+       sees the task, or this thread sees the worker. Any parked worker will
+       do, since it steals the task if it is not its own. */
 
-    ret = pthread_mutex_unlock(&pool->lock);
+    atomic_thread_fence(memory_order_seq_cst);
 
-    if (ret == -1)
+    if (atomic_load_explicit(&pool->nparked, memory_order_relaxed) > 0)
     {
-        rx_log(
-            LOG_LEVEL_0, LOG_TYPE_ERROR, "pthread_mutex_unlock: %s\n",
-            strerror(errno)
-        );
-        return RX_ERROR;
+        rx_thread_pool_wake(pool, 1);
     }
 
-    ret = sem_post(&pool->full);
+    rx_log(
+        LOG_LEVEL_0, LOG_TYPE_DEBUG, "Submit task to worker %zu\n", id
+    );
+
+    return RX_OK;
+}
+
+void
+rx_thread_pool_stats(
+    struct rx_thread_pool *pool, struct rx_thread_pool_stats *stats
+)
+{
+    struct rx_thread_worker_stats *ws;
+    uint64_t wait_max;
+    size_t i;
+
+    memset(stats, 0, sizeof(*stats));
 
-    if (ret == -1)
+    for (i = 0; i < pool->nthreads; i++)
     {
-        rx_log(LOG_LEVEL_0, LOG_TYPE_ERROR, "sem_post: %s\n", strerror(errno));
-        return RX_ERROR;
-    }
+        ws = &pool->workers[i]->stats;
 
-    rx_log(LOG_LEVEL_0, LOG_TYPE_DEBUG, "Submit task to thread pool\n");
+        stats->queued  += rx_ring_size(&pool->workers[i]->ring);
+        stats->ntasks  += rx_thread_pool_read(&ws->ntasks);
+        stats->nshed   += rx_thread_pool_read(&ws->nshed);
+        stats->wait    += rx_thread_pool_read(&ws->wait);
+        stats->service += rx_thread_pool_read(&ws->service);
 
-    return RX_OK;
+        wait_max = rx_thread_pool_read(&ws->wait_max);
+
+        if (wait_max > stats->wait_max)
+        {
+            stats->wait_max = wait_max;
+        }
+    }
+}
+
+void
+rx_thread_pool_destroy(struct rx_thread_pool *pool)
+{
+    rx_thread_pool_stop(pool, pool->nthreads);
 }
@@ -0,0 +1,270 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static void
+rx_timer_link(struct rx_timer *head, struct rx_timer *timer)
+{
+    timer->prev      = head->prev;
+    timer->next      = head;
+    head->prev->next = timer;
+    head->prev       = timer;
+}
+
+static void
+rx_timer_unlink(struct rx_timer *timer)
+{
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->prev       = NULL;
+    timer->next       = NULL;
+}
+
+/* Put a timer into the slot that covers its deadline
+
+   The level is chosen by the distance to the deadline, and the slot by the
+   bits of the deadline at that level. Deadlines that are too far away are
+   clamped to the last slot reachable from the current tick; they are placed
+   again when that slot is cascaded.
+ */
+static void
+rx_timer_wheel_place(struct rx_timer_wheel *wheel, struct rx_timer *timer)
+{
+    uint64_t expires, delta;
+    size_t level, slot;
+
+    expires = timer->expires;
+    delta   = expires - wheel->now;
+
+    if (delta >= RX_TIMER_WHEEL_RANGE)
+    {
+        delta   = RX_TIMER_WHEEL_RANGE - 1;
+        expires = wheel->now + delta;
+    }
+
+    for (level = 0; level < RX_TIMER_WHEEL_LEVELS - 1; ++level)
+    {
+        if (delta < ((uint64_t)1 << (RX_TIMER_WHEEL_BITS * (level + 1))))
+        {
+            break;
+        }
+    }
+
+    slot = (expires >> (RX_TIMER_WHEEL_BITS * level)) & RX_TIMER_WHEEL_MASK;
+
+    rx_timer_link(&wheel->slots[level][slot], timer);
+}
+
+/* Move the timers of the current slot at `level` one level down, and cascade
+   the level above when this level wraps around */
+static void
+rx_timer_wheel_cascade(struct rx_timer_wheel *wheel, size_t level)
+{
+    struct rx_timer *head, *timer;
+    struct rx_timer list;
+    size_t slot;
+
+    slot = (wheel->now >> (RX_TIMER_WHEEL_BITS * level)) & RX_TIMER_WHEEL_MASK;
+    head = &wheel->slots[level][slot];
+
+    if (head->next != head)
+    {
+        /* Detach the whole slot first, because timers may land in the same
+           slot again when they are far in the future. */
+
+        list.next       = head->next;
+        list.prev       = head->prev;
+        list.next->prev = &list;
+        list.prev->next = &list;
+        head->next      = head;
+        head->prev      = head;
+
+        while (list.next != &list)
+        {
+            timer = list.next;
+
+            rx_timer_unlink(timer);
+            rx_timer_wheel_place(wheel, timer);
+        }
+    }
+
+    if (slot == 0 && level + 1 < RX_TIMER_WHEEL_LEVELS)
+    {
+        rx_timer_wheel_cascade(wheel, level + 1);
+    }
+}
+
+uint64_t
+rx_timer_now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+void
+rx_timer_init(
+    struct rx_timer *timer, void (*handler)(struct rx_timer *), void *data
+)
+{
+    timer->prev    = NULL;
+    timer->next    = NULL;
+    timer->expires = 0;
+    timer->handler = handler;
+    timer->data    = data;
+}
+
+int
+rx_timer_is_active(const struct rx_timer *timer)
+{
+    return timer->next != NULL;
+}
+
+void
+rx_timer_wheel_init(struct rx_timer_wheel *wheel, uint64_t now)
+{
+    size_t level, slot;
+
+    wheel->now     = now;
+    wheel->ntimers = 0;
+
+    for (level = 0; level < RX_TIMER_WHEEL_LEVELS; ++level)
+    {
+        for (slot = 0; slot < RX_TIMER_WHEEL_SLOTS; ++slot)
+        {
+            wheel->slots[level][slot].prev = &wheel->slots[level][slot];
+            wheel->slots[level][slot].next = &wheel->slots[level][slot];
+        }
+    }
+}
+
+void
+rx_timer_wheel_add(
+    struct rx_timer_wheel *wheel, struct rx_timer *timer, uint64_t expires
+)
+{
+    rx_timer_wheel_del(wheel, timer);
+
+    /* The slot of the current tick has been processed already */
+
+    timer->expires = expires > wheel->now ? expires : wheel->now + 1;
+
+    rx_timer_wheel_place(wheel, timer);
+    wheel->ntimers++;
+}
+
+void
+rx_timer_wheel_del(struct rx_timer_wheel *wheel, struct rx_timer *timer)
+{
+    if (!rx_timer_is_active(timer))
+    {
+        return;
+    }
+
+    rx_timer_unlink(timer);
+    wheel->ntimers--;
+}
+
+void
+rx_timer_wheel_advance(struct rx_timer_wheel *wheel, uint64_t now)
+{
+    struct rx_timer *head, *timer;
+
+    while (wheel->now < now)
+    {
+        if (wheel->ntimers == 0)
+        {
+            wheel->now = now;
+            break;
+        }
+
+        wheel->now++;
+
+        if ((wheel->now & RX_TIMER_WHEEL_MASK) == 0)
+        {
+            rx_timer_wheel_cascade(wheel, 1);
+        }
+
+        head = &wheel->slots[0][wheel->now & RX_TIMER_WHEEL_MASK];
+
+        /* Handlers may arm or cancel other timers, so always take the first
+           timer of the slot again instead of keeping an iterator. */
+
+        while (head->next != head)
+        {
+            timer = head->next;
+
+            rx_timer_unlink(timer);
+            wheel->ntimers--;
+
+            timer->handler(timer);
+        }
+    }
+}
+
+int
+rx_timer_wheel_timeout(const struct rx_timer_wheel *wheel)
+{
+    const struct rx_timer *head;
+    uint64_t base, timeout, next;
+    size_t level, k, shift;
+
+    if (wheel->ntimers == 0)
+    {
+        return -1;
+    }
+
+    timeout = RX_TIMER_WHEEL_RANGE;
+
+    /* The first non-empty slot of each level tells when the wheel has to run
+       again, either to fire timers (level 0) or to cascade them. */
+
+    for (level = 0; level < RX_TIMER_WHEEL_LEVELS; ++level)
+    {
+        shift = RX_TIMER_WHEEL_BITS * level;
+        base  = wheel->now >> shift;
+
+        for (k = 1; k <= RX_TIMER_WHEEL_SLOTS; ++k)
+        {
+            head = &wheel->slots[level][(base + k) & RX_TIMER_WHEEL_MASK];
+
+            if (head->next != head)
+            {
+                next = ((base + k) << shift) - wheel->now;
+
+                if (next < timeout)
+                {
+                    timeout = next;
+                }
+
+                break;
+            }
+        }
+    }
+
+    return timeout > INT_MAX ? INT_MAX : (int)timeout;
+}
@@ -0,0 +1,587 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+/* Reduce `RX_TOKENIZER_STRIDE` bytes to two masks: bit `i` of `delims` is
+   set if byte `i` is a CR, LF, colon or space, and bit `i` of `lines` if it
+   is a CR or LF */
+typedef void (*rx_tokenizer_classify_t)(
+    const char *stride, uint64_t *delims, uint64_t *lines
+);
+
+typedef int (*rx_tokenizer_fn_t)(
+    struct rx_tokens *tokens, const char *buffer, size_t len
+);
+
+static int
+rx_tokenize_scalar(struct rx_tokens *tokens, const char *buffer, size_t len);
+
+#if defined(RX_HAVE_X86_INTRINSICS)
+static int
+rx_tokenize_sse42(struct rx_tokens *tokens, const char *buffer, size_t len);
+
+static int
+rx_tokenize_avx2(struct rx_tokens *tokens, const char *buffer, size_t len);
+#endif
+
+static const char *
+rx_tokenizer_trim(const char *begin, const char **end);
+
+static void
+rx_tokenizer_move(const char **p, const char *from, const char *to);
+
+static rx_tokenizer_fn_t rx_tokenizer_fn   = rx_tokenize_scalar;
+static rx_tokenizer_impl_t rx_tokenizer_impl = RX_TOKENIZER_SCALAR;
+
+void
+rx_tokenizer_init()
+{
+    if (rx_tokenizer_use(RX_TOKENIZER_AVX2) == RX_OK)
+    {
+        return;
+    }
+
+    if (rx_tokenizer_use(RX_TOKENIZER_SSE42) == RX_OK)
+    {
+        return;
+    }
+
+    (void)rx_tokenizer_use(RX_TOKENIZER_SCALAR);
+}
+
+int
+rx_tokenizer_use(rx_tokenizer_impl_t impl)
+{
+    rx_tokenizer_fn_t fn;
+
+    switch (impl)
+    {
+    case RX_TOKENIZER_SCALAR:
+        fn = rx_tokenize_scalar;
+        break;
+#if defined(RX_HAVE_X86_INTRINSICS)
+    case RX_TOKENIZER_SSE42:
+        if (!__builtin_cpu_supports("sse4.2"))
+        {
+            return RX_ERROR;
+        }
+        fn = rx_tokenize_sse42;
+        break;
+    case RX_TOKENIZER_AVX2:
+        if (!__builtin_cpu_supports("avx2"))
+        {
+            return RX_ERROR;
+        }
+        fn = rx_tokenize_avx2;
+        break;
+#endif
+    default:
+        return RX_ERROR;
+    }
+
+    rx_tokenizer_fn   = fn;
+    rx_tokenizer_impl = impl;
+
+    return RX_OK;
+}
+
+const char *
+rx_tokenizer_name()
+{
+    switch (rx_tokenizer_impl)
+    {
+    case RX_TOKENIZER_SSE42:
+        return "sse4.2";
+    case RX_TOKENIZER_AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+void
+rx_tokenizer_reset(struct rx_tokens *tokens)
+{
+    tokens->state       = RX_REQUEST_STATE_METHOD;
+    tokens->mark        = 0;
+    tokens->scanned     = 0;
+    tokens->method      = NULL;
+    tokens->method_end  = NULL;
+    tokens->uri         = NULL;
+    tokens->uri_end     = NULL;
+    tokens->version     = NULL;
+    tokens->version_end = NULL;
+    tokens->nheaders    = 0;
+    tokens->end         = NULL;
+}
+
+int
+rx_tokenize(struct rx_tokens *tokens, const char *buffer, size_t len)
+{
+    if (tokens->state == RX_REQUEST_STATE_BODY)
+    {
+        return RX_OK;
+    }
+
+    if (tokens->state == RX_REQUEST_STATE_INVALID)
+    {
+        return RX_ERROR;
+    }
+
+    if (buffer == NULL || len <= tokens->scanned)
+    {
+        return RX_AGAIN;
+    }
+
+    return rx_tokenizer_fn(tokens, buffer, len);
+}
+
+void
+rx_tokenizer_rebase(struct rx_tokens *tokens, const char *from, const char *to)
+{
+    struct rx_token_header *header;
+    size_t i;
+
+    rx_tokenizer_move(&tokens->method, from, to);
+    rx_tokenizer_move(&tokens->method_end, from, to);
+    rx_tokenizer_move(&tokens->uri, from, to);
+    rx_tokenizer_move(&tokens->uri_end, from, to);
+    rx_tokenizer_move(&tokens->version, from, to);
+    rx_tokenizer_move(&tokens->version_end, from, to);
+    rx_tokenizer_move(&tokens->end, from, to);
+
+    for (i = 0; i < tokens->nheaders; i++)
+    {
+        header = &tokens->headers[i];
+
+        rx_tokenizer_move(&header->name, from, to);
+        rx_tokenizer_move(&header->name_end, from, to);
+        rx_tokenizer_move(&header->value, from, to);
+        rx_tokenizer_move(&header->value_end, from, to);
+    }
+
+    /* The name of the header whose value is being read */
+
+    if (tokens->state == RX_REQUEST_STATE_HEADER_VALUE)
+    {
+        header = &tokens->headers[i];
+
+        rx_tokenizer_move(&header->name, from, to);
+        rx_tokenizer_move(&header->name_end, from, to);
+    }
+}
+
+/* The state machine every implementation shares
+
+   It is inlined into each of them, so that `classify` is inlined in turn
+   and compiled for the instruction set of its caller.
+ */
+static inline __attribute__((always_inline)) int
+rx_tokenizer_run(
+    struct rx_tokens *tokens, const char *buffer, size_t len,
+    rx_tokenizer_classify_t classify
+)
+{
+    char tail[RX_TOKENIZER_STRIDE];
+    const char *stride, *end, *mark, *p;
+    struct rx_token_header *header;
+    rx_request_state_t state;
+    uint64_t delims, lines, bits;
+    size_t left;
+    int i;
+
+    /* Pick up where the previous call stopped */
+
+    end    = buffer + len;
+    mark   = buffer + tokens->mark;
+    header = tokens->headers + tokens->nheaders;
+    state  = tokens->state;
+
+    for (stride = buffer + tokens->scanned; stride < end;
+         stride += RX_TOKENIZER_STRIDE)
+    {
+        left = end - stride;
+
+        /* The last stride is padded with zeros rather than read past the
+           bytes received so far */
+
+        if (left >= RX_TOKENIZER_STRIDE)
+        {
+            classify(stride, &delims, &lines);
+        }
+        else
+        {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, stride, left);
+            classify(tail, &delims, &lines);
+        }
+
+        for (;;)
+        {
+            /* Colons and spaces are part of a header value */
+
+            bits = state == RX_REQUEST_STATE_HEADER_VALUE ? lines : delims;
+
+            if (bits == 0)
+            {
+                break;
+            }
+
+            i = __builtin_ctzll(bits);
+            p = stride + i;
+
+            /* Drop the bits up to and including this byte */
+
+            bits    = ~(((uint64_t)2 << i) - 1);
+            delims &= bits;
+            lines  &= bits;
+
+            switch (state)
+            {
+            case RX_REQUEST_STATE_METHOD:
+            case RX_REQUEST_STATE_URI:
+                if (*p == ':')
+                {
+                    break;
+                }
+
+                if (*p != ' ')
+                {
+                    goto invalid;
+                }
+
+                if (state == RX_REQUEST_STATE_METHOD)
+                {
+                    tokens->method     = mark;
+                    tokens->method_end = p;
+                    state              = RX_REQUEST_STATE_URI;
+                }
+                else
+                {
+                    tokens->uri     = mark;
+                    tokens->uri_end = p;
+                    state           = RX_REQUEST_STATE_VERSION;
+                }
+
+                mark = p + 1;
+                break;
+
+            case RX_REQUEST_STATE_VERSION:
+                if (*p == ':')
+                {
+                    break;
+                }
+
+                if (*p != '\r')
+                {
+                    goto invalid;
+                }
+
+                tokens->version     = mark;
+                tokens->version_end = p;
+
+                state = RX_REQUEST_STATE_LF;
+                mark  = p + 1;
+                break;
+
+            case RX_REQUEST_STATE_HEADER:
+                /* A line that starts with CR is the empty line */
+
+                if (*p == '\r' && p == mark)
+                {
+                    state = RX_REQUEST_STATE_HEADER_END;
+                    mark  = p + 1;
+                    break;
+                }
+
+                /* A header name is a token: no whitespace, and not empty */
+
+                if (*p != ':' || p == mark)
+                {
+                    goto invalid;
+                }
+
+                if (tokens->nheaders == RX_TOKENIZER_MAX_HEADERS)
+                {
+                    goto invalid;
+                }
+
+                header->name     = mark;
+                header->name_end = p;
+
+                state = RX_REQUEST_STATE_HEADER_VALUE;
+                mark  = p + 1;
+                break;
+
+            case RX_REQUEST_STATE_HEADER_VALUE:
+                if (*p != '\r')
+                {
+                    goto invalid;
+                }
+
+                header->value_end = p;
+                header->value     = rx_tokenizer_trim(mark, &header->value_end);
+
+                header++;
+                tokens->nheaders++;
+
+                state = RX_REQUEST_STATE_LF;
+                mark  = p + 1;
+                break;
+
+            case RX_REQUEST_STATE_LF:
+            case RX_REQUEST_STATE_HEADER_END:
+                /* Only an LF may follow a CR */
+
+                if (*p != '\n' || p != mark)
+                {
+                    goto invalid;
+                }
+
+                if (state == RX_REQUEST_STATE_LF)
+                {
+                    state = RX_REQUEST_STATE_HEADER;
+                    mark  = p + 1;
+                    break;
+                }
+
+                /* The bytes after the head belong to the body */
+
+                tokens->state   = RX_REQUEST_STATE_BODY;
+                tokens->scanned = p + 1 - buffer;
+                tokens->end     = p + 1;
+
+                return RX_OK;
+
+            default:
+                goto invalid;
+            }
+        }
+    }
+
+    tokens->state   = state;
+    tokens->mark    = mark - buffer;
+    tokens->scanned = len;
+
+    return RX_AGAIN;
+
+invalid:
+    tokens->state = RX_REQUEST_STATE_INVALID;
+
+    return RX_ERROR;
+}
+
+#define RX_TOKENIZER_ONES  0x0101010101010101ULL
+#define RX_TOKENIZER_HIGHS 0x8080808080808080ULL
+
+/* Set the top bit of every byte of `word` that equals `c` */
+static inline uint64_t
+rx_tokenizer_match(uint64_t word, u_char c)
+{
+    uint64_t x;
+
+    x = word ^ (RX_TOKENIZER_ONES * c);
+
+    return ~(((x & ~RX_TOKENIZER_HIGHS) + ~RX_TOKENIZER_HIGHS) | x) &
+           RX_TOKENIZER_HIGHS;
+}
+
+/* Gather the top bit of each byte into the low 8 bits, the first byte in
+   memory first */
+static inline uint64_t
+rx_tokenizer_gather(uint64_t highs)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    highs = __builtin_bswap64(highs);
+#endif
+    return ((highs >> 7) * 0x0102040810204080ULL) >> 56;
+}
+
+/* Without vector instructions, the stride is classified 8 bytes at a time
+   in general purpose registers */
+static inline void
+rx_tokenizer_classify_scalar(
+    const char *stride, uint64_t *delims, uint64_t *lines
+)
+{
+    uint64_t word, eol, d, l;
+    size_t i;
+
+    d = 0;
+    l = 0;
+
+    for (i = 0; i < RX_TOKENIZER_STRIDE; i += 8)
+    {
+        memcpy(&word, stride + i, sizeof(word));
+
+        eol = rx_tokenizer_match(word, '\r') | rx_tokenizer_match(word, '\n');
+
+        d |= rx_tokenizer_gather(
+                 eol | rx_tokenizer_match(word, ':') |
+                 rx_tokenizer_match(word, ' ')
+             )
+             << i;
+        l |= rx_tokenizer_gather(eol) << i;
+    }
+
+    *delims = d;
+    *lines  = l;
+}
+
+static int
+rx_tokenize_scalar(struct rx_tokens *tokens, const char *buffer, size_t len)
+{
+    return rx_tokenizer_run(
+        tokens, buffer, len, rx_tokenizer_classify_scalar
+    );
+}
+
+#if defined(RX_HAVE_X86_INTRINSICS)
+
+/* Compare bytes with any of a set, and return a bit per byte */
+#define RX_TOKENIZER_SIDD                                                      \
+    (_SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK)
+
+/* `pcmpestrm` matches each byte of a 16 byte block against the delimiters
+   and returns the result as a bit mask. Line ends are found with plain
+   compares, which are cheaper than a second `pcmpestrm`. */
+__attribute__((target("sse4.2"))) static inline void
+rx_tokenizer_classify_sse42(
+    const char *stride, uint64_t *delims, uint64_t *lines
+)
+{
+    __m128i set, cr, lf, data, found;
+    uint64_t d, l;
+    int i;
+
+    /* Only the first 4 bytes of the set are compared */
+    set = _mm_setr_epi8(
+        '\r', '\n', ':', ' ', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    );
+    cr = _mm_set1_epi8('\r');
+    lf = _mm_set1_epi8('\n');
+
+    d = 0;
+    l = 0;
+
+    for (i = 0; i < RX_TOKENIZER_STRIDE; i += 16)
+    {
+        data  = _mm_loadu_si128((const __m128i *)(stride + i));
+        found = _mm_cmpestrm(set, 4, data, 16, RX_TOKENIZER_SIDD);
+
+        d |= (uint64_t)(_mm_cvtsi128_si32(found) & 0xffff) << i;
+
+        found = _mm_or_si128(
+            _mm_cmpeq_epi8(data, cr), _mm_cmpeq_epi8(data, lf)
+        );
+
+        l |= (uint64_t)(_mm_movemask_epi8(found) & 0xffff) << i;
+    }
+
+    *delims = d;
+    *lines  = l;
+}
+
+__attribute__((target("sse4.2"))) static int
+rx_tokenize_sse42(struct rx_tokens *tokens, const char *buffer, size_t len)
+{
+    return rx_tokenizer_run(
+        tokens, buffer, len, rx_tokenizer_classify_sse42
+    );
+}
+
+/* Compare 32 bytes at a time with each delimiter and keep the top bit of
+   every byte */
+__attribute__((target("avx2"))) static inline void
+rx_tokenizer_classify_avx2(
+    const char *stride, uint64_t *delims, uint64_t *lines
+)
+{
+    __m256i cr, lf, colon, space, data, eol, found;
+    uint64_t d, l;
+    int i;
+
+    cr    = _mm256_set1_epi8('\r');
+    lf    = _mm256_set1_epi8('\n');
+    colon = _mm256_set1_epi8(':');
+    space = _mm256_set1_epi8(' ');
+
+    d = 0;
+    l = 0;
+
+    for (i = 0; i < RX_TOKENIZER_STRIDE; i += 32)
+    {
+        data  = _mm256_loadu_si256((const __m256i *)(stride + i));
+        eol   = _mm256_or_si256(
+            _mm256_cmpeq_epi8(data, cr), _mm256_cmpeq_epi8(data, lf)
+        );
+        found = _mm256_or_si256(
+            eol, _mm256_or_si256(
+                     _mm256_cmpeq_epi8(data, colon),
+                     _mm256_cmpeq_epi8(data, space)
+                 )
+        );
+
+        d |= (uint64_t)(uint32_t)_mm256_movemask_epi8(found) << i;
+        l |= (uint64_t)(uint32_t)_mm256_movemask_epi8(eol) << i;
+    }
+
+    *delims = d;
+    *lines  = l;
+}
+
+__attribute__((target("avx2"))) static int
+rx_tokenize_avx2(struct rx_tokens *tokens, const char *buffer, size_t len)
+{
+    return rx_tokenizer_run(tokens, buffer, len, rx_tokenizer_classify_avx2);
+}
+
+#endif
+
+/* Strip the spaces and tabs around a header value */
+static const char *
+rx_tokenizer_trim(const char *begin, const char **end)
+{
+    while (begin < *end && (*begin == ' ' || *begin == '\t'))
+    {
+        begin++;
+    }
+
+    while (*end > begin && ((*end)[-1] == ' ' || (*end)[-1] == '\t'))
+    {
+        (*end)--;
+    }
+
+    return begin;
+}
+
+static void
+rx_tokenizer_move(const char **p, const char *from, const char *to)
+{
+    if (*p != NULL)
+    {
+        *p = to + (*p - from);
+    }
+}
@@ -35,9 +35,26 @@ RunAllTests(void)
     RUN_TEST_GROUP(RX_REQUEST_HEADER);
     RUN_TEST_GROUP(RX_REQUEST_HOST_HEADER);
     RUN_TEST_GROUP(RX_REQUEST_ACCEPT_ENCODING_HEADER);
+    RUN_TEST_GROUP(RX_REQUEST_CONNECTION_HEADER);
+    RUN_TEST_GROUP(RX_TOKENIZER);
+    RUN_TEST_GROUP(RX_HEADER_LOOKUP);
+    RUN_TEST_GROUP(RX_CONNECTION_PEER);
+    RUN_TEST_GROUP(RX_CONNECTION_FIND_REQUEST);
+    RUN_TEST_GROUP(RX_CONNECTION_CANCEL);
+    RUN_TEST_GROUP(RX_CONNECTION_BAD_REQUEST);
+    RUN_TEST_GROUP(RX_CHUNKED);
+    RUN_TEST_GROUP(RX_RESPONSE_SEGMENTS);
+    RUN_TEST_GROUP(RX_ROUTE_BLOCKING);
 
     RUN_TEST_GROUP(RX_RING);
     RUN_TEST_GROUP(RX_QLIST);
+    RUN_TEST_GROUP(RX_TIMER);
+    RUN_TEST_GROUP(RX_POOL);
+    RUN_TEST_GROUP(RX_ARENA);
+    RUN_TEST_GROUP(RX_MPSC);
+    RUN_TEST_GROUP(RX_THREAD_POOL);
+    RUN_TEST_GROUP(RX_CODEL);
+    RUN_TEST_GROUP(RX_CORE_BOOT);
 }
 
 int
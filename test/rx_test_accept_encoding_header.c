@@ -432,6 +432,36 @@ TEST(RX_REQUEST_ACCEPT_ENCODING_HEADER, Complex2Text)
     TEST_PASS_MESSAGE("Complex 2 test passed.");
 }
 
+TEST(RX_REQUEST_ACCEPT_ENCODING_HEADER, FollowedByAcceptTest)
+{
+    struct rx_arena arena;
+    struct rx_request request;
+    struct rx_tokens tokens;
+    const char *head = "GET / HTTP/1.1\r\n"
+                       "Accept-Encoding: gzip\r\n"
+                       "Accept: text/html,application/xml;q=0.9,*/*;q=0.8\r\n"
+                       "If-Modified-Since: Sun, 18 Oct 2026 04:29:17 GMT\r\n"
+                       "\r\n";
+
+    rx_arena_init(&arena);
+    rx_request_init(&request, &arena);
+    rx_tokenizer_reset(&tokens);
+
+    /* The value of each header is a view into the head, which goes on with
+       the next headers */
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_tokenize(&tokens, head, strlen(head)));
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_request_process_headers(&request, &tokens));
+
+    TEST_ASSERT_EQUAL_INT(RX_ENCODING_GZIP, request.accept_encoding.encoding);
+    TEST_ASSERT_EQUAL_FLOAT(1.0, request.accept_encoding.qvalue);
+    TEST_ASSERT_EQUAL_size_t(3, request.accept.size);
+    TEST_ASSERT_NOT_NULL(request.if_modified_since);
+    TEST_ASSERT_EQUAL_INT(126, request.if_modified_since->tm.tm_year);
+
+    rx_request_destroy(&request);
+    rx_arena_destroy(&arena);
+}
+
 TEST_GROUP_RUNNER(RX_REQUEST_ACCEPT_ENCODING_HEADER)
 {
     RUN_TEST_CASE(RX_REQUEST_ACCEPT_ENCODING_HEADER, EmptyBufferTest);
@@ -474,4 +504,5 @@ TEST_GROUP_RUNNER(RX_REQUEST_ACCEPT_ENCODING_HEADER)
     RUN_TEST_CASE(RX_REQUEST_ACCEPT_ENCODING_HEADER, QValueMultipleValueTest);
     RUN_TEST_CASE(RX_REQUEST_ACCEPT_ENCODING_HEADER, Complex1Test);
     RUN_TEST_CASE(RX_REQUEST_ACCEPT_ENCODING_HEADER, Complex2Text);
+    RUN_TEST_CASE(RX_REQUEST_ACCEPT_ENCODING_HEADER, FollowedByAcceptTest);
 }
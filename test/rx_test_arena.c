@@ -0,0 +1,157 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static struct rx_arena arena;
+
+static size_t
+rx_test_arena_nblocks(struct rx_arena_block *block)
+{
+    size_t n = 0;
+
+    for (; block != NULL; block = block->next)
+    {
+        n++;
+    }
+
+    return n;
+}
+
+TEST_GROUP(RX_ARENA);
+
+TEST_SETUP(RX_ARENA)
+{
+    rx_arena_init(&arena);
+}
+
+TEST_TEAR_DOWN(RX_ARENA)
+{
+    rx_arena_destroy(&arena);
+}
+
+TEST(RX_ARENA, AllocAlignmentTest)
+{
+    char *a = rx_arena_alloc(&arena, 1);
+    char *b = rx_arena_alloc(&arena, 3);
+    char *c = rx_arena_alloc(&arena, 100);
+
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_TRUE(a < b && b < c);
+    TEST_ASSERT_EQUAL_size_t(0, (uintptr_t)b % _Alignof(max_align_t));
+    TEST_ASSERT_EQUAL_size_t(0, (uintptr_t)c % _Alignof(max_align_t));
+    TEST_ASSERT_EQUAL_size_t(1, rx_test_arena_nblocks(arena.blocks));
+}
+
+TEST(RX_ARENA, ResetReusesMemoryTest)
+{
+    char *first, *again;
+
+    first = rx_arena_alloc(&arena, 64);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        TEST_ASSERT_NOT_NULL(rx_arena_alloc(&arena, RX_ARENA_BLOCK_SIZE / 2));
+    }
+
+    rx_arena_reset(&arena);
+
+    TEST_ASSERT_NULL(arena.used);
+    TEST_ASSERT_EQUAL_size_t(3, rx_test_arena_nblocks(arena.blocks));
+
+    /* The same amount of memory fits into the blocks that were kept */
+    again = rx_arena_alloc(&arena, 64);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        TEST_ASSERT_NOT_NULL(rx_arena_alloc(&arena, RX_ARENA_BLOCK_SIZE / 2));
+    }
+
+    TEST_ASSERT_NOT_NULL(again);
+    TEST_ASSERT_EQUAL_size_t(
+        3, rx_test_arena_nblocks(arena.blocks) +
+               rx_test_arena_nblocks(arena.used)
+    );
+
+    NOOP(first);
+}
+
+TEST(RX_ARENA, LargeAllocTest)
+{
+    char *small = rx_arena_alloc(&arena, 16);
+    char *large = rx_arena_alloc(&arena, 4 * RX_ARENA_BLOCK_SIZE);
+    char *next  = rx_arena_alloc(&arena, 16);
+
+    TEST_ASSERT_NOT_NULL(large);
+    memset(large, 'x', 4 * RX_ARENA_BLOCK_SIZE);
+
+    /* The block in use is not retired by a large allocation */
+    TEST_ASSERT_EQUAL_PTR(small + _Alignof(max_align_t), next);
+    TEST_ASSERT_EQUAL_size_t(1, rx_test_arena_nblocks(arena.used));
+
+    /* Large blocks are released on reset */
+    rx_arena_reset(&arena);
+    TEST_ASSERT_EQUAL_size_t(1, rx_test_arena_nblocks(arena.blocks));
+}
+
+TEST(RX_ARENA, SprintfTest)
+{
+    char *str, *big;
+    int len;
+
+    len = rx_arena_sprintf(&arena, &str, "%s %d", "status", 200);
+    TEST_ASSERT_EQUAL_INT(10, len);
+    TEST_ASSERT_EQUAL_STRING("status 200", str);
+
+    big = malloc(3 * RX_ARENA_BLOCK_SIZE);
+    memset(big, 'a', 3 * RX_ARENA_BLOCK_SIZE - 1);
+    big[3 * RX_ARENA_BLOCK_SIZE - 1] = '\0';
+
+    len = rx_arena_sprintf(&arena, &str, "<%s>", big);
+    TEST_ASSERT_EQUAL_INT(3 * RX_ARENA_BLOCK_SIZE + 1, len);
+    TEST_ASSERT_EQUAL_CHAR('<', str[0]);
+    TEST_ASSERT_EQUAL_CHAR('>', str[len - 1]);
+    TEST_ASSERT_EQUAL_CHAR('\0', str[len]);
+
+    free(big);
+}
+
+TEST(RX_ARENA, StrndupTest)
+{
+    char *str = rx_arena_strndup(&arena, "/login?next=/", 6);
+
+    TEST_ASSERT_EQUAL_STRING("/login", str);
+}
+
+TEST_GROUP_RUNNER(RX_ARENA)
+{
+    RUN_TEST_CASE(RX_ARENA, AllocAlignmentTest);
+    RUN_TEST_CASE(RX_ARENA, ResetReusesMemoryTest);
+    RUN_TEST_CASE(RX_ARENA, LargeAllocTest);
+    RUN_TEST_CASE(RX_ARENA, SprintfTest);
+    RUN_TEST_CASE(RX_ARENA, StrndupTest);
+}
@@ -0,0 +1,150 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static struct rx_event_loop loop;
+static struct rx_connection conn;
+static struct rx_core_options opts;
+static struct rx_view view;
+
+/* Stand-ins for the templates the server maps at startup */
+static char base_template[]         = "%s";
+static char client_error_template[] = "%d %s: %s";
+
+/* Serve `data` as the event loop would, then write the response out to a
+   socket pair and read back the bytes the client receives */
+static void
+rx_test_bad_request_serve(const char *data, char *out, size_t size)
+{
+    size_t len = strlen(data);
+    struct rx_response *res;
+    int fds[2];
+    ssize_t n;
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_reserve(&conn, len));
+
+    memcpy(conn.buffer_end, data, len);
+    conn.buffer_end  += len;
+    *conn.buffer_end  = '\0';
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+
+    conn.state = RX_CONNECTION_STATE_SERVING_REQUEST;
+    TEST_ASSERT_EQUAL_PTR(RX_OK_PTR, rx_connection_process_batch(&conn));
+
+    /* A head that does not parse gives no way to find the next request */
+    res = conn.resp_queue_head;
+    TEST_ASSERT_NOT_NULL(res);
+    TEST_ASSERT_NULL(res->next);
+    TEST_ASSERT_EQUAL_INT(0, res->keep_alive);
+
+    TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    TEST_ASSERT_TRUE(writev(fds[0], res->segments, res->nsegments) > 0);
+
+    n = read(fds[1], out, size - 1);
+    TEST_ASSERT_TRUE(n > 0);
+    out[n] = '\0';
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_GROUP(RX_CONNECTION_BAD_REQUEST);
+
+TEST_SETUP(RX_CONNECTION_BAD_REQUEST)
+{
+    memset(&conn, 0, sizeof(conn));
+
+    opts                            = rx_core_opts;
+    rx_core_opts.keepalive_timeout  = 5;
+    rx_core_opts.keepalive_requests = 100;
+
+    view                                      = rx_view_engine;
+    rx_view_engine.base_template.data         = base_template;
+    rx_view_engine.client_error_template.data = client_error_template;
+
+    rx_buffer_pool_init(&loop.buffers);
+    rx_arena_init(&conn.arena);
+    conn.loop = &loop;
+    conn.fd   = -1;
+}
+
+TEST_TEAR_DOWN(RX_CONNECTION_BAD_REQUEST)
+{
+    rx_connection_cleanup(&conn);
+    rx_connection_release_buffer(&conn);
+    rx_arena_destroy(&conn.arena);
+    rx_buffer_pool_destroy(&loop.buffers);
+
+    rx_core_opts   = opts;
+    rx_view_engine = view;
+}
+
+TEST(RX_CONNECTION_BAD_REQUEST, GarbageTest)
+{
+    char out[4096];
+
+    rx_test_bad_request_serve("GARBAGE\r\n\r\n", out, sizeof(out));
+    TEST_ASSERT_EQUAL_MEMORY("HTTP/1.1 400 ", out, 13);
+}
+
+TEST(RX_CONNECTION_BAD_REQUEST, MissingVersionTest)
+{
+    char out[4096];
+
+    rx_test_bad_request_serve("GET /\r\n\r\n", out, sizeof(out));
+    TEST_ASSERT_EQUAL_MEMORY("HTTP/1.1 400 ", out, 13);
+}
+
+TEST(RX_CONNECTION_BAD_REQUEST, BareLineFeedTest)
+{
+    char out[4096];
+
+    rx_test_bad_request_serve(
+        "GET / HTTP/1.1\nHost: localhost:8080\n\n", out, sizeof(out)
+    );
+    TEST_ASSERT_EQUAL_MEMORY("HTTP/1.1 400 ", out, 13);
+}
+
+TEST(RX_CONNECTION_BAD_REQUEST, MalformedHeaderTest)
+{
+    char out[4096];
+
+    rx_test_bad_request_serve(
+        "GET / HTTP/1.1\r\nNo colon\r\n\r\n", out, sizeof(out)
+    );
+    TEST_ASSERT_EQUAL_MEMORY("HTTP/1.1 400 ", out, 13);
+}
+
+TEST_GROUP_RUNNER(RX_CONNECTION_BAD_REQUEST)
+{
+    RUN_TEST_CASE(RX_CONNECTION_BAD_REQUEST, GarbageTest);
+    RUN_TEST_CASE(RX_CONNECTION_BAD_REQUEST, MissingVersionTest);
+    RUN_TEST_CASE(RX_CONNECTION_BAD_REQUEST, BareLineFeedTest);
+    RUN_TEST_CASE(RX_CONNECTION_BAD_REQUEST, MalformedHeaderTest);
+}
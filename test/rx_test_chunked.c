@@ -0,0 +1,284 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+#define BODY_BUFFER_SIZE 256
+
+static struct rx_chunked chunked;
+static char buffer[BODY_BUFFER_SIZE];
+
+/* Decode `body` fed `step` bytes at a time, the way the bytes are appended to
+   the receive buffer after what was decoded so far, and return the result of
+   the last call. `*decoded` is the length of the decoded body, which is left
+   at the start of `buffer` with the bytes after the body right behind it. */
+static int
+rx_test_chunked_feed(const char *body, size_t step, size_t *decoded)
+{
+    size_t len, fed, pending, n, out, consumed;
+    int ret;
+
+    len     = strlen(body);
+    fed     = 0;
+    pending = 0;
+    out     = 0;
+    ret     = RX_AGAIN;
+
+    while (fed < len && ret == RX_AGAIN)
+    {
+        n = len - fed < step ? len - fed : step;
+
+        memcpy(buffer + out + pending, body + fed, n);
+
+        fed     += n;
+        pending += n;
+
+        ret = rx_chunked_decode(
+            &chunked, buffer + out, pending, &n, &consumed
+        );
+
+        if (ret == RX_ERROR)
+        {
+            break;
+        }
+
+        out     += n;
+        pending -= consumed;
+    }
+
+    /* Whatever followed the body is appended behind it as it arrives */
+
+    memcpy(buffer + out + pending, body + fed, len - fed);
+    buffer[out + pending + len - fed] = '\0';
+
+    *decoded = out;
+
+    return ret;
+}
+
+TEST_GROUP(RX_CHUNKED);
+
+TEST_SETUP(RX_CHUNKED)
+{
+    rx_chunked_init(&chunked);
+    memset(buffer, 0, sizeof(buffer));
+}
+
+TEST_TEAR_DOWN(RX_CHUNKED)
+{
+}
+
+TEST(RX_CHUNKED, SingleChunkTest)
+{
+    size_t decoded;
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_OK, rx_test_chunked_feed("5\r\nhello\r\n0\r\n\r\n", 64, &decoded)
+    );
+
+    TEST_ASSERT_EQUAL_UINT(5, decoded);
+    TEST_ASSERT_EQUAL_STRING("hello", buffer);
+}
+
+TEST(RX_CHUNKED, MultipleChunksTest)
+{
+    size_t decoded;
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_OK, rx_test_chunked_feed(
+                   "4\r\nWiki\r\n5\r\npedia\r\nE\r\n in\r\n\r\nchunks.\r\n"
+                   "0\r\n\r\n",
+                   64, &decoded
+               )
+    );
+
+    TEST_ASSERT_EQUAL_UINT(23, decoded);
+    TEST_ASSERT_EQUAL_STRING("Wikipedia in\r\n\r\nchunks.", buffer);
+}
+
+TEST(RX_CHUNKED, ByteByByteTest)
+{
+    const char *body = "a\r\n0123456789\r\n1A\r\nabcdefghijklmnopqrstuvwxyz"
+                       "\r\n0\r\n\r\n";
+    size_t decoded;
+
+    for (size_t step = 1; step <= strlen(body); step++)
+    {
+        rx_chunked_init(&chunked);
+
+        TEST_ASSERT_EQUAL_INT(
+            RX_OK, rx_test_chunked_feed(body, step, &decoded)
+        );
+
+        TEST_ASSERT_EQUAL_UINT(36, decoded);
+        TEST_ASSERT_EQUAL_STRING(
+            "0123456789abcdefghijklmnopqrstuvwxyz", buffer
+        );
+    }
+}
+
+TEST(RX_CHUNKED, ExtensionTest)
+{
+    size_t decoded;
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_OK, rx_test_chunked_feed(
+                   "3;name=value\r\nabc\r\n2 ; x\r\nde\r\n0;last\r\n\r\n", 1,
+                   &decoded
+               )
+    );
+
+    TEST_ASSERT_EQUAL_UINT(5, decoded);
+    TEST_ASSERT_EQUAL_STRING("abcde", buffer);
+}
+
+TEST(RX_CHUNKED, TrailerTest)
+{
+    size_t decoded;
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_OK, rx_test_chunked_feed(
+                   "3\r\nabc\r\n0\r\nExpires: never\r\nX-Sum: 1\r\n\r\n", 1,
+                   &decoded
+               )
+    );
+
+    TEST_ASSERT_EQUAL_UINT(3, decoded);
+    TEST_ASSERT_EQUAL_STRING("abc", buffer);
+}
+
+TEST(RX_CHUNKED, PipelinedTest)
+{
+    /* The next request follows the body, and must be left intact */
+
+    size_t decoded;
+
+    for (size_t step = 1; step <= 64; step *= 2)
+    {
+        rx_chunked_init(&chunked);
+
+        TEST_ASSERT_EQUAL_INT(
+            RX_OK, rx_test_chunked_feed(
+                       "2\r\nhi\r\n0\r\n\r\nGET / HTTP/1.1\r\n\r\n", step,
+                       &decoded
+                   )
+        );
+
+        TEST_ASSERT_EQUAL_UINT(2, decoded);
+        TEST_ASSERT_EQUAL_STRING("hiGET / HTTP/1.1\r\n\r\n", buffer);
+    }
+}
+
+TEST(RX_CHUNKED, IncompleteTest)
+{
+    size_t decoded;
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_AGAIN, rx_test_chunked_feed("5\r\nhel", 64, &decoded)
+    );
+    TEST_ASSERT_EQUAL_UINT(3, decoded);
+
+    rx_chunked_init(&chunked);
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_AGAIN, rx_test_chunked_feed("5\r\nhello\r\n0\r\n", 64, &decoded)
+    );
+    TEST_ASSERT_EQUAL_UINT(5, decoded);
+}
+
+TEST(RX_CHUNKED, MalformedTest)
+{
+    const char *bodies[] = {
+        "\r\nhello\r\n0\r\n\r\n",      /* no size */
+        "x\r\nhello\r\n0\r\n\r\n",     /* size not hexadecimal */
+        "5\nhello\r\n0\r\n\r\n",       /* bare LF after the size */
+        "5\r\nhelloX\r\n0\r\n\r\n",    /* data longer than the size */
+        "5\r\nhello\r\r0\r\n\r\n",     /* no LF after the data */
+        "5;ext\nhello\r\n0\r\n\r\n",   /* bare LF after an extension */
+        "0\r\nX-Sum: 1\n\r\n",         /* bare LF after a trailer field */
+        "0\r\n\rX",                    /* no LF after the last line */
+        "1000000000000000\r\n",        /* size too large */
+    };
+    size_t decoded;
+
+    for (size_t i = 0; i < sizeof(bodies) / sizeof(bodies[0]); i++)
+    {
+        rx_chunked_init(&chunked);
+
+        TEST_ASSERT_EQUAL_INT(
+            RX_ERROR, rx_test_chunked_feed(bodies[i], 1, &decoded)
+        );
+    }
+
+    rx_chunked_init(&chunked);
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_AGAIN, rx_test_chunked_feed("fffffffffffffff\r\n", 1, &decoded)
+    );
+}
+
+TEST(RX_CHUNKED, FinalTest)
+{
+    size_t decoded, consumed;
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_OK, rx_test_chunked_feed("1\r\na\r\n0\r\n\r\n", 64, &decoded)
+    );
+
+    strcpy(buffer, "1\r\nb\r\n0\r\n\r\n");
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_OK, rx_chunked_decode(&chunked, buffer, 11, &decoded, &consumed)
+    );
+    TEST_ASSERT_EQUAL_UINT(0, decoded);
+    TEST_ASSERT_EQUAL_UINT(0, consumed);
+
+    rx_chunked_init(&chunked);
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_ERROR, rx_test_chunked_feed("z\r\n", 64, &decoded)
+    );
+
+    strcpy(buffer, "1\r\nb\r\n0\r\n\r\n");
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_ERROR, rx_chunked_decode(&chunked, buffer, 11, &decoded, &consumed)
+    );
+}
+
+TEST_GROUP_RUNNER(RX_CHUNKED)
+{
+    RUN_TEST_CASE(RX_CHUNKED, SingleChunkTest);
+    RUN_TEST_CASE(RX_CHUNKED, MultipleChunksTest);
+    RUN_TEST_CASE(RX_CHUNKED, ByteByByteTest);
+    RUN_TEST_CASE(RX_CHUNKED, ExtensionTest);
+    RUN_TEST_CASE(RX_CHUNKED, TrailerTest);
+    RUN_TEST_CASE(RX_CHUNKED, PipelinedTest);
+    RUN_TEST_CASE(RX_CHUNKED, IncompleteTest);
+    RUN_TEST_CASE(RX_CHUNKED, MalformedTest);
+    RUN_TEST_CASE(RX_CHUNKED, FinalTest);
+}
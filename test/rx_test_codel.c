@@ -0,0 +1,105 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+#define MS 1000000ULL
+
+static struct rx_codel codel;
+
+TEST_GROUP(RX_CODEL);
+
+TEST_SETUP(RX_CODEL)
+{
+    rx_codel_init(&codel, 5 * MS, 100 * MS);
+}
+
+TEST_TEAR_DOWN(RX_CODEL)
+{
+}
+
+TEST(RX_CODEL, DisabledTest)
+{
+    rx_codel_init(&codel, 0, 100 * MS);
+
+    for (uint64_t now = 1 * MS; now < 1000 * MS; now += 10 * MS)
+    {
+        TEST_ASSERT_FALSE(rx_codel_shed(&codel, now, 500 * MS));
+    }
+}
+
+TEST(RX_CODEL, BurstTest)
+{
+    /* A queue that drains within the interval is never judged overloaded */
+
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 1 * MS, 50 * MS));
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 30 * MS, 40 * MS));
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 60 * MS, 1 * MS));
+
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 110 * MS, 50 * MS));
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 120 * MS, 50 * MS));
+}
+
+TEST(RX_CODEL, StandingQueueTest)
+{
+    /* Every task of the first interval waited more than the target */
+
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 1 * MS, 20 * MS));
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 50 * MS, 20 * MS));
+
+    /* The first delay of the next interval only starts its minimum */
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 102 * MS, 20 * MS));
+
+    /* Only the tasks that waited more than twice the target are shed */
+    TEST_ASSERT_TRUE(rx_codel_shed(&codel, 110 * MS, 20 * MS));
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 120 * MS, 8 * MS));
+    TEST_ASSERT_TRUE(rx_codel_shed(&codel, 130 * MS, 11 * MS));
+}
+
+TEST(RX_CODEL, RecoverTest)
+{
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 1 * MS, 20 * MS));
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 102 * MS, 20 * MS));
+    TEST_ASSERT_TRUE(rx_codel_shed(&codel, 110 * MS, 20 * MS));
+
+    /* One task got through quickly, so the overload lasts until the end of
+       the interval only */
+
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 150 * MS, 1 * MS));
+    TEST_ASSERT_TRUE(rx_codel_shed(&codel, 160 * MS, 20 * MS));
+
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 210 * MS, 20 * MS));
+    TEST_ASSERT_FALSE(rx_codel_shed(&codel, 220 * MS, 20 * MS));
+}
+
+TEST_GROUP_RUNNER(RX_CODEL)
+{
+    RUN_TEST_CASE(RX_CODEL, DisabledTest);
+    RUN_TEST_CASE(RX_CODEL, BurstTest);
+    RUN_TEST_CASE(RX_CODEL, StandingQueueTest);
+    RUN_TEST_CASE(RX_CODEL, RecoverTest);
+}
@@ -0,0 +1,230 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+#define RX_TEST_CANCEL_REQUEST                                                 \
+    "GET /stats HTTP/1.1\r\nHost: localhost:8080\r\n\r\n"
+
+static struct rx_event_loop loop;
+static struct rx_connection conn;
+static struct rx_core_options opts;
+static int fds[2];
+static int epoll_fd;
+
+/* Queue two pipelined requests and hand the connection over as the event
+   loop does before submitting it */
+static void
+rx_test_cancel_prepare()
+{
+    const char *data = RX_TEST_CANCEL_REQUEST RX_TEST_CANCEL_REQUEST;
+    size_t len       = strlen(data);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_reserve(&conn, len));
+
+    memcpy(conn.buffer_end, data, len);
+    conn.buffer_end  += len;
+    *conn.buffer_end  = '\0';
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+
+    conn.state = RX_CONNECTION_STATE_SERVING_REQUEST;
+}
+
+/* Wait for the events of the socket of the connection, watched as the event
+   loop watches a client */
+static uint32_t
+rx_test_cancel_wait()
+{
+    struct epoll_event ev;
+
+    TEST_ASSERT_EQUAL_INT(1, epoll_wait(epoll_fd, &ev, 1, 1000));
+    TEST_ASSERT_EQUAL_PTR(&conn, ev.data.ptr);
+
+    return ev.events;
+}
+
+static size_t
+rx_test_cancel_responses()
+{
+    struct rx_response *res;
+    size_t n = 0;
+
+    for (res = conn.resp_queue_head; res != NULL; res = res->next)
+    {
+        n++;
+    }
+
+    return n;
+}
+
+TEST_GROUP(RX_CONNECTION_CANCEL);
+
+TEST_SETUP(RX_CONNECTION_CANCEL)
+{
+    struct epoll_event ev;
+
+    memset(&conn, 0, sizeof(conn));
+
+    /* Keep the connection open so that the pipelined request is served */
+    opts                            = rx_core_opts;
+    rx_core_opts.keepalive_timeout  = 5;
+    rx_core_opts.keepalive_requests = 100;
+    rx_core_opts.demo_routes        = 1;
+
+    rx_buffer_pool_init(&loop.buffers);
+    rx_arena_init(&conn.arena);
+    conn.loop = &loop;
+
+    TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    conn.fd = fds[0];
+
+    epoll_fd    = epoll_create1(0);
+    ev.events   = RX_CONNECTION_EVENTS;
+    ev.data.ptr = &conn;
+
+    TEST_ASSERT_NOT_EQUAL(-1, epoll_fd);
+    TEST_ASSERT_EQUAL_INT(
+        0, epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn.fd, &ev)
+    );
+}
+
+TEST_TEAR_DOWN(RX_CONNECTION_CANCEL)
+{
+    rx_connection_cleanup(&conn);
+    rx_connection_release_buffer(&conn);
+    rx_arena_destroy(&conn.arena);
+    rx_buffer_pool_destroy(&loop.buffers);
+
+    close(epoll_fd);
+    close(fds[0]);
+
+    if (fds[1] != -1)
+    {
+        close(fds[1]);
+    }
+
+    rx_core_opts = opts;
+}
+
+TEST(RX_CONNECTION_CANCEL, ServeTest)
+{
+    rx_test_cancel_prepare();
+
+    TEST_ASSERT_FALSE(rx_connection_is_cancelled(&conn));
+    TEST_ASSERT_EQUAL_PTR(RX_OK_PTR, rx_connection_process_batch(&conn));
+    TEST_ASSERT_EQUAL_size_t(2, rx_test_cancel_responses());
+    TEST_ASSERT_EQUAL_PTR(conn.buffer_end, conn.request_start);
+}
+
+TEST(RX_CONNECTION_CANCEL, ClosedBeforeServeTest)
+{
+    char *request_start;
+
+    rx_test_cancel_prepare();
+    request_start = conn.request_start;
+
+    /* The client goes away while the task waits for a worker */
+    close(fds[1]);
+    fds[1] = -1;
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_AGAIN, rx_connection_hangup(&conn, rx_test_cancel_wait())
+    );
+    TEST_ASSERT_TRUE(rx_connection_is_cancelled(&conn));
+    TEST_ASSERT_EQUAL_INT(RX_CONNECTION_STATE_SERVING_REQUEST, conn.state);
+
+    /* Nothing is parsed, routed or rendered for a client that is gone */
+    TEST_ASSERT_EQUAL_PTR(RX_OK_PTR, rx_connection_process_batch(&conn));
+    TEST_ASSERT_EQUAL_size_t(0, rx_test_cancel_responses());
+    TEST_ASSERT_EQUAL_PTR(request_start, conn.request_start);
+}
+
+TEST(RX_CONNECTION_CANCEL, ClosedDuringRequestTest)
+{
+    rx_test_cancel_prepare();
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_prepare(&conn));
+
+    /* The client goes away while a worker serves the request */
+    close(fds[1]);
+    fds[1] = -1;
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_AGAIN, rx_connection_hangup(&conn, rx_test_cancel_wait())
+    );
+
+    /* A request that is already being served stops before its handler */
+    conn.request->state = RX_REQUEST_STATE_METHOD;
+    TEST_ASSERT_EQUAL_PTR(RX_ERROR_PTR, rx_connection_process(&conn));
+    TEST_ASSERT_EQUAL_size_t(0, conn.response->nsegments);
+    TEST_ASSERT_EQUAL_size_t(0, conn.nrequests);
+}
+
+TEST(RX_CONNECTION_CANCEL, HalfClosedIdleTest)
+{
+    const char *data = RX_TEST_CANCEL_REQUEST;
+
+    /* A client that sends a request and closes its side still reads the
+       response, the request is left to the reading path */
+    TEST_ASSERT_EQUAL_INT(
+        (int)strlen(data), (int)write(fds[1], data, strlen(data))
+    );
+    TEST_ASSERT_EQUAL_INT(0, shutdown(fds[1], SHUT_WR));
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_OK, rx_connection_hangup(&conn, rx_test_cancel_wait())
+    );
+    TEST_ASSERT_FALSE(rx_connection_is_cancelled(&conn));
+    TEST_ASSERT_FALSE(conn.eof);
+}
+
+TEST(RX_CONNECTION_CANCEL, HalfClosedServeTest)
+{
+    rx_test_cancel_prepare();
+
+    /* A client that closes its side while a worker serves it still reads
+       the responses, only no request follows them */
+    TEST_ASSERT_EQUAL_INT(0, shutdown(fds[1], SHUT_WR));
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_OK, rx_connection_hangup(&conn, rx_test_cancel_wait())
+    );
+    TEST_ASSERT_FALSE(rx_connection_is_cancelled(&conn));
+    TEST_ASSERT_TRUE(conn.eof);
+
+    TEST_ASSERT_EQUAL_PTR(RX_OK_PTR, rx_connection_process_batch(&conn));
+    TEST_ASSERT_EQUAL_size_t(2, rx_test_cancel_responses());
+}
+
+TEST_GROUP_RUNNER(RX_CONNECTION_CANCEL)
+{
+    RUN_TEST_CASE(RX_CONNECTION_CANCEL, ServeTest);
+    RUN_TEST_CASE(RX_CONNECTION_CANCEL, ClosedBeforeServeTest);
+    RUN_TEST_CASE(RX_CONNECTION_CANCEL, ClosedDuringRequestTest);
+    RUN_TEST_CASE(RX_CONNECTION_CANCEL, HalfClosedIdleTest);
+    RUN_TEST_CASE(RX_CONNECTION_CANCEL, HalfClosedServeTest);
+}
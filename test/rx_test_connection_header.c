@@ -0,0 +1,185 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+int keep_alive;
+
+TEST_GROUP(RX_REQUEST_CONNECTION_HEADER);
+
+TEST_SETUP(RX_REQUEST_CONNECTION_HEADER)
+{
+    keep_alive = 1;
+}
+
+TEST_TEAR_DOWN(RX_REQUEST_CONNECTION_HEADER)
+{
+    keep_alive = 1;
+}
+
+TEST(RX_REQUEST_CONNECTION_HEADER, NullKeepAliveTest)
+{
+    const char *buffer = "close";
+    size_t buffer_size = strlen(buffer);
+
+    int ret = rx_request_process_header_connection(NULL, buffer, buffer_size);
+
+    TEST_ASSERT_EQUAL_INT(RX_ERROR, ret);
+
+    TEST_PASS_MESSAGE("Null keep-alive test passed.");
+}
+
+TEST(RX_REQUEST_CONNECTION_HEADER, EmptyBufferTest)
+{
+    const char *buffer = "";
+    size_t buffer_size = 0;
+
+    int ret =
+        rx_request_process_header_connection(&keep_alive, buffer, buffer_size);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, ret);
+    TEST_ASSERT_EQUAL_INT(1, keep_alive);
+
+    TEST_PASS_MESSAGE("Empty buffer test passed.");
+}
+
+TEST(RX_REQUEST_CONNECTION_HEADER, CloseTest)
+{
+    const char *buffer = "close";
+    size_t buffer_size = strlen(buffer);
+
+    int ret =
+        rx_request_process_header_connection(&keep_alive, buffer, buffer_size);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, ret);
+    TEST_ASSERT_EQUAL_INT(0, keep_alive);
+
+    TEST_PASS_MESSAGE("Close test passed.");
+}
+
+TEST(RX_REQUEST_CONNECTION_HEADER, CaseInsensitiveCloseTest)
+{
+    const char *buffer = "Close";
+    size_t buffer_size = strlen(buffer);
+
+    int ret =
+        rx_request_process_header_connection(&keep_alive, buffer, buffer_size);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, ret);
+    TEST_ASSERT_EQUAL_INT(0, keep_alive);
+
+    TEST_PASS_MESSAGE("Case insensitive close test passed.");
+}
+
+TEST(RX_REQUEST_CONNECTION_HEADER, KeepAliveTest)
+{
+    const char *buffer = "keep-alive";
+    size_t buffer_size = strlen(buffer);
+
+    keep_alive = 0;
+
+    int ret =
+        rx_request_process_header_connection(&keep_alive, buffer, buffer_size);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, ret);
+    TEST_ASSERT_EQUAL_INT(1, keep_alive);
+
+    TEST_PASS_MESSAGE("Keep-alive test passed.");
+}
+
+TEST(RX_REQUEST_CONNECTION_HEADER, UnknownTokenTest)
+{
+    const char *buffer = "Upgrade";
+    size_t buffer_size = strlen(buffer);
+
+    int ret =
+        rx_request_process_header_connection(&keep_alive, buffer, buffer_size);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, ret);
+    TEST_ASSERT_EQUAL_INT(1, keep_alive);
+
+    TEST_PASS_MESSAGE("Unknown token test passed.");
+}
+
+TEST(RX_REQUEST_CONNECTION_HEADER, MultipleTokensTest)
+{
+    const char *buffer = "Upgrade,   keep-alive";
+    size_t buffer_size = strlen(buffer);
+
+    keep_alive = 0;
+
+    int ret =
+        rx_request_process_header_connection(&keep_alive, buffer, buffer_size);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, ret);
+    TEST_ASSERT_EQUAL_INT(1, keep_alive);
+
+    TEST_PASS_MESSAGE("Multiple tokens test passed.");
+}
+
+TEST(RX_REQUEST_CONNECTION_HEADER, CloseWinsTest)
+{
+    const char *buffer = "keep-alive, close";
+    size_t buffer_size = strlen(buffer);
+
+    int ret =
+        rx_request_process_header_connection(&keep_alive, buffer, buffer_size);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, ret);
+    TEST_ASSERT_EQUAL_INT(0, keep_alive);
+
+    TEST_PASS_MESSAGE("Close wins test passed.");
+}
+
+TEST(RX_REQUEST_CONNECTION_HEADER, PartialTokenTest)
+{
+    const char *buffer = "closed";
+    size_t buffer_size = strlen(buffer);
+
+    int ret =
+        rx_request_process_header_connection(&keep_alive, buffer, buffer_size);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, ret);
+    TEST_ASSERT_EQUAL_INT(1, keep_alive);
+
+    TEST_PASS_MESSAGE("Partial token test passed.");
+}
+
+TEST_GROUP_RUNNER(RX_REQUEST_CONNECTION_HEADER)
+{
+    RUN_TEST_CASE(RX_REQUEST_CONNECTION_HEADER, NullKeepAliveTest);
+    RUN_TEST_CASE(RX_REQUEST_CONNECTION_HEADER, EmptyBufferTest);
+
+    RUN_TEST_CASE(RX_REQUEST_CONNECTION_HEADER, CloseTest);
+    RUN_TEST_CASE(RX_REQUEST_CONNECTION_HEADER, CaseInsensitiveCloseTest);
+    RUN_TEST_CASE(RX_REQUEST_CONNECTION_HEADER, KeepAliveTest);
+    RUN_TEST_CASE(RX_REQUEST_CONNECTION_HEADER, UnknownTokenTest);
+
+    RUN_TEST_CASE(RX_REQUEST_CONNECTION_HEADER, MultipleTokensTest);
+    RUN_TEST_CASE(RX_REQUEST_CONNECTION_HEADER, CloseWinsTest);
+    RUN_TEST_CASE(RX_REQUEST_CONNECTION_HEADER, PartialTokenTest);
+}
@@ -0,0 +1,138 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static struct rx_event_loop loop;
+static struct rx_connection conn;
+
+TEST_GROUP(RX_CONNECTION_PEER);
+
+TEST_SETUP(RX_CONNECTION_PEER)
+{
+    loop.epoll_fd = -1;
+}
+
+TEST_TEAR_DOWN(RX_CONNECTION_PEER)
+{
+}
+
+TEST(RX_CONNECTION_PEER, IPv4Test)
+{
+    struct sockaddr_in sin;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port   = htons(54321);
+    inet_pton(AF_INET, "192.168.1.20", &sin.sin_addr);
+
+    rx_connection_init(&conn, &loop, -1, (struct sockaddr *)&sin, sizeof(sin));
+
+    TEST_ASSERT_EQUAL_STRING("", conn.peer);
+    TEST_ASSERT_EQUAL_STRING("192.168.1.20:54321", rx_connection_peer(&conn));
+}
+
+TEST(RX_CONNECTION_PEER, IPv6Test)
+{
+    struct sockaddr_in6 sin6;
+
+    memset(&sin6, 0, sizeof(sin6));
+    sin6.sin6_family = AF_INET6;
+    sin6.sin6_port   = htons(8080);
+    inet_pton(AF_INET6, "2001:db8::1", &sin6.sin6_addr);
+
+    rx_connection_init(
+        &conn, &loop, -1, (struct sockaddr *)&sin6, sizeof(sin6)
+    );
+
+    TEST_ASSERT_EQUAL_STRING("[2001:db8::1]:8080", rx_connection_peer(&conn));
+}
+
+TEST(RX_CONNECTION_PEER, IPv6MaxLengthTest)
+{
+    struct sockaddr_in6 sin6;
+    const char *peer;
+
+    memset(&sin6, 0, sizeof(sin6));
+    sin6.sin6_family = AF_INET6;
+    sin6.sin6_port   = htons(65535);
+    inet_pton(
+        AF_INET6, "ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255",
+        &sin6.sin6_addr
+    );
+
+    rx_connection_init(
+        &conn, &loop, -1, (struct sockaddr *)&sin6, sizeof(sin6)
+    );
+
+    peer = rx_connection_peer(&conn);
+
+    TEST_ASSERT_EQUAL_CHAR('[', peer[0]);
+    TEST_ASSERT_NOT_NULL(strstr(peer, "]:65535"));
+}
+
+TEST(RX_CONNECTION_PEER, UnknownFamilyTest)
+{
+    struct sockaddr_storage ss;
+
+    memset(&ss, 0, sizeof(ss));
+    ss.ss_family = AF_UNSPEC;
+
+    rx_connection_init(&conn, &loop, -1, (struct sockaddr *)&ss, sizeof(ss));
+
+    TEST_ASSERT_EQUAL_STRING("unknown", rx_connection_peer(&conn));
+}
+
+TEST(RX_CONNECTION_PEER, CachedTest)
+{
+    struct sockaddr_in sin;
+    const char *first;
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port   = htons(80);
+    inet_pton(AF_INET, "10.0.0.1", &sin.sin_addr);
+
+    rx_connection_init(&conn, &loop, -1, (struct sockaddr *)&sin, sizeof(sin));
+
+    first = rx_connection_peer(&conn);
+
+    /* The formatted address is not updated behind the cache */
+    ((struct sockaddr_in *)&conn.addr)->sin_port = htons(81);
+
+    TEST_ASSERT_EQUAL_PTR(first, rx_connection_peer(&conn));
+    TEST_ASSERT_EQUAL_STRING("10.0.0.1:80", rx_connection_peer(&conn));
+}
+
+TEST_GROUP_RUNNER(RX_CONNECTION_PEER)
+{
+    RUN_TEST_CASE(RX_CONNECTION_PEER, IPv4Test);
+    RUN_TEST_CASE(RX_CONNECTION_PEER, IPv6Test);
+    RUN_TEST_CASE(RX_CONNECTION_PEER, IPv6MaxLengthTest);
+    RUN_TEST_CASE(RX_CONNECTION_PEER, UnknownFamilyTest);
+    RUN_TEST_CASE(RX_CONNECTION_PEER, CachedTest);
+}
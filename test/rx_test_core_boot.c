@@ -0,0 +1,91 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static void (*handler)(int);
+static char path[64];
+static int file_fd;
+static int fds[2];
+
+TEST_GROUP(RX_CORE_BOOT);
+
+TEST_SETUP(RX_CORE_BOOT)
+{
+    char chunk[4096];
+    size_t i;
+
+    handler = signal(SIGPIPE, SIG_DFL);
+
+    memset(chunk, 'x', sizeof(chunk));
+    strcpy(path, "/tmp/rx_test_core_boot.XXXXXX");
+
+    file_fd = mkstemp(path);
+    TEST_ASSERT_NOT_EQUAL(-1, file_fd);
+
+    for (i = 0; i < 64; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(
+            (int)sizeof(chunk), (int)write(file_fd, chunk, sizeof(chunk))
+        );
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+}
+
+TEST_TEAR_DOWN(RX_CORE_BOOT)
+{
+    close(fds[0]);
+    close(file_fd);
+    unlink(path);
+
+    signal(SIGPIPE, handler);
+}
+
+TEST(RX_CORE_BOOT, ResetDuringFileSendTest)
+{
+    size_t nloops = rx_nloops;
+    off_t offset  = 0;
+
+    /* No event loop to make listen, only the process is set up */
+    rx_nloops = 0;
+    rx_core_boot();
+    rx_nloops = nloops;
+
+    /* The client goes away after the first part of the file */
+    TEST_ASSERT_TRUE(sendfile(fds[0], file_fd, &offset, 1024) > 0);
+    close(fds[1]);
+
+    /* The server is still alive, only the send fails */
+    TEST_ASSERT_EQUAL_INT(-1, (int)sendfile(fds[0], file_fd, &offset, 65536));
+    TEST_ASSERT_EQUAL_INT(EPIPE, errno);
+}
+
+TEST_GROUP_RUNNER(RX_CORE_BOOT)
+{
+    RUN_TEST_CASE(RX_CORE_BOOT, ResetDuringFileSendTest);
+}
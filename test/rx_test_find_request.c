@@ -0,0 +1,305 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static struct rx_event_loop loop;
+static struct rx_connection conn;
+
+/* Append `data` to the buffer of the connection, as the event loop does */
+static void
+rx_test_find_request_append(const char *data)
+{
+    size_t len = strlen(data);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_reserve(&conn, len));
+
+    memcpy(conn.buffer_end, data, len);
+    conn.buffer_end  += len;
+    *conn.buffer_end  = '\0';
+}
+
+TEST_GROUP(RX_CONNECTION_FIND_REQUEST);
+
+TEST_SETUP(RX_CONNECTION_FIND_REQUEST)
+{
+    memset(&conn, 0, sizeof(conn));
+
+    rx_buffer_pool_init(&loop.buffers);
+    conn.loop = &loop;
+}
+
+TEST_TEAR_DOWN(RX_CONNECTION_FIND_REQUEST)
+{
+    rx_connection_release_buffer(&conn);
+    rx_arena_destroy(&conn.arena);
+    rx_buffer_pool_destroy(&loop.buffers);
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, SplitTerminatorTest)
+{
+    rx_test_find_request_append("GET / HTTP/1.1\r\nHost: a\r\n\r");
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_size_t(
+        conn.buffer_end - conn.request_start, conn.tokens->scanned
+    );
+
+    rx_test_find_request_append("\n");
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_PTR(conn.buffer_end, conn.body_start);
+    TEST_ASSERT_EQUAL_PTR(conn.buffer_end - 4, conn.header_end);
+
+    conn.buffer_end = conn.buffer_start;
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, ScanResumesTest)
+{
+    rx_test_find_request_append("GET / HTTP/1.1\r\n");
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_size_t(16, conn.tokens->scanned);
+
+    /* Bytes that have been scanned already are not scanned again */
+    conn.request_start[4] = '\r';
+    conn.request_start[5] = '\n';
+    conn.request_start[6] = '\r';
+    conn.request_start[7] = '\n';
+
+    rx_test_find_request_append("Host: a\r\n");
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_size_t(25, conn.tokens->scanned);
+    TEST_ASSERT_EQUAL_size_t(1, conn.tokens->nheaders);
+
+    conn.buffer_end = conn.buffer_start;
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, MalformedHeaderTest)
+{
+    /* The request is rejected before the rest of its header arrives */
+    rx_test_find_request_append("GET / HTTP/1.1\r\nNo colon\r\n");
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_INT(RX_REQUEST_STATE_INVALID, conn.tokens->state);
+    TEST_ASSERT_EQUAL_PTR(conn.buffer_end, conn.body_start);
+    TEST_ASSERT_EQUAL_size_t(0, conn.content_length);
+
+    conn.buffer_end = conn.buffer_start;
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, BufferGrowsTest)
+{
+    char value[4096];
+    const char *old;
+
+    rx_test_find_request_append("GET /about HTTP/1.1\r\nX-Long: ");
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_connection_find_request(&conn));
+
+    /* The tokens follow the request when it moves to a larger buffer */
+    old = conn.buffer_start;
+
+    memset(value, 'v', sizeof(value) - 1);
+    value[sizeof(value) - 1] = '\0';
+
+    rx_test_find_request_append(value);
+    rx_test_find_request_append("\r\nHost: a\r\n\r\n");
+    TEST_ASSERT_TRUE(conn.buffer_start != old);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_PTR(conn.request_start + 4, conn.tokens->uri);
+    TEST_ASSERT_EQUAL_MEMORY("/about", conn.tokens->uri, 6);
+    TEST_ASSERT_EQUAL_size_t(2, conn.tokens->nheaders);
+    TEST_ASSERT_EQUAL_MEMORY("X-Long", conn.tokens->headers[0].name, 6);
+    TEST_ASSERT_EQUAL_size_t(
+        sizeof(value) - 1,
+        conn.tokens->headers[0].value_end - conn.tokens->headers[0].value
+    );
+    TEST_ASSERT_EQUAL_PTR(conn.buffer_end, conn.body_start);
+
+    conn.buffer_end = conn.buffer_start;
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, BodyAfterHeaderTest)
+{
+    rx_test_find_request_append(
+        "POST /login HTTP/1.1\r\nContent-Length: 5\r\n\r\nab"
+    );
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_size_t(5, conn.content_length);
+    TEST_ASSERT_TRUE(conn.body_start > conn.request_start);
+
+    rx_test_find_request_append("cde");
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_STRING("abcde", conn.body_start);
+
+    conn.buffer_end = conn.buffer_start;
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, ChunkedBodyTest)
+{
+    rx_test_find_request_append(
+        "POST /login HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "3\r\nab"
+    );
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_INT(1, conn.chunked);
+    TEST_ASSERT_EQUAL_size_t(2, conn.content_length);
+
+    /* The body is decoded in place, the next request stays behind it */
+    rx_test_find_request_append("c\r\n2\r\nde\r\n0\r\n\r\nGET / HTTP/1.1");
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_size_t(5, conn.content_length);
+    TEST_ASSERT_EQUAL_STRING("abcdeGET / HTTP/1.1", conn.body_start);
+
+    conn.buffer_end = conn.buffer_start;
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, UnknownCodingTest)
+{
+    /* A request refused because of its body is complete without it */
+    rx_test_find_request_append(
+        "POST /login HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\nab"
+    );
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_INT(
+        RX_HTTP_STATUS_CODE_NOT_IMPLEMENTED, conn.body_status
+    );
+
+    conn.buffer_end = conn.buffer_start;
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, AmbiguousLengthTest)
+{
+    rx_test_find_request_append(
+        "POST /login HTTP/1.1\r\nContent-Length: 5\r\n"
+        "Transfer-Encoding: chunked\r\n\r\n"
+    );
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_INT(RX_HTTP_STATUS_CODE_BAD_REQUEST, conn.body_status);
+
+    conn.buffer_end = conn.buffer_start;
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, ConflictingLengthTest)
+{
+    rx_test_find_request_append(
+        "POST /login HTTP/1.1\r\nContent-Length: 5\r\n"
+        "Content-Length: 50\r\n\r\nabcde"
+    );
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_INT(RX_HTTP_STATUS_CODE_BAD_REQUEST, conn.body_status);
+
+    conn.buffer_end = conn.buffer_start;
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, RepeatedLengthTest)
+{
+    /* Copies that agree frame the body like a single one */
+    rx_test_find_request_append(
+        "POST /login HTTP/1.1\r\nContent-Length: 5\r\n"
+        "Content-Length: 5\r\n\r\nabcde"
+    );
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_INT(RX_HTTP_STATUS_CODE_UNSET, conn.body_status);
+    TEST_ASSERT_EQUAL_size_t(5, conn.content_length);
+
+    conn.buffer_end = conn.buffer_start;
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, InvalidLengthTest)
+{
+    /* A length that is not a plain number in range is refused */
+    const char *requests[] = {
+        "POST /login HTTP/1.1\r\nContent-Length: -1\r\n\r\n",
+        "POST /login HTTP/1.1\r\nContent-Length: 5abc\r\n\r\nabcde",
+        "POST /login HTTP/1.1\r\nContent-Length: +5\r\n\r\nabcde",
+        "POST /login HTTP/1.1\r\nContent-Length: \r\n\r\n",
+        "POST /login HTTP/1.1\r\n"
+        "Content-Length: 99999999999999999999999\r\n\r\n",
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(requests) / sizeof(requests[0]); i++)
+    {
+        rx_test_find_request_append(requests[i]);
+        TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+        TEST_ASSERT_EQUAL_INT(
+            RX_HTTP_STATUS_CODE_BAD_REQUEST, conn.body_status
+        );
+
+        rx_connection_release_buffer(&conn);
+        rx_arena_destroy(&conn.arena);
+        memset(&conn, 0, sizeof(conn));
+        conn.loop = &loop;
+    }
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, BodyTooLargeTest)
+{
+    /* A body that has no consumer must fit in the buffer */
+    rx_test_find_request_append(
+        "POST /login HTTP/1.1\r\nContent-Length: 2000000\r\n\r\n"
+    );
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_INT(
+        RX_HTTP_STATUS_CODE_PAYLOAD_TOO_LARGE, conn.body_status
+    );
+
+    conn.buffer_end = conn.buffer_start;
+}
+
+TEST(RX_CONNECTION_FIND_REQUEST, BodyConsumerTest)
+{
+    int demo_routes = rx_core_opts.demo_routes;
+
+    /* A route that consumes its body is not limited by the buffer */
+    rx_core_opts.demo_routes = 1;
+
+    rx_test_find_request_append(
+        "POST /upload HTTP/1.1\r\nContent-Length: 2000000\r\n\r\nab"
+    );
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_INT(RX_HTTP_STATUS_CODE_UNSET, conn.body_status);
+    TEST_ASSERT_NOT_NULL(conn.body_sink);
+
+    rx_core_opts.demo_routes = demo_routes;
+    conn.buffer_end          = conn.buffer_start;
+}
+
+TEST_GROUP_RUNNER(RX_CONNECTION_FIND_REQUEST)
+{
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, SplitTerminatorTest);
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, ScanResumesTest);
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, MalformedHeaderTest);
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, BufferGrowsTest);
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, BodyAfterHeaderTest);
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, ChunkedBodyTest);
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, UnknownCodingTest);
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, AmbiguousLengthTest);
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, ConflictingLengthTest);
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, RepeatedLengthTest);
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, InvalidLengthTest);
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, BodyTooLargeTest);
+    RUN_TEST_CASE(RX_CONNECTION_FIND_REQUEST, BodyConsumerTest);
+}
@@ -0,0 +1,178 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static rx_header_t
+rx_test_lookup(const char *name)
+{
+    return rx_header_lookup(name, strlen(name));
+}
+
+TEST_GROUP(RX_HEADER_LOOKUP);
+
+TEST_SETUP(RX_HEADER_LOOKUP)
+{
+}
+
+TEST_TEAR_DOWN(RX_HEADER_LOOKUP)
+{
+}
+
+TEST(RX_HEADER_LOOKUP, KnownTest)
+{
+    char name[RX_HEADER_MAX_NAME_LENGTH + 1];
+    const char *canonical;
+    size_t i, len;
+    int header;
+
+    for (header = RX_HEADER_UNKNOWN + 1; header < RX_HEADER_MAX; header++)
+    {
+        canonical = rx_header_name(header);
+
+        TEST_ASSERT_NOT_NULL(canonical);
+        TEST_ASSERT_EQUAL_INT(header, rx_test_lookup(canonical));
+
+        /* Header names are case-insensitive */
+
+        len = strlen(canonical);
+
+        for (i = 0; i <= len; i++)
+        {
+            name[i] = tolower((u_char)canonical[i]);
+        }
+
+        TEST_ASSERT_EQUAL_INT(header, rx_test_lookup(name));
+
+        for (i = 0; i <= len; i++)
+        {
+            name[i] = toupper((u_char)canonical[i]);
+        }
+
+        TEST_ASSERT_EQUAL_INT(header, rx_test_lookup(name));
+    }
+}
+
+TEST(RX_HEADER_LOOKUP, UnknownTest)
+{
+    TEST_ASSERT_EQUAL_INT(RX_HEADER_UNKNOWN, rx_test_lookup("X-Custom"));
+    TEST_ASSERT_EQUAL_INT(RX_HEADER_UNKNOWN, rx_test_lookup(""));
+    TEST_ASSERT_EQUAL_INT(RX_HEADER_UNKNOWN, rx_test_lookup("H"));
+    TEST_ASSERT_EQUAL_INT(RX_HEADER_UNKNOWN, rx_header_lookup(NULL, 4));
+
+    /* Same length, first and second to last character as a known name, so
+       the same slot */
+    TEST_ASSERT_EQUAL_INT(RX_HEADER_UNKNOWN, rx_test_lookup("Hxst"));
+    TEST_ASSERT_EQUAL_INT(RX_HEADER_UNKNOWN, rx_test_lookup("Content-Lengxh"));
+
+    /* A prefix or an extension of a known name */
+    TEST_ASSERT_EQUAL_INT(RX_HEADER_UNKNOWN, rx_test_lookup("Accep"));
+    TEST_ASSERT_EQUAL_INT(RX_HEADER_UNKNOWN, rx_test_lookup("Accepts"));
+    TEST_ASSERT_EQUAL_INT(
+        RX_HEADER_UNKNOWN,
+        rx_test_lookup("Access-Control-Request-Headers-And-More")
+    );
+
+    /* Only the given length is looked at */
+    TEST_ASSERT_EQUAL_INT(RX_HEADER_HOST, rx_header_lookup("Hostname", 4));
+}
+
+TEST(RX_HEADER_LOOKUP, NameTest)
+{
+    TEST_ASSERT_EQUAL_STRING("Host", rx_header_name(RX_HEADER_HOST));
+    TEST_ASSERT_EQUAL_STRING(
+        "Content-Length", rx_header_name(RX_HEADER_CONTENT_LENGTH)
+    );
+    TEST_ASSERT_NULL(rx_header_name(RX_HEADER_UNKNOWN));
+    TEST_ASSERT_NULL(rx_header_name(RX_HEADER_MAX));
+}
+
+TEST(RX_HEADER_LOOKUP, DispatchTest)
+{
+    struct rx_arena arena;
+    struct rx_request request;
+    struct rx_tokens tokens;
+    const char *head = "POST /login HTTP/1.1\r\n"
+                       "user-agent: curl/8.5.0\r\n"
+                       "HOST: localhost:8080\r\n"
+                       "Cookie: a=b\r\n"
+                       "content-length: 12\r\n"
+                       "X-Custom: whatever\r\n"
+                       "CONNECTION: close\r\n"
+                       "\r\n";
+
+    rx_arena_init(&arena);
+    rx_request_init(&request, &arena);
+    rx_tokenizer_reset(&tokens);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_tokenize(&tokens, head, strlen(head)));
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_request_process_headers(&request, &tokens));
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_REQUEST_HEADER_HOST_RESULT_OK, request.host.result
+    );
+    TEST_ASSERT_EQUAL_size_t(12, request.content_length);
+    TEST_ASSERT_EQUAL_INT(0, request.keep_alive);
+
+    rx_request_destroy(&request);
+    rx_arena_destroy(&arena);
+}
+
+TEST(RX_HEADER_LOOKUP, DispatchViewTest)
+{
+    struct rx_arena arena;
+    struct rx_request request;
+    struct rx_tokens tokens;
+    const char *head = "POST /login HTTP/1.1\r\n"
+                       "Accept: text/html,\r\n"
+                       "Content-Type: text\r\n"
+                       "X-List: a, b;q=0.5, c\r\n"
+                       "\r\n";
+
+    rx_arena_init(&arena);
+    rx_request_init(&request, &arena);
+    rx_tokenizer_reset(&tokens);
+
+    /* A handler only reads its own value, not the headers that follow */
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_tokenize(&tokens, head, strlen(head)));
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_request_process_headers(&request, &tokens));
+
+    TEST_ASSERT_EQUAL_size_t(1, request.accept.size);
+    TEST_ASSERT_EQUAL_INT(RX_HTTP_MIME_ALL, request.content_type);
+
+    rx_request_destroy(&request);
+    rx_arena_destroy(&arena);
+}
+
+TEST_GROUP_RUNNER(RX_HEADER_LOOKUP)
+{
+    RUN_TEST_CASE(RX_HEADER_LOOKUP, KnownTest);
+    RUN_TEST_CASE(RX_HEADER_LOOKUP, UnknownTest);
+    RUN_TEST_CASE(RX_HEADER_LOOKUP, NameTest);
+    RUN_TEST_CASE(RX_HEADER_LOOKUP, DispatchTest);
+    RUN_TEST_CASE(RX_HEADER_LOOKUP, DispatchViewTest);
+}
@@ -32,13 +32,10 @@ struct rx_header_host header;
 static void
 rx_memset_header_host(struct rx_header_host *host)
 {
-    memset(host->raw_host, 0, sizeof(host->raw_host));
+    memset(&host->host, 0, sizeof(host->host));
+    memset(&host->port, 0, sizeof(host->port));
 
-    host->result   = RX_REQUEST_HEADER_HOST_RESULT_NONE;
-    host->host     = NULL;
-    host->host_end = NULL;
-    host->port     = NULL;
-    host->port_end = NULL;
+    host->result = RX_REQUEST_HEADER_HOST_RESULT_NONE;
 }
 
 TEST_GROUP(RX_REQUEST_HOST_HEADER);
@@ -103,10 +100,10 @@ TEST(RX_REQUEST_HOST_HEADER, SimpleValidHostTest)
 
     TEST_ASSERT_EQUAL_INT(RX_OK, result);
     TEST_ASSERT_EQUAL_INT(RX_REQUEST_HEADER_HOST_RESULT_OK, header.result);
-    TEST_ASSERT_EQUAL_STRING_LEN("localhost", header.host,
-                                 header.host_end - header.host);
-    TEST_ASSERT_EQUAL_STRING_LEN("80", header.port,
-                                 header.port_end - header.port);
+    TEST_ASSERT_EQUAL_STRING_LEN("localhost", header.host.data,
+                                 header.host.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("80", header.port.data,
+                                 header.port.len);
 
     TEST_PASS_MESSAGE("Simple valid host test passed");
 }
@@ -120,13 +117,13 @@ TEST(RX_REQUEST_HOST_HEADER, LongValidHostTest)
     TEST_ASSERT_EQUAL_INT(RX_OK, result);
     TEST_ASSERT_EQUAL_INT(RX_REQUEST_HEADER_HOST_RESULT_OK, header.result);
 
-    TEST_ASSERT_EQUAL(strlen("localhost"), header.host_end - header.host);
-    TEST_ASSERT_EQUAL_STRING_LEN("localhost", header.host,
-                                 header.host_end - header.host);
+    TEST_ASSERT_EQUAL(strlen("localhost"), header.host.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("localhost", header.host.data,
+                                 header.host.len);
 
-    TEST_ASSERT_EQUAL(strlen("8080"), header.port_end - header.port);
-    TEST_ASSERT_EQUAL_STRING_LEN("8080", header.port,
-                                 header.port_end - header.port);
+    TEST_ASSERT_EQUAL(strlen("8080"), header.port.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("8080", header.port.data,
+                                 header.port.len);
 
     TEST_PASS_MESSAGE("Long valid host test passed");
 }
@@ -143,13 +140,13 @@ TEST(RX_REQUEST_HOST_HEADER, LoopbackAddressHostTest)
     TEST_ASSERT_EQUAL_INT(RX_OK, result);
     TEST_ASSERT_EQUAL_INT(RX_REQUEST_HEADER_HOST_RESULT_OK, header.result);
 
-    TEST_ASSERT_EQUAL(addr_len, header.host_end - header.host);
-    TEST_ASSERT_EQUAL_STRING_LEN("127.0.0.1", header.host,
-                                 header.host_end - header.host);
+    TEST_ASSERT_EQUAL(addr_len, header.host.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("127.0.0.1", header.host.data,
+                                 header.host.len);
 
-    TEST_ASSERT_EQUAL(port_len, header.port_end - header.port);
-    TEST_ASSERT_EQUAL_STRING_LEN("8080", header.port,
-                                 header.port_end - header.port);
+    TEST_ASSERT_EQUAL(port_len, header.port.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("8080", header.port.data,
+                                 header.port.len);
 
     TEST_PASS_MESSAGE("Loopback address host test passed");
 }
@@ -166,13 +163,13 @@ TEST(RX_REQUEST_HOST_HEADER, BroadcastAddressHostTest)
     TEST_ASSERT_EQUAL_INT(RX_OK, result);
     TEST_ASSERT_EQUAL_INT(RX_REQUEST_HEADER_HOST_RESULT_OK, header.result);
 
-    TEST_ASSERT_EQUAL(addr_len, header.host_end - header.host);
-    TEST_ASSERT_EQUAL_STRING_LEN("0.0.0.0", header.host,
-                                 header.host_end - header.host);
+    TEST_ASSERT_EQUAL(addr_len, header.host.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("0.0.0.0", header.host.data,
+                                 header.host.len);
 
-    TEST_ASSERT_EQUAL(port_len, header.port_end - header.port);
-    TEST_ASSERT_EQUAL_STRING_LEN("8080", header.port,
-                                 header.port_end - header.port);
+    TEST_ASSERT_EQUAL(port_len, header.port.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("8080", header.port.data,
+                                 header.port.len);
 
     TEST_PASS_MESSAGE("Broadcast address host test passed");
 }
@@ -213,13 +210,13 @@ TEST(RX_REQUEST_HOST_HEADER, LocalWithWrongPortHostTest)
     TEST_ASSERT_EQUAL_INT(RX_REQUEST_HEADER_HOST_RESULT_UNSUPPORTED,
                           header.result);
 
-    TEST_ASSERT_EQUAL(addr_len, header.host_end - header.host);
-    TEST_ASSERT_EQUAL_STRING_LEN("localhost", header.host,
-                                 header.host_end - header.host);
+    TEST_ASSERT_EQUAL(addr_len, header.host.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("localhost", header.host.data,
+                                 header.host.len);
 
-    TEST_ASSERT_EQUAL(port_len, header.port_end - header.port);
-    TEST_ASSERT_EQUAL_STRING_LEN("8000", header.port,
-                                 header.port_end - header.port);
+    TEST_ASSERT_EQUAL(port_len, header.port.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("8000", header.port.data,
+                                 header.port.len);
 
     TEST_PASS_MESSAGE("Local with wrong port host test passed");
 }
@@ -237,13 +234,13 @@ TEST(RX_REQUEST_HOST_HEADER, LoopbackWithWrongPortHostTest)
     TEST_ASSERT_EQUAL_INT(RX_REQUEST_HEADER_HOST_RESULT_UNSUPPORTED,
                           header.result);
 
-    TEST_ASSERT_EQUAL(addr_len, header.host_end - header.host);
-    TEST_ASSERT_EQUAL_STRING_LEN("127.0.0.1", header.host,
-                                 header.host_end - header.host);
+    TEST_ASSERT_EQUAL(addr_len, header.host.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("127.0.0.1", header.host.data,
+                                 header.host.len);
 
-    TEST_ASSERT_EQUAL(port_len, header.port_end - header.port);
-    TEST_ASSERT_EQUAL_STRING_LEN("5500", header.port,
-                                 header.port_end - header.port);
+    TEST_ASSERT_EQUAL(port_len, header.port.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("5500", header.port.data,
+                                 header.port.len);
 
     TEST_PASS_MESSAGE("Loopback with wrong port host test passed");
 }
@@ -261,13 +258,13 @@ TEST(RX_REQUEST_HOST_HEADER, BroadcastWithWrongPortHostTest)
     TEST_ASSERT_EQUAL_INT(RX_REQUEST_HEADER_HOST_RESULT_UNSUPPORTED,
                           header.result);
 
-    TEST_ASSERT_EQUAL(addr_len, header.host_end - header.host);
-    TEST_ASSERT_EQUAL_STRING_LEN("0.0.0.0", header.host,
-                                 header.host_end - header.host);
+    TEST_ASSERT_EQUAL(addr_len, header.host.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("0.0.0.0", header.host.data,
+                                 header.host.len);
 
-    TEST_ASSERT_EQUAL(port_len, header.port_end - header.port);
-    TEST_ASSERT_EQUAL_STRING_LEN("9999", header.port,
-                                 header.port_end - header.port);
+    TEST_ASSERT_EQUAL(port_len, header.port.len);
+    TEST_ASSERT_EQUAL_STRING_LEN("9999", header.port.data,
+                                 header.port.len);
 
     TEST_PASS_MESSAGE("Broadcast with wrong port host test passed");
 }
@@ -0,0 +1,132 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+#define RX_TEST_MPSC_THREADS 4
+#define RX_TEST_MPSC_NODES   10000
+
+static struct rx_mpsc queue;
+static struct rx_mpsc_node nodes[RX_TEST_MPSC_THREADS][RX_TEST_MPSC_NODES];
+
+static void *
+rx_test_mpsc_producer(void *arg)
+{
+    struct rx_mpsc_node *own = arg;
+
+    for (size_t i = 0; i < RX_TEST_MPSC_NODES; i++)
+    {
+        rx_mpsc_push(&queue, &own[i]);
+    }
+
+    return NULL;
+}
+
+TEST_GROUP(RX_MPSC);
+
+TEST_SETUP(RX_MPSC)
+{
+    rx_mpsc_init(&queue);
+}
+
+TEST_TEAR_DOWN(RX_MPSC)
+{
+}
+
+TEST(RX_MPSC, EmptyTest)
+{
+    TEST_ASSERT_NULL(rx_mpsc_take(&queue));
+}
+
+TEST(RX_MPSC, PushReportsEmptyTest)
+{
+    TEST_ASSERT_EQUAL_INT(1, rx_mpsc_push(&queue, &nodes[0][0]));
+    TEST_ASSERT_EQUAL_INT(0, rx_mpsc_push(&queue, &nodes[0][1]));
+
+    (void)rx_mpsc_take(&queue);
+
+    TEST_ASSERT_EQUAL_INT(1, rx_mpsc_push(&queue, &nodes[0][2]));
+}
+
+TEST(RX_MPSC, FifoOrderTest)
+{
+    struct rx_mpsc_node *node;
+    size_t i;
+
+    for (i = 0; i < 5; i++)
+    {
+        rx_mpsc_push(&queue, &nodes[0][i]);
+    }
+
+    node = rx_mpsc_take(&queue);
+
+    for (i = 0; i < 5; i++, node = node->next)
+    {
+        TEST_ASSERT_EQUAL_PTR(&nodes[0][i], node);
+    }
+
+    TEST_ASSERT_NULL(node);
+    TEST_ASSERT_NULL(rx_mpsc_take(&queue));
+}
+
+TEST(RX_MPSC, ConcurrentPushTest)
+{
+    pthread_t threads[RX_TEST_MPSC_THREADS];
+    struct rx_mpsc_node *node;
+    size_t i, count = 0;
+
+    for (i = 0; i < RX_TEST_MPSC_THREADS; i++)
+    {
+        pthread_create(&threads[i], NULL, rx_test_mpsc_producer, nodes[i]);
+    }
+
+    /* Take from the queue while the producers are still pushing */
+
+    while (count < RX_TEST_MPSC_THREADS * RX_TEST_MPSC_NODES)
+    {
+        for (node = rx_mpsc_take(&queue); node != NULL; node = node->next)
+        {
+            count++;
+        }
+    }
+
+    for (i = 0; i < RX_TEST_MPSC_THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    TEST_ASSERT_EQUAL_size_t(RX_TEST_MPSC_THREADS * RX_TEST_MPSC_NODES, count);
+    TEST_ASSERT_NULL(rx_mpsc_take(&queue));
+}
+
+TEST_GROUP_RUNNER(RX_MPSC)
+{
+    RUN_TEST_CASE(RX_MPSC, EmptyTest);
+    RUN_TEST_CASE(RX_MPSC, PushReportsEmptyTest);
+    RUN_TEST_CASE(RX_MPSC, FifoOrderTest);
+    RUN_TEST_CASE(RX_MPSC, ConcurrentPushTest);
+}
@@ -0,0 +1,218 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static struct rx_slab slab;
+static struct rx_buffer_pool pool;
+static struct rx_event_loop loop;
+
+TEST_GROUP(RX_POOL);
+
+TEST_SETUP(RX_POOL)
+{
+    rx_slab_init(&slab, 24);
+    rx_buffer_pool_init(&pool);
+    rx_buffer_pool_init(&loop.buffers);
+}
+
+TEST_TEAR_DOWN(RX_POOL)
+{
+    rx_slab_destroy(&slab);
+    rx_buffer_pool_destroy(&pool);
+    rx_buffer_pool_destroy(&loop.buffers);
+}
+
+TEST(RX_POOL, SlabReuseTest)
+{
+    void *a = rx_slab_alloc(&slab);
+    void *b = rx_slab_alloc(&slab);
+
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_TRUE(a != b);
+    TEST_ASSERT_EQUAL_size_t(2, slab.nused);
+
+    rx_slab_free(&slab, a);
+    TEST_ASSERT_EQUAL_size_t(1, slab.nused);
+    TEST_ASSERT_EQUAL_PTR(a, rx_slab_alloc(&slab));
+}
+
+TEST(RX_POOL, SlabAlignmentTest)
+{
+    TEST_ASSERT_EQUAL_size_t(0, slab.size % _Alignof(max_align_t));
+    TEST_ASSERT_TRUE(slab.size >= 24);
+
+    for (size_t i = 0; i < 3 * RX_SLAB_CHUNK_OBJECTS; ++i)
+    {
+        void *obj = rx_slab_alloc(&slab);
+
+        TEST_ASSERT_NOT_NULL(obj);
+        TEST_ASSERT_EQUAL_size_t(0, (uintptr_t)obj % _Alignof(max_align_t));
+
+        memset(obj, 0xff, 24);
+    }
+
+    TEST_ASSERT_EQUAL_size_t(3 * RX_SLAB_CHUNK_OBJECTS, slab.nused);
+}
+
+TEST(RX_POOL, BufferClassTest)
+{
+    size_t cap;
+    char *buf;
+
+    buf = rx_buffer_pool_get(&pool, 1, &cap);
+    TEST_ASSERT_NOT_NULL(buf);
+    TEST_ASSERT_EQUAL_size_t(4096, cap);
+    rx_buffer_pool_put(&pool, buf, cap);
+
+    buf = rx_buffer_pool_get(&pool, 4097, &cap);
+    TEST_ASSERT_NOT_NULL(buf);
+    TEST_ASSERT_EQUAL_size_t(16384, cap);
+    rx_buffer_pool_put(&pool, buf, cap);
+
+    buf = rx_buffer_pool_get(
+        &pool, RX_HEADER_BUFFER_SIZE + RX_BODY_BUFFER_SIZE + 1, &cap
+    );
+    TEST_ASSERT_NOT_NULL(buf);
+    TEST_ASSERT_EQUAL_size_t(
+        RX_HEADER_BUFFER_SIZE + RX_BODY_BUFFER_SIZE + 1, cap
+    );
+    rx_buffer_pool_put(&pool, buf, cap);
+
+    buf = rx_buffer_pool_get(
+        &pool, RX_HEADER_BUFFER_SIZE + RX_BODY_BUFFER_SIZE + 2, &cap
+    );
+    TEST_ASSERT_NULL(buf);
+}
+
+TEST(RX_POOL, BufferReuseTest)
+{
+    size_t cap;
+    char *a, *b;
+
+    a = rx_buffer_pool_get(&pool, 100, &cap);
+    rx_buffer_pool_put(&pool, a, cap);
+    TEST_ASSERT_EQUAL_size_t(1, pool.classes[0].nfree);
+
+    b = rx_buffer_pool_get(&pool, 200, &cap);
+    TEST_ASSERT_EQUAL_PTR(a, b);
+    TEST_ASSERT_EQUAL_size_t(0, pool.classes[0].nfree);
+    rx_buffer_pool_put(&pool, b, cap);
+}
+
+TEST(RX_POOL, BufferMaxFreeTest)
+{
+    struct rx_buffer_class *class = &pool.classes[RX_BUFFER_POOL_CLASSES - 1];
+    char *bufs[8];
+    size_t cap;
+
+    TEST_ASSERT_TRUE(class->max_free < 8);
+
+    for (size_t i = 0; i < 8; ++i)
+    {
+        bufs[i] = rx_buffer_pool_get(&pool, class->size, &cap);
+        TEST_ASSERT_NOT_NULL(bufs[i]);
+    }
+
+    for (size_t i = 0; i < 8; ++i)
+    {
+        rx_buffer_pool_put(&pool, bufs[i], cap);
+    }
+
+    TEST_ASSERT_EQUAL_size_t(class->max_free, class->nfree);
+}
+
+TEST(RX_POOL, ConnectionBufferGrowTest)
+{
+    struct rx_connection conn;
+    const char *header = "POST / HTTP/1.1\r\nContent-Length: 10000\r\n\r\n";
+    size_t len         = strlen(header);
+
+    memset(&conn, 0, sizeof(conn));
+    conn.loop = &loop;
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_reserve(&conn, len));
+    TEST_ASSERT_EQUAL_size_t(4096, conn.buffer_cap);
+
+    memcpy(conn.buffer_end, header, len);
+    conn.buffer_end += len;
+    *conn.buffer_end = '\0';
+
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_connection_find_request(&conn));
+    TEST_ASSERT_EQUAL_size_t(10000, conn.content_length);
+
+    /* The buffer grows to hold the whole body at once */
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_reserve(&conn, 4096));
+    TEST_ASSERT_EQUAL_size_t(16384, conn.buffer_cap);
+    TEST_ASSERT_EQUAL_PTR(conn.buffer_start, conn.request_start);
+    TEST_ASSERT_EQUAL_PTR(conn.buffer_start + len, conn.body_start);
+    TEST_ASSERT_EQUAL_STRING(header, conn.buffer_start);
+
+    memset(conn.buffer_end, 'a', 10000);
+    conn.buffer_end += 10000;
+    *conn.buffer_end = '\0';
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_connection_find_request(&conn));
+
+    /* A buffer with unprocessed bytes is kept */
+    rx_connection_release_buffer(&conn);
+    TEST_ASSERT_NOT_NULL(conn.buffer_start);
+
+    conn.buffer_end = conn.buffer_start;
+    rx_connection_release_buffer(&conn);
+    TEST_ASSERT_NULL(conn.buffer_start);
+    TEST_ASSERT_EQUAL_size_t(1, loop.buffers.classes[1].nfree);
+
+    rx_arena_destroy(&conn.arena);
+}
+
+TEST(RX_POOL, ConnectionBufferOverflowTest)
+{
+    struct rx_connection conn;
+
+    memset(&conn, 0, sizeof(conn));
+    conn.loop = &loop;
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_ERROR, rx_connection_reserve(
+                      &conn, RX_HEADER_BUFFER_SIZE + RX_BODY_BUFFER_SIZE + 1
+                  )
+    );
+    TEST_ASSERT_NULL(conn.buffer_start);
+}
+
+TEST_GROUP_RUNNER(RX_POOL)
+{
+    RUN_TEST_CASE(RX_POOL, SlabReuseTest);
+    RUN_TEST_CASE(RX_POOL, SlabAlignmentTest);
+    RUN_TEST_CASE(RX_POOL, BufferClassTest);
+    RUN_TEST_CASE(RX_POOL, BufferReuseTest);
+    RUN_TEST_CASE(RX_POOL, BufferMaxFreeTest);
+    RUN_TEST_CASE(RX_POOL, ConnectionBufferGrowTest);
+    RUN_TEST_CASE(RX_POOL, ConnectionBufferOverflowTest);
+}
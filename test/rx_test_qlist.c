@@ -51,7 +51,7 @@ TEST_TEAR_DOWN(RX_QLIST)
 
 TEST(RX_QLIST, InitializeQListTest)
 {
-    int ret = rx_qlist_create(&qlist);
+    int ret = rx_qlist_create(&qlist, NULL);
 
     TEST_ASSERT_EQUAL_INT(RX_OK, ret);
     TEST_ASSERT_EQUAL_INT(0, qlist.size);
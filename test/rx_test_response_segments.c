@@ -0,0 +1,160 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static struct rx_arena arena;
+static struct rx_response res;
+static char content[] = "0123456789";
+
+TEST_GROUP(RX_RESPONSE_SEGMENTS);
+
+TEST_SETUP(RX_RESPONSE_SEGMENTS)
+{
+    rx_arena_init(&arena);
+    rx_response_init(&res, &arena);
+
+    res.status_code    = RX_HTTP_STATUS_CODE_OK;
+    res.content        = content;
+    res.content_length = sizeof(content) - 1;
+    res.content_type   = RX_HTTP_MIME_TEXT_PLAIN;
+}
+
+TEST_TEAR_DOWN(RX_RESPONSE_SEGMENTS)
+{
+    rx_response_destroy(&res);
+    rx_arena_destroy(&arena);
+}
+
+TEST(RX_RESPONSE_SEGMENTS, ContentNotCopiedTest)
+{
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_response_construct(&res));
+    TEST_ASSERT_EQUAL_size_t(2, res.nsegments);
+    TEST_ASSERT_EQUAL_size_t(0, res.segment);
+    TEST_ASSERT_EQUAL_PTR(content, res.segments[1].iov_base);
+    TEST_ASSERT_EQUAL_size_t(10, res.segments[1].iov_len);
+    TEST_ASSERT_EQUAL_MEMORY(
+        "HTTP/1.1 200 OK\r\n", res.segments[0].iov_base, 17
+    );
+}
+
+TEST(RX_RESPONSE_SEGMENTS, NoContentTest)
+{
+    res.content = NULL;
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_response_construct(&res));
+    TEST_ASSERT_EQUAL_size_t(1, res.nsegments);
+}
+
+TEST(RX_RESPONSE_SEGMENTS, AdvanceTest)
+{
+    size_t header_len;
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_response_construct(&res));
+    header_len = res.segments[0].iov_len;
+
+    /* Part of the header block */
+    TEST_ASSERT_EQUAL_size_t(5, rx_response_advance(&res, 5));
+    TEST_ASSERT_EQUAL_size_t(0, res.segment);
+    TEST_ASSERT_EQUAL_size_t(header_len - 5, res.segments[0].iov_len);
+
+    /* The rest of the header block and part of the content */
+    TEST_ASSERT_EQUAL_size_t(
+        header_len - 5 + 4, rx_response_advance(&res, header_len - 5 + 4)
+    );
+    TEST_ASSERT_EQUAL_size_t(1, res.segment);
+    TEST_ASSERT_EQUAL_PTR(content + 4, res.segments[1].iov_base);
+
+    /* Bytes beyond the end belong to the next response */
+    TEST_ASSERT_EQUAL_size_t(6, rx_response_advance(&res, 100));
+    TEST_ASSERT_TRUE(rx_response_is_sent(&res));
+}
+
+TEST(RX_RESPONSE_SEGMENTS, FileContentTest)
+{
+    size_t header_len;
+
+    res.content    = NULL;
+    res.content_fd = open("/dev/null", O_RDONLY);
+    TEST_ASSERT_NOT_EQUAL(-1, res.content_fd);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_response_construct(&res));
+    TEST_ASSERT_EQUAL_size_t(1, res.nsegments);
+    header_len = res.segments[0].iov_len;
+
+    /* Bytes after the header block are taken from the file */
+    TEST_ASSERT_EQUAL_size_t(
+        header_len + 4, rx_response_advance(&res, header_len + 4)
+    );
+    TEST_ASSERT_EQUAL_INT(4, (int)res.content_offset);
+    TEST_ASSERT_FALSE(rx_response_is_sent(&res));
+
+    TEST_ASSERT_EQUAL_size_t(6, rx_response_advance(&res, 100));
+    TEST_ASSERT_TRUE(rx_response_is_sent(&res));
+}
+
+TEST(RX_RESPONSE_SEGMENTS, UnavailableTest)
+{
+    const char *buf, *body;
+    size_t len;
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_response_construct(&res));
+
+    rx_response_unavailable(&res);
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_HTTP_STATUS_CODE_SERVICE_UNAVAILABLE, res.status_code
+    );
+    TEST_ASSERT_EQUAL_INT(0, res.keep_alive);
+    TEST_ASSERT_EQUAL_size_t(1, res.nsegments);
+    TEST_ASSERT_EQUAL_size_t(0, res.segment);
+
+    buf = res.segments[0].iov_base;
+    len = res.segments[0].iov_len;
+
+    TEST_ASSERT_EQUAL_MEMORY(
+        "HTTP/1.1 503 Service Unavailable\r\n", buf, 34
+    );
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\r\nRetry-After: 1\r\n"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\r\nConnection: close\r\n"));
+
+    /* The body is as long as the header says */
+    body = strstr(buf, "\r\n\r\n") + 4;
+    TEST_ASSERT_EQUAL_size_t(20, len - (size_t)(body - buf));
+
+    TEST_ASSERT_EQUAL_size_t(len, rx_response_advance(&res, len));
+    TEST_ASSERT_TRUE(rx_response_is_sent(&res));
+}
+
+TEST_GROUP_RUNNER(RX_RESPONSE_SEGMENTS)
+{
+    RUN_TEST_CASE(RX_RESPONSE_SEGMENTS, ContentNotCopiedTest);
+    RUN_TEST_CASE(RX_RESPONSE_SEGMENTS, NoContentTest);
+    RUN_TEST_CASE(RX_RESPONSE_SEGMENTS, AdvanceTest);
+    RUN_TEST_CASE(RX_RESPONSE_SEGMENTS, FileContentTest);
+    RUN_TEST_CASE(RX_RESPONSE_SEGMENTS, UnavailableTest);
+}
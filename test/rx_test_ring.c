@@ -27,10 +27,18 @@
 #include <rx_config.h>
 #include <rx_core.h>
 
+#define RX_TEST_RING_THREADS 4
+#define RX_TEST_RING_TASKS   100000
+
 static int counter = 0;
 static int *ptr;
 struct rx_ring ring;
 
+/* Tasks pushed by the stress tests, and how many times each was popped */
+static struct rx_task stress_tasks[RX_TEST_RING_THREADS][RX_TEST_RING_TASKS];
+static _Atomic int stress_popped[RX_TEST_RING_THREADS][RX_TEST_RING_TASKS];
+static _Atomic size_t stress_total;
+
 static void *
 counter_handler(void *arg)
 {
@@ -49,6 +57,49 @@ counter_handler_with_arg(void *arg)
     return _ptr;
 }
 
+static void *
+stress_producer(void *arg)
+{
+    struct rx_task *tasks = arg;
+
+    for (size_t i = 0; i < RX_TEST_RING_TASKS; i++)
+    {
+        while (rx_ring_push(&ring, &tasks[i]) != RX_OK)
+        {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static void *
+stress_consumer(void *arg)
+{
+    struct rx_task *task;
+    size_t id, index;
+
+    NOOP(arg);
+
+    while (atomic_load(&stress_total) <
+           RX_TEST_RING_THREADS * RX_TEST_RING_TASKS)
+    {
+        if ((task = rx_ring_pop(&ring)) == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+
+        id    = (size_t)(uintptr_t)task->arg;
+        index = task - stress_tasks[id];
+
+        atomic_fetch_add(&stress_popped[id][index], 1);
+        atomic_fetch_add(&stress_total, 1);
+    }
+
+    return NULL;
+}
+
 TEST_GROUP(RX_RING);
 
 TEST_SETUP(RX_RING)
@@ -66,26 +117,22 @@ TEST(RX_RING, AddTaskToRingTest)
 
     task->handle = NULL;
     task->arg    = NULL;
-    rx_ring_push(&ring, task);
 
-    TEST_ASSERT_EQUAL(1, ring.size);
-    TEST_ASSERT_EQUAL(0, ring.out);
-    TEST_ASSERT_EQUAL(1, ring.in);
+    TEST_ASSERT_EQUAL(RX_OK, rx_ring_push(&ring, task));
+    TEST_ASSERT_EQUAL(1, rx_ring_size(&ring));
+    TEST_ASSERT_EQUAL_PTR(task, ring.cells[0].task);
 
-    TEST_ASSERT_EQUAL_PTR(task, ring.tasks[0]);
     TEST_PASS_MESSAGE("Add task to ring test passed");
 }
 
 TEST(RX_RING, RemoveTaskFromRingTest)
 {
-    TEST_ASSERT_EQUAL(1, ring.size);
+    TEST_ASSERT_EQUAL(1, rx_ring_size(&ring));
 
     struct rx_task *task = rx_ring_pop(&ring);
 
-    TEST_ASSERT_EQUAL(0, ring.size);
-    TEST_ASSERT_EQUAL(1, ring.out);
-    TEST_ASSERT_EQUAL(1, ring.in);
-    TEST_ASSERT_NULL(ring.tasks[0]);
+    TEST_ASSERT_EQUAL(0, rx_ring_size(&ring));
+    TEST_ASSERT_NULL(ring.cells[0].task);
     TEST_ASSERT_NOT_NULL(task);
 
     TEST_ASSERT_NULL(task->handle);
@@ -98,14 +145,11 @@ TEST(RX_RING, RemoveTaskFromRingTest)
 
 TEST(RX_RING, RemoveTaskFromEmptyRingTest)
 {
-    TEST_ASSERT_EQUAL(0, ring.size);
+    TEST_ASSERT_EQUAL(0, rx_ring_size(&ring));
 
     struct rx_task *task = rx_ring_pop(&ring);
 
-    TEST_ASSERT_EQUAL(0, ring.size);
-    TEST_ASSERT_EQUAL(1, ring.out);
-    TEST_ASSERT_EQUAL(1, ring.in);
-    TEST_ASSERT_NULL(ring.tasks[ring.out]);
+    TEST_ASSERT_EQUAL(0, rx_ring_size(&ring));
     TEST_ASSERT_NULL(task);
 
     TEST_PASS_MESSAGE("Remove task from empty ring test passed");
@@ -113,34 +157,34 @@ TEST(RX_RING, RemoveTaskFromEmptyRingTest)
 
 TEST(RX_RING, AddTaskToFullRingTest)
 {
-    for (size_t i = 0; i < ring.cap; i++)
+    for (size_t i = 0; i < RX_RING_DEFAULT_CAPACITY; i++)
     {
         struct rx_task *task = malloc(sizeof(struct rx_task));
         TEST_ASSERT_NOT_NULL(task);
 
         task->handle = NULL;
         task->arg    = NULL;
-        rx_ring_push(&ring, task);
 
-        TEST_ASSERT_EQUAL(i + 1, ring.size);
-        TEST_ASSERT_EQUAL(1, ring.out);
-        TEST_ASSERT_EQUAL((i + 2) % ring.cap, ring.in);
+        TEST_ASSERT_EQUAL(RX_OK, rx_ring_push(&ring, task));
+        TEST_ASSERT_EQUAL(i + 1, rx_ring_size(&ring));
 
-        TEST_ASSERT_EQUAL_PTR(task, ring.tasks[(i + 1) % ring.cap]);
+        /* The ring starts at the second slot after the first tests */
+        TEST_ASSERT_EQUAL_PTR(
+            task, ring.cells[(i + 1) % RX_RING_DEFAULT_CAPACITY].task
+        );
     }
 
-    TEST_ASSERT_EQUAL(ring.cap, ring.size);
+    TEST_ASSERT_EQUAL(RX_RING_DEFAULT_CAPACITY, rx_ring_size(&ring));
 
     struct rx_task *task = malloc(sizeof(struct rx_task));
     TEST_ASSERT_NOT_NULL(task);
 
     task->handle = NULL;
     task->arg    = NULL;
-    rx_ring_push(&ring, task);
 
-    TEST_ASSERT_EQUAL(ring.cap, ring.size);
-    TEST_ASSERT_EQUAL(1, ring.out);
-    TEST_ASSERT_EQUAL(1, ring.in);
+    /* A full ring refuses the task instead of dropping it silently */
+    TEST_ASSERT_EQUAL(RX_AGAIN, rx_ring_push(&ring, task));
+    TEST_ASSERT_EQUAL(RX_RING_DEFAULT_CAPACITY, rx_ring_size(&ring));
 
     free(task);
 
@@ -149,12 +193,13 @@ TEST(RX_RING, AddTaskToFullRingTest)
 
 TEST(RX_RING, SetEmptyRingTest)
 {
-    for (size_t i = 0; i < ring.cap; i++)
+    for (size_t i = 0; i < RX_RING_DEFAULT_CAPACITY; i++)
     {
         struct rx_task *task = rx_ring_pop(&ring);
 
-        TEST_ASSERT_EQUAL(ring.cap - i - 1, ring.size);
-        TEST_ASSERT_EQUAL((i + 2) % ring.cap, ring.out);
+        TEST_ASSERT_EQUAL(
+            RX_RING_DEFAULT_CAPACITY - i - 1, rx_ring_size(&ring)
+        );
 
         TEST_ASSERT_NOT_NULL(task);
         TEST_ASSERT_NULL(task->handle);
@@ -163,13 +208,11 @@ TEST(RX_RING, SetEmptyRingTest)
         free(task);
     }
 
-    TEST_ASSERT_EQUAL(0, ring.size);
-    TEST_ASSERT_EQUAL(1, ring.out);
-    TEST_ASSERT_EQUAL(1, ring.in);
+    TEST_ASSERT_EQUAL(0, rx_ring_size(&ring));
+    TEST_ASSERT_NULL(rx_ring_pop(&ring));
 
-    ring.size = 0;
-    ring.out  = 0;
-    ring.in   = 0;
+    rx_ring_destroy(&ring);
+    rx_ring_init(&ring, RX_RING_DEFAULT_CAPACITY);
 
     TEST_PASS_MESSAGE("Set empty ring test passed");
 }
@@ -181,13 +224,11 @@ TEST(RX_RING, AddTaskWithHandlerToRingTest)
 
     task->handle = counter_handler;
     task->arg    = NULL;
-    rx_ring_push(&ring, task);
 
-    TEST_ASSERT_EQUAL(1, ring.size);
-    TEST_ASSERT_EQUAL(0, ring.out);
-    TEST_ASSERT_EQUAL(1, ring.in);
+    TEST_ASSERT_EQUAL(RX_OK, rx_ring_push(&ring, task));
+    TEST_ASSERT_EQUAL(1, rx_ring_size(&ring));
+    TEST_ASSERT_EQUAL_PTR(task, ring.cells[0].task);
 
-    TEST_ASSERT_EQUAL_PTR(task, ring.tasks[0]);
     TEST_PASS_MESSAGE("Add task with handler to ring test passed");
 }
 
@@ -195,7 +236,7 @@ TEST(RX_RING, RemoveTaskWithHandlerToRingTest)
 {
     struct rx_task *task = rx_ring_pop(&ring);
 
-    TEST_ASSERT_EQUAL(0, ring.size);
+    TEST_ASSERT_EQUAL(0, rx_ring_size(&ring));
     TEST_ASSERT_NOT_NULL(task);
     TEST_ASSERT_NOT_NULL(task->handle);
     TEST_ASSERT_NULL(task->arg);
@@ -206,9 +247,8 @@ TEST(RX_RING, RemoveTaskWithHandlerToRingTest)
 
     free(task);
 
-    ring.size = 0;
-    ring.in   = 0;
-    ring.out  = 0;
+    rx_ring_destroy(&ring);
+    rx_ring_init(&ring, RX_RING_DEFAULT_CAPACITY);
 
     TEST_PASS_MESSAGE("Remove task with handler from ring test passed");
 }
@@ -220,21 +260,19 @@ TEST(RX_RING, AddTaskWithArgumentToRingTest)
 
     task1->handle = counter_handler_with_arg;
     task1->arg    = ptr;
-    rx_ring_push(&ring, task1);
+    TEST_ASSERT_EQUAL(RX_OK, rx_ring_push(&ring, task1));
 
     struct rx_task *task2 = malloc(sizeof(struct rx_task));
     TEST_ASSERT_NOT_NULL(task2);
 
     task2->handle = counter_handler_with_arg;
     task2->arg    = ptr;
-    rx_ring_push(&ring, task2);
+    TEST_ASSERT_EQUAL(RX_OK, rx_ring_push(&ring, task2));
 
-    TEST_ASSERT_EQUAL(2, ring.size);
-    TEST_ASSERT_EQUAL(0, ring.out);
-    TEST_ASSERT_EQUAL(2, ring.in);
+    TEST_ASSERT_EQUAL(2, rx_ring_size(&ring));
 
-    TEST_ASSERT_EQUAL_PTR(task1, ring.tasks[0]);
-    TEST_ASSERT_EQUAL_PTR(task2, ring.tasks[1]);
+    TEST_ASSERT_EQUAL_PTR(task1, ring.cells[0].task);
+    TEST_ASSERT_EQUAL_PTR(task2, ring.cells[1].task);
 
     TEST_PASS_MESSAGE("Add tasks with argument to ring test passed");
 }
@@ -255,9 +293,7 @@ TEST(RX_RING, RemoveTaskWithArgumentFromRingTest)
     TEST_ASSERT_NOT_NULL(ret);
     TEST_ASSERT_EQUAL(1, *ret);
 
-    TEST_ASSERT_EQUAL(1, ring.size);
-    TEST_ASSERT_EQUAL(1, ring.out);
-    TEST_ASSERT_EQUAL(2, ring.in);
+    TEST_ASSERT_EQUAL(1, rx_ring_size(&ring));
 
     free(task1);
 
@@ -274,18 +310,151 @@ TEST(RX_RING, RemoveTaskWithArgumentFromRingTest)
     TEST_ASSERT_NOT_NULL(ret);
     TEST_ASSERT_EQUAL(2, *ret);
 
-    TEST_ASSERT_EQUAL(0, ring.size);
-    TEST_ASSERT_EQUAL(2, ring.out);
-    TEST_ASSERT_EQUAL(2, ring.in);
+    TEST_ASSERT_EQUAL(0, rx_ring_size(&ring));
 
     free(task2);
 
     TEST_PASS_MESSAGE("Remove tasks with argument from ring test passed");
 }
 
+TEST(RX_RING, WrapAroundTest)
+{
+    struct rx_task task;
+
+    /* Many laps over the slots keep the order and the sequence numbers */
+
+    for (size_t i = 0; i < RX_RING_DEFAULT_CAPACITY * 10; i++)
+    {
+        TEST_ASSERT_EQUAL(RX_OK, rx_ring_push(&ring, &task));
+        TEST_ASSERT_EQUAL_PTR(&task, rx_ring_pop(&ring));
+    }
+
+    TEST_ASSERT_NULL(rx_ring_pop(&ring));
+}
+
+TEST(RX_RING, ConcurrentStressTest)
+{
+    pthread_t producers[RX_TEST_RING_THREADS];
+    pthread_t consumers[RX_TEST_RING_THREADS];
+    size_t i, j;
+
+    rx_ring_destroy(&ring);
+    rx_ring_init(&ring, RX_RING_DEFAULT_CAPACITY);
+    atomic_init(&stress_total, 0);
+
+    for (i = 0; i < RX_TEST_RING_THREADS; i++)
+    {
+        for (j = 0; j < RX_TEST_RING_TASKS; j++)
+        {
+            stress_tasks[i][j].arg = (void *)(uintptr_t)i;
+            atomic_init(&stress_popped[i][j], 0);
+        }
+    }
+
+    for (i = 0; i < RX_TEST_RING_THREADS; i++)
+    {
+        pthread_create(&consumers[i], NULL, stress_consumer, NULL);
+        pthread_create(&producers[i], NULL, stress_producer, stress_tasks[i]);
+    }
+
+    for (i = 0; i < RX_TEST_RING_THREADS; i++)
+    {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+    }
+
+    /* Every task has been popped exactly once */
+
+    TEST_ASSERT_EQUAL_size_t(
+        RX_TEST_RING_THREADS * RX_TEST_RING_TASKS, atomic_load(&stress_total)
+    );
+
+    for (i = 0; i < RX_TEST_RING_THREADS; i++)
+    {
+        for (j = 0; j < RX_TEST_RING_TASKS; j++)
+        {
+            TEST_ASSERT_EQUAL_INT(1, atomic_load(&stress_popped[i][j]));
+        }
+    }
+
+    TEST_ASSERT_EQUAL(0, rx_ring_size(&ring));
+    TEST_ASSERT_NULL(rx_ring_pop(&ring));
+}
+
+TEST(RX_RING, ConcurrentFullRingTest)
+{
+    pthread_t producers[RX_TEST_RING_THREADS];
+    size_t i, n = 0;
+
+    /* A small ring keeps the producers running into each other */
+    rx_ring_destroy(&ring);
+    rx_ring_init(&ring, 8);
+
+    /* Producers racing on a ring that is too small for all of them: every
+       push either succeeds or reports the ring as full */
+
+    for (i = 0; i < RX_TEST_RING_THREADS; i++)
+    {
+        pthread_create(&producers[i], NULL, stress_producer, stress_tasks[i]);
+    }
+
+    while (n < RX_TEST_RING_THREADS * RX_TEST_RING_TASKS)
+    {
+        if (rx_ring_pop(&ring) != NULL)
+        {
+            n++;
+        }
+        else
+        {
+            TEST_ASSERT_TRUE(rx_ring_size(&ring) <= rx_ring_capacity(&ring));
+
+            /* A producer may have claimed a slot without filling it yet,
+               and on a single CPU it only gets to do so if this thread lets
+               it run */
+            sched_yield();
+        }
+    }
+
+    for (i = 0; i < RX_TEST_RING_THREADS; i++)
+    {
+        pthread_join(producers[i], NULL);
+    }
+
+    TEST_ASSERT_NULL(rx_ring_pop(&ring));
+}
+
+TEST(RX_RING, RoundCapacityTest)
+{
+    struct rx_task task;
+    struct rx_ring small;
+    size_t i;
+
+    TEST_ASSERT_EQUAL(RX_OK, rx_ring_init(&small, 100));
+    TEST_ASSERT_EQUAL(128, rx_ring_capacity(&small));
+
+    for (i = 0; i < 128; i++)
+    {
+        TEST_ASSERT_EQUAL(RX_OK, rx_ring_push(&small, &task));
+    }
+
+    TEST_ASSERT_EQUAL(RX_AGAIN, rx_ring_push(&small, &task));
+
+    rx_ring_destroy(&small);
+
+    TEST_ASSERT_EQUAL(RX_OK, rx_ring_init(&small, 1));
+    TEST_ASSERT_EQUAL(2, rx_ring_capacity(&small));
+    TEST_ASSERT_EQUAL(RX_OK, rx_ring_push(&small, &task));
+    TEST_ASSERT_EQUAL(RX_OK, rx_ring_push(&small, &task));
+    TEST_ASSERT_EQUAL(RX_AGAIN, rx_ring_push(&small, &task));
+    TEST_ASSERT_EQUAL_PTR(&task, rx_ring_pop(&small));
+    TEST_ASSERT_EQUAL(RX_OK, rx_ring_push(&small, &task));
+
+    rx_ring_destroy(&small);
+}
+
 TEST_GROUP_RUNNER(RX_RING)
 {
-    rx_ring_init(&ring);
+    rx_ring_init(&ring, RX_RING_DEFAULT_CAPACITY);
     ptr  = malloc(sizeof(int));
     *ptr = 0;
 
@@ -298,6 +467,11 @@ TEST_GROUP_RUNNER(RX_RING)
     RUN_TEST_CASE(RX_RING, RemoveTaskWithHandlerToRingTest);
     RUN_TEST_CASE(RX_RING, AddTaskWithArgumentToRingTest);
     RUN_TEST_CASE(RX_RING, RemoveTaskWithArgumentFromRingTest);
+    RUN_TEST_CASE(RX_RING, WrapAroundTest);
+    RUN_TEST_CASE(RX_RING, ConcurrentStressTest);
+    RUN_TEST_CASE(RX_RING, ConcurrentFullRingTest);
+    RUN_TEST_CASE(RX_RING, RoundCapacityTest);
 
+    rx_ring_destroy(&ring);
     free(ptr);
 }
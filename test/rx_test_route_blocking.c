@@ -0,0 +1,157 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static struct rx_connection conn;
+static struct rx_tokens tokens;
+static char buffer[256];
+
+/* Point the connection at a request whose header is complete */
+static rx_workload_t
+rx_test_workload(const char *request)
+{
+    strcpy(buffer, request);
+    rx_tokenizer_reset(&tokens);
+    (void)rx_tokenize(&tokens, buffer, strlen(buffer));
+
+    conn.request_start = buffer;
+    conn.header_end    = strstr(buffer, "\r\n\r\n");
+    conn.tokens        = &tokens;
+
+    return rx_connection_workload(&conn);
+}
+
+TEST_GROUP(RX_ROUTE_BLOCKING);
+
+TEST_SETUP(RX_ROUTE_BLOCKING)
+{
+    memset(&conn, 0, sizeof(conn));
+}
+
+TEST_TEAR_DOWN(RX_ROUTE_BLOCKING)
+{
+}
+
+TEST(RX_ROUTE_BLOCKING, RouteTest)
+{
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_PAGES,
+        rx_route_workload(RX_REQUEST_METHOD_GET, "/about", 6)
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_AUTH,
+        rx_route_workload(RX_REQUEST_METHOD_POST, "/login", 6)
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_LOOP,
+        rx_route_workload(RX_REQUEST_METHOD_GET, "/public/a.css", 13)
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_LOOP,
+        rx_route_workload(RX_REQUEST_METHOD_HEAD, "/public/a.css", 13)
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_LOOP,
+        rx_route_workload(RX_REQUEST_METHOD_GET, "/stats", 6)
+    );
+}
+
+TEST(RX_ROUTE_BLOCKING, DemoRouteTest)
+{
+    struct rx_route route;
+    int demo_routes = rx_core_opts.demo_routes;
+
+    rx_core_opts.demo_routes = 0;
+    TEST_ASSERT_EQUAL_INT(RX_ERROR, rx_route_get(&route, "/stats", 6));
+
+    rx_core_opts.demo_routes = 1;
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_route_get(&route, "/stats", 6));
+    TEST_ASSERT_EQUAL_INT(1, route.demo);
+
+    rx_core_opts.demo_routes = demo_routes;
+}
+
+TEST(RX_ROUTE_BLOCKING, ClientErrorTest)
+{
+    /* No route (404) and no handler (405) */
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_LOOP, rx_route_workload(RX_REQUEST_METHOD_GET, "/nope", 5)
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_LOOP,
+        rx_route_workload(RX_REQUEST_METHOD_DELETE, "/about", 6)
+    );
+}
+
+TEST(RX_ROUTE_BLOCKING, RequestLineTest)
+{
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_PAGES, rx_test_workload("GET / HTTP/1.1\r\nHost: a\r\n\r\n")
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_PAGES,
+        rx_test_workload("GET /about?a=1 HTTP/1.1\r\nHost: a\r\n\r\n")
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_AUTH,
+        rx_test_workload("POST /login HTTP/1.1\r\nHost: a\r\n\r\n")
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_LOOP,
+        rx_test_workload(
+            "GET /public/css/index.css HTTP/1.1\r\nHost: a\r\n\r\n"
+        )
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_LOOP, rx_test_workload("GARBAGE\r\n\r\n")
+    );
+}
+
+TEST(RX_ROUTE_BLOCKING, EncodedPathTest)
+{
+    /* Paths are matched as they are received, not decoded */
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_LOOP,
+        rx_test_workload("GET /%61bout HTTP/1.1\r\nHost: a\r\n\r\n")
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_WORKLOAD_LOOP,
+        rx_test_workload(
+            "GET /public/css/a%20b.css HTTP/1.1\r\nHost: a\r\n\r\n"
+        )
+    );
+}
+
+TEST_GROUP_RUNNER(RX_ROUTE_BLOCKING)
+{
+    RUN_TEST_CASE(RX_ROUTE_BLOCKING, RouteTest);
+    RUN_TEST_CASE(RX_ROUTE_BLOCKING, DemoRouteTest);
+    RUN_TEST_CASE(RX_ROUTE_BLOCKING, ClientErrorTest);
+    RUN_TEST_CASE(RX_ROUTE_BLOCKING, RequestLineTest);
+    RUN_TEST_CASE(RX_ROUTE_BLOCKING, EncodedPathTest);
+}
@@ -0,0 +1,494 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+#define RX_TEST_THREAD_POOL_TASKS 1000
+
+/* Seconds to wait for the workers before a test gives up */
+#define RX_TEST_THREAD_POOL_WAIT 5
+
+static struct rx_thread_pool pool;
+static struct rx_task tasks[RX_TEST_THREAD_POOL_TASKS];
+static _Atomic int runs[RX_TEST_THREAD_POOL_TASKS];
+static _Atomic int sheds[RX_TEST_THREAD_POOL_TASKS];
+static _Atomic size_t done;
+static _Atomic int gate;
+static _Atomic size_t blocked;
+static _Atomic int holds[2];
+
+static void *
+rx_test_thread_pool_count(void *arg)
+{
+    atomic_fetch_add(&runs[(size_t)(uintptr_t)arg], 1);
+    atomic_fetch_add(&done, 1);
+
+    return RX_OK_PTR;
+}
+
+static void *
+rx_test_thread_pool_shed(void *arg)
+{
+    atomic_fetch_add(&sheds[(size_t)(uintptr_t)arg], 1);
+    atomic_fetch_add(&done, 1);
+
+    return RX_OK_PTR;
+}
+
+static void *
+rx_test_thread_pool_fail(void *arg)
+{
+    NOOP(arg);
+
+    atomic_fetch_add(&done, 1);
+
+    return RX_ERROR_PTR;
+}
+
+/* Hold the worker until the gate `arg` opens */
+static void *
+rx_test_thread_pool_hold(void *arg)
+{
+    _Atomic int *hold = arg;
+
+    atomic_fetch_add(&blocked, 1);
+
+    while (!atomic_load(hold))
+    {
+        sched_yield();
+    }
+
+    atomic_fetch_add(&done, 1);
+
+    return RX_OK_PTR;
+}
+
+static void
+rx_test_thread_pool_sleep(long ms)
+{
+    struct timespec ts = {.tv_sec = ms / 1000, .tv_nsec = ms % 1000 * 1000000};
+
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR)
+    {
+    }
+}
+
+/* Hold the worker until the gate opens */
+static void *
+rx_test_thread_pool_block(void *arg)
+{
+    NOOP(arg);
+
+    atomic_fetch_add(&blocked, 1);
+
+    while (!atomic_load(&gate))
+    {
+        sched_yield();
+    }
+
+    atomic_fetch_add(&done, 1);
+
+    return RX_OK_PTR;
+}
+
+/* Start the pool under test */
+static int
+rx_test_thread_pool_start(size_t nthreads, size_t depth, int affinity)
+{
+    struct rx_thread_pool_config config = {
+        .name     = "test",
+        .nthreads = nthreads,
+        .depth    = depth,
+        .priority = 0,
+        .affinity = affinity,
+        .target   = 0,
+    };
+
+    return rx_thread_pool_init(&pool, &config);
+}
+
+static int
+rx_test_thread_pool_wait(_Atomic size_t *counter, size_t expected)
+{
+    time_t deadline = time(NULL) + RX_TEST_THREAD_POOL_WAIT;
+
+    while (atomic_load(counter) < expected)
+    {
+        if (time(NULL) > deadline)
+        {
+            return RX_ERROR;
+        }
+
+        sched_yield();
+    }
+
+    return RX_OK;
+}
+
+TEST_GROUP(RX_THREAD_POOL);
+
+TEST_SETUP(RX_THREAD_POOL)
+{
+    atomic_init(&done, 0);
+    atomic_init(&gate, 0);
+    atomic_init(&blocked, 0);
+    atomic_init(&holds[0], 0);
+    atomic_init(&holds[1], 0);
+
+    for (size_t i = 0; i < RX_TEST_THREAD_POOL_TASKS; i++)
+    {
+        tasks[i].handle = rx_test_thread_pool_count;
+        tasks[i].arg    = (void *)(uintptr_t)i;
+        tasks[i].shed   = NULL;
+        atomic_init(&runs[i], 0);
+        atomic_init(&sheds[i], 0);
+    }
+}
+
+TEST_TEAR_DOWN(RX_THREAD_POOL)
+{
+    atomic_store(&gate, 1);
+    atomic_store(&holds[0], 1);
+    atomic_store(&holds[1], 1);
+    rx_thread_pool_destroy(&pool);
+}
+
+TEST(RX_THREAD_POOL, RunEveryTaskOnceTest)
+{
+    size_t i;
+
+    TEST_ASSERT_EQUAL(
+        RX_OK, rx_test_thread_pool_start(4, RX_RING_DEFAULT_CAPACITY, 0)
+    );
+
+    for (i = 0; i < RX_TEST_THREAD_POOL_TASKS; i++)
+    {
+        while (rx_thread_pool_submit(&pool, &tasks[i]) != RX_OK)
+        {
+            sched_yield();
+        }
+    }
+
+    TEST_ASSERT_EQUAL(
+        RX_OK, rx_test_thread_pool_wait(&done, RX_TEST_THREAD_POOL_TASKS)
+    );
+
+    for (i = 0; i < RX_TEST_THREAD_POOL_TASKS; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(1, atomic_load(&runs[i]));
+    }
+}
+
+TEST(RX_THREAD_POOL, StealFromBusyWorkerTest)
+{
+    struct rx_task blocker = {
+        .handle = rx_test_thread_pool_block,
+        .arg    = NULL,
+    };
+
+    TEST_ASSERT_EQUAL(
+        RX_OK, rx_test_thread_pool_start(2, RX_RING_DEFAULT_CAPACITY, 0)
+    );
+
+    /* One worker is stuck, yet the tasks queued to it in round-robin order
+       are still run by the other one */
+
+    TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &blocker));
+    TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_wait(&blocked, 1));
+
+    for (size_t i = 0; i < 100; i++)
+    {
+        TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &tasks[i]));
+    }
+
+    TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_wait(&done, 100));
+    TEST_ASSERT_EQUAL(100, atomic_load(&done));
+
+    atomic_store(&gate, 1);
+
+    TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_wait(&done, 101));
+}
+
+TEST(RX_THREAD_POOL, SubmitToFullPoolTest)
+{
+    struct rx_task blockers[2] = {
+        {.handle = rx_test_thread_pool_block, .arg = NULL},
+        {.handle = rx_test_thread_pool_block, .arg = NULL},
+    };
+    size_t i;
+
+    TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_start(2, 16, 0));
+
+    TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &blockers[0]));
+    TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &blockers[1]));
+    TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_wait(&blocked, 2));
+
+    /* With both workers held, the rings fill up and the pool refuses the
+       next task instead of blocking the caller */
+
+    for (i = 0; i < 2 * 16; i++)
+    {
+        TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &tasks[i]));
+    }
+
+    TEST_ASSERT_EQUAL(RX_AGAIN, rx_thread_pool_submit(&pool, &tasks[i]));
+
+    atomic_store(&gate, 1);
+
+    TEST_ASSERT_EQUAL(
+        RX_OK, rx_test_thread_pool_wait(&done, 2 * 16 + 2)
+    );
+    TEST_ASSERT_EQUAL_INT(0, atomic_load(&runs[i]));
+}
+
+TEST(RX_THREAD_POOL, FailedTaskTest)
+{
+    struct rx_task failing = {
+        .handle = rx_test_thread_pool_fail,
+        .arg    = NULL,
+    };
+    size_t i;
+
+    /* The only worker keeps serving after a task fails */
+    TEST_ASSERT_EQUAL(
+        RX_OK, rx_test_thread_pool_start(1, RX_RING_DEFAULT_CAPACITY, 0)
+    );
+
+    for (i = 0; i < 10; i++)
+    {
+        TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &failing));
+        TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_wait(&done, 2 * i + 1));
+
+        TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &tasks[i]));
+        TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_wait(&done, 2 * i + 2));
+        TEST_ASSERT_EQUAL_INT(1, atomic_load(&runs[i]));
+    }
+}
+
+TEST(RX_THREAD_POOL, InitWithoutWorkersTest)
+{
+    TEST_ASSERT_EQUAL(
+        RX_ERROR, rx_test_thread_pool_start(0, RX_RING_DEFAULT_CAPACITY, 0)
+    );
+    TEST_ASSERT_EQUAL(
+        RX_OK, rx_test_thread_pool_start(1, RX_RING_DEFAULT_CAPACITY, 0)
+    );
+}
+
+TEST(RX_THREAD_POOL, PinWorkersTest)
+{
+    cpu_set_t allowed;
+    size_t i;
+
+    TEST_ASSERT_EQUAL(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+
+    /* More workers than CPUs wrap around the allowed CPUs */
+    TEST_ASSERT_EQUAL(
+        RX_OK, rx_test_thread_pool_start(
+                   CPU_COUNT(&allowed) + 1, RX_RING_DEFAULT_CAPACITY, 1
+               )
+    );
+
+    for (i = 0; i < pool.nthreads; i++)
+    {
+        TEST_ASSERT_NOT_NULL(pool.workers[i]);
+        TEST_ASSERT_TRUE(pool.workers[i]->cpu >= 0);
+        TEST_ASSERT_TRUE(CPU_ISSET(pool.workers[i]->cpu, &allowed));
+    }
+
+    for (i = 0; i < RX_TEST_THREAD_POOL_TASKS; i++)
+    {
+        while (rx_thread_pool_submit(&pool, &tasks[i]) != RX_OK)
+        {
+            sched_yield();
+        }
+    }
+
+    TEST_ASSERT_EQUAL(
+        RX_OK, rx_test_thread_pool_wait(&done, RX_TEST_THREAD_POOL_TASKS)
+    );
+}
+
+TEST(RX_THREAD_POOL, ShedLateTasksTest)
+{
+    struct rx_thread_pool_config config = {
+        .name     = "shedding",
+        .nthreads = 1,
+        .depth    = RX_RING_DEFAULT_CAPACITY,
+        .priority = 0,
+        .affinity = 0,
+        .target   = 1000000,
+    };
+    struct rx_task holders[2] = {
+        {.handle = rx_test_thread_pool_hold, .arg = &holds[0]},
+        {.handle = rx_test_thread_pool_hold, .arg = &holds[1]},
+    };
+    size_t i;
+
+    for (i = 0; i < 10; i++)
+    {
+        tasks[i].shed = rx_test_thread_pool_shed;
+    }
+
+    /* A single worker runs the tasks in the order they were queued */
+    TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_init(&pool, &config));
+
+    TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &holders[0]));
+    TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_wait(&blocked, 1));
+
+    for (i = 0; i < 5; i++)
+    {
+        TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &tasks[i]));
+    }
+
+    TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &holders[1]));
+
+    for (; i < 10; i++)
+    {
+        TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &tasks[i]));
+    }
+
+    /* Every task of the first interval waits over the target of 1 ms, yet
+       a single interval says nothing of a standing queue */
+
+    rx_test_thread_pool_sleep(20);
+    atomic_store(&holds[0], 1);
+    TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_wait(&blocked, 2));
+
+    /* Once the interval of 100 ms is over, the queue is overloaded. The
+       first task of the new interval only starts its minimum delay, the
+       others are shed. */
+
+    rx_test_thread_pool_sleep(150);
+    atomic_store(&holds[1], 1);
+    TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_wait(&done, 10 + 2));
+
+    for (i = 0; i < 10; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(i <= 5, atomic_load(&runs[i]));
+        TEST_ASSERT_EQUAL_INT(i > 5, atomic_load(&sheds[i]));
+    }
+}
+
+TEST(RX_THREAD_POOL, StatsTest)
+{
+    struct rx_thread_pool_stats stats;
+    struct rx_task holder = {
+        .handle = rx_test_thread_pool_hold,
+        .arg    = &holds[0],
+    };
+    size_t i;
+
+    TEST_ASSERT_EQUAL(
+        RX_OK, rx_test_thread_pool_start(2, RX_RING_DEFAULT_CAPACITY, 0)
+    );
+
+    rx_thread_pool_stats(&pool, &stats);
+    TEST_ASSERT_EQUAL_size_t(0, stats.queued);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.ntasks);
+
+    /* The tasks wait while one worker is held, and the other one steals
+       them */
+
+    TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &holder));
+    TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_wait(&blocked, 1));
+
+    for (i = 0; i < 100; i++)
+    {
+        TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &tasks[i]));
+    }
+
+    atomic_store(&holds[0], 1);
+    TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_wait(&done, 101));
+
+    /* The last task is counted right after it has run */
+    while (rx_thread_pool_stats(&pool, &stats), stats.ntasks < 101)
+    {
+        sched_yield();
+    }
+
+    TEST_ASSERT_EQUAL_size_t(0, stats.queued);
+    TEST_ASSERT_EQUAL_UINT64(101, stats.ntasks);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.nshed);
+    TEST_ASSERT_TRUE(stats.wait_max <= stats.wait);
+    TEST_ASSERT_TRUE(stats.service > 0);
+}
+
+static _Atomic int priority;
+
+/* Record the nice value of the worker */
+static void *
+rx_test_thread_pool_priority(void *arg)
+{
+    NOOP(arg);
+
+    atomic_store(
+        &priority, getpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid))
+    );
+    atomic_fetch_add(&done, 1);
+
+    return RX_OK_PTR;
+}
+
+TEST(RX_THREAD_POOL, PriorityTest)
+{
+    struct rx_thread_pool_config config = {
+        .name     = "background",
+        .nthreads = 1,
+        .depth    = RX_RING_DEFAULT_CAPACITY,
+        .priority = getpriority(PRIO_PROCESS, 0) + 1,
+        .affinity = 0,
+        .target   = 0,
+    };
+    struct rx_task task = {
+        .handle = rx_test_thread_pool_priority,
+        .arg    = NULL,
+    };
+
+    /* Lowering the priority needs no privileges */
+    TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_init(&pool, &config));
+    TEST_ASSERT_EQUAL(RX_OK, rx_thread_pool_submit(&pool, &task));
+    TEST_ASSERT_EQUAL(RX_OK, rx_test_thread_pool_wait(&done, 1));
+
+    TEST_ASSERT_EQUAL_INT(config.priority, atomic_load(&priority));
+
+    /* The calling thread keeps its own */
+    TEST_ASSERT_EQUAL_INT(config.priority - 1, getpriority(PRIO_PROCESS, 0));
+}
+
+TEST_GROUP_RUNNER(RX_THREAD_POOL)
+{
+    RUN_TEST_CASE(RX_THREAD_POOL, RunEveryTaskOnceTest);
+    RUN_TEST_CASE(RX_THREAD_POOL, StealFromBusyWorkerTest);
+    RUN_TEST_CASE(RX_THREAD_POOL, SubmitToFullPoolTest);
+    RUN_TEST_CASE(RX_THREAD_POOL, FailedTaskTest);
+    RUN_TEST_CASE(RX_THREAD_POOL, InitWithoutWorkersTest);
+    RUN_TEST_CASE(RX_THREAD_POOL, PinWorkersTest);
+    RUN_TEST_CASE(RX_THREAD_POOL, ShedLateTasksTest);
+    RUN_TEST_CASE(RX_THREAD_POOL, StatsTest);
+    RUN_TEST_CASE(RX_THREAD_POOL, PriorityTest);
+}
@@ -0,0 +1,294 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+#define RX_TEST_TIMER_START 1000000
+
+static struct rx_timer_wheel wheel;
+static int nexpired;
+static uint64_t expired_at[16];
+
+static void
+rx_test_timer_handler(struct rx_timer *timer)
+{
+    NOOP(timer);
+
+    if (nexpired < (int)(sizeof(expired_at) / sizeof(expired_at[0])))
+    {
+        expired_at[nexpired] = wheel.now;
+    }
+
+    nexpired++;
+}
+
+static void
+rx_test_timer_rearm_handler(struct rx_timer *timer)
+{
+    rx_test_timer_handler(timer);
+
+    if (nexpired < 3)
+    {
+        rx_timer_wheel_add(&wheel, timer, wheel.now + 10);
+    }
+}
+
+TEST_GROUP(RX_TIMER);
+
+TEST_SETUP(RX_TIMER)
+{
+    rx_timer_wheel_init(&wheel, RX_TEST_TIMER_START);
+
+    nexpired = 0;
+    memset(expired_at, 0, sizeof(expired_at));
+}
+
+TEST_TEAR_DOWN(RX_TIMER)
+{
+}
+
+TEST(RX_TIMER, EmptyWheelTest)
+{
+    TEST_ASSERT_EQUAL_INT(-1, rx_timer_wheel_timeout(&wheel));
+
+    rx_timer_wheel_advance(&wheel, RX_TEST_TIMER_START + 5000);
+
+    TEST_ASSERT_EQUAL_UINT64(RX_TEST_TIMER_START + 5000, wheel.now);
+    TEST_ASSERT_EQUAL_INT(0, nexpired);
+
+    TEST_PASS_MESSAGE("Empty wheel test passed.");
+}
+
+TEST(RX_TIMER, ExpireOnTimeTest)
+{
+    struct rx_timer timer;
+
+    rx_timer_init(&timer, rx_test_timer_handler, NULL);
+    rx_timer_wheel_add(&wheel, &timer, RX_TEST_TIMER_START + 20);
+
+    TEST_ASSERT_TRUE(rx_timer_is_active(&timer));
+    TEST_ASSERT_EQUAL_INT(20, rx_timer_wheel_timeout(&wheel));
+
+    rx_timer_wheel_advance(&wheel, RX_TEST_TIMER_START + 19);
+    TEST_ASSERT_EQUAL_INT(0, nexpired);
+
+    rx_timer_wheel_advance(&wheel, RX_TEST_TIMER_START + 20);
+    TEST_ASSERT_EQUAL_INT(1, nexpired);
+    TEST_ASSERT_EQUAL_UINT64(RX_TEST_TIMER_START + 20, expired_at[0]);
+    TEST_ASSERT_FALSE(rx_timer_is_active(&timer));
+    TEST_ASSERT_EQUAL_INT(-1, rx_timer_wheel_timeout(&wheel));
+
+    TEST_PASS_MESSAGE("Expire on time test passed.");
+}
+
+TEST(RX_TIMER, PastDeadlineTest)
+{
+    struct rx_timer timer;
+
+    rx_timer_init(&timer, rx_test_timer_handler, NULL);
+    rx_timer_wheel_add(&wheel, &timer, RX_TEST_TIMER_START - 100);
+
+    TEST_ASSERT_EQUAL_INT(1, rx_timer_wheel_timeout(&wheel));
+
+    rx_timer_wheel_advance(&wheel, RX_TEST_TIMER_START + 1);
+    TEST_ASSERT_EQUAL_INT(1, nexpired);
+
+    TEST_PASS_MESSAGE("Past deadline test passed.");
+}
+
+TEST(RX_TIMER, CancelTest)
+{
+    struct rx_timer timer;
+
+    rx_timer_init(&timer, rx_test_timer_handler, NULL);
+    rx_timer_wheel_add(&wheel, &timer, RX_TEST_TIMER_START + 5);
+    rx_timer_wheel_del(&wheel, &timer);
+
+    TEST_ASSERT_FALSE(rx_timer_is_active(&timer));
+    TEST_ASSERT_EQUAL_size_t(0, wheel.ntimers);
+
+    /* Cancelling an inactive timer is a no-op */
+    rx_timer_wheel_del(&wheel, &timer);
+
+    rx_timer_wheel_advance(&wheel, RX_TEST_TIMER_START + 100);
+    TEST_ASSERT_EQUAL_INT(0, nexpired);
+
+    TEST_PASS_MESSAGE("Cancel test passed.");
+}
+
+TEST(RX_TIMER, RearmMovesTimerTest)
+{
+    struct rx_timer timer;
+
+    rx_timer_init(&timer, rx_test_timer_handler, NULL);
+    rx_timer_wheel_add(&wheel, &timer, RX_TEST_TIMER_START + 5);
+    rx_timer_wheel_add(&wheel, &timer, RX_TEST_TIMER_START + 5000);
+
+    TEST_ASSERT_EQUAL_size_t(1, wheel.ntimers);
+
+    rx_timer_wheel_advance(&wheel, RX_TEST_TIMER_START + 4999);
+    TEST_ASSERT_EQUAL_INT(0, nexpired);
+
+    rx_timer_wheel_advance(&wheel, RX_TEST_TIMER_START + 5000);
+    TEST_ASSERT_EQUAL_INT(1, nexpired);
+    TEST_ASSERT_EQUAL_UINT64(RX_TEST_TIMER_START + 5000, expired_at[0]);
+
+    TEST_PASS_MESSAGE("Re-arm moves timer test passed.");
+}
+
+TEST(RX_TIMER, CascadeAllLevelsTest)
+{
+    struct rx_timer timers[4];
+    const uint64_t deadlines[4] = {
+        RX_TEST_TIMER_START + 63,
+        RX_TEST_TIMER_START + 4000,
+        RX_TEST_TIMER_START + 300000,
+        RX_TEST_TIMER_START + 3600000,
+    };
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        rx_timer_init(&timers[i], rx_test_timer_handler, NULL);
+        rx_timer_wheel_add(&wheel, &timers[i], deadlines[3 - i]);
+    }
+
+    rx_timer_wheel_advance(&wheel, RX_TEST_TIMER_START + 3600000);
+
+    TEST_ASSERT_EQUAL_INT(4, nexpired);
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        TEST_ASSERT_EQUAL_UINT64(deadlines[i], expired_at[i]);
+    }
+
+    TEST_PASS_MESSAGE("Cascade all levels test passed.");
+}
+
+TEST(RX_TIMER, BeyondRangeTest)
+{
+    struct rx_timer timer;
+    const uint64_t deadline = RX_TEST_TIMER_START + RX_TIMER_WHEEL_RANGE + 77;
+
+    rx_timer_init(&timer, rx_test_timer_handler, NULL);
+    rx_timer_wheel_add(&wheel, &timer, deadline);
+
+    rx_timer_wheel_advance(&wheel, deadline - 1);
+    TEST_ASSERT_EQUAL_INT(0, nexpired);
+
+    rx_timer_wheel_advance(&wheel, deadline);
+    TEST_ASSERT_EQUAL_INT(1, nexpired);
+    TEST_ASSERT_EQUAL_UINT64(deadline, expired_at[0]);
+
+    TEST_PASS_MESSAGE("Beyond range test passed.");
+}
+
+TEST(RX_TIMER, TimeoutNeverLateTest)
+{
+    struct rx_timer timer;
+    const uint64_t deadline = RX_TEST_TIMER_START + 5000;
+    int timeout;
+
+    rx_timer_init(&timer, rx_test_timer_handler, NULL);
+    rx_timer_wheel_add(&wheel, &timer, deadline);
+
+    /* Sleep for the suggested timeout until the timer fires. The wheel may
+       wake up early to cascade, but it must never oversleep the deadline. */
+
+    while (nexpired == 0)
+    {
+        timeout = rx_timer_wheel_timeout(&wheel);
+
+        TEST_ASSERT_TRUE(timeout > 0);
+        TEST_ASSERT_TRUE(wheel.now + (uint64_t)timeout <= deadline);
+
+        rx_timer_wheel_advance(&wheel, wheel.now + (uint64_t)timeout);
+    }
+
+    TEST_ASSERT_EQUAL_UINT64(deadline, expired_at[0]);
+
+    TEST_PASS_MESSAGE("Timeout never late test passed.");
+}
+
+TEST(RX_TIMER, HandlerRearmTest)
+{
+    struct rx_timer timer;
+
+    rx_timer_init(&timer, rx_test_timer_rearm_handler, NULL);
+    rx_timer_wheel_add(&wheel, &timer, RX_TEST_TIMER_START + 10);
+
+    rx_timer_wheel_advance(&wheel, RX_TEST_TIMER_START + 100);
+
+    TEST_ASSERT_EQUAL_INT(3, nexpired);
+    TEST_ASSERT_EQUAL_UINT64(RX_TEST_TIMER_START + 10, expired_at[0]);
+    TEST_ASSERT_EQUAL_UINT64(RX_TEST_TIMER_START + 20, expired_at[1]);
+    TEST_ASSERT_EQUAL_UINT64(RX_TEST_TIMER_START + 30, expired_at[2]);
+    TEST_ASSERT_FALSE(rx_timer_is_active(&timer));
+
+    TEST_PASS_MESSAGE("Handler re-arm test passed.");
+}
+
+TEST(RX_TIMER, ManyTimersTest)
+{
+    static struct rx_timer timers[1000];
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        rx_timer_init(&timers[i], rx_test_timer_handler, NULL);
+        rx_timer_wheel_add(&wheel, &timers[i], RX_TEST_TIMER_START + 1 + i * 7);
+    }
+
+    /* Cancel every other timer */
+    for (size_t i = 0; i < 1000; i += 2)
+    {
+        rx_timer_wheel_del(&wheel, &timers[i]);
+    }
+
+    TEST_ASSERT_EQUAL_size_t(500, wheel.ntimers);
+
+    rx_timer_wheel_advance(&wheel, RX_TEST_TIMER_START + 7000);
+
+    TEST_ASSERT_EQUAL_INT(500, nexpired);
+    TEST_ASSERT_EQUAL_size_t(0, wheel.ntimers);
+
+    TEST_PASS_MESSAGE("Many timers test passed.");
+}
+
+TEST_GROUP_RUNNER(RX_TIMER)
+{
+    RUN_TEST_CASE(RX_TIMER, EmptyWheelTest);
+    RUN_TEST_CASE(RX_TIMER, ExpireOnTimeTest);
+    RUN_TEST_CASE(RX_TIMER, PastDeadlineTest);
+    RUN_TEST_CASE(RX_TIMER, CancelTest);
+    RUN_TEST_CASE(RX_TIMER, RearmMovesTimerTest);
+
+    RUN_TEST_CASE(RX_TIMER, CascadeAllLevelsTest);
+    RUN_TEST_CASE(RX_TIMER, BeyondRangeTest);
+    RUN_TEST_CASE(RX_TIMER, TimeoutNeverLateTest);
+
+    RUN_TEST_CASE(RX_TIMER, HandlerRearmTest);
+    RUN_TEST_CASE(RX_TIMER, ManyTimersTest);
+}
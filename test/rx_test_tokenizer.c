@@ -0,0 +1,406 @@
+/* MIT License
+ *
+ * Copyright (c) 2023 Richard H. Nguyen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity/unity.h>
+#include <unity/unity_fixture.h>
+
+#include <rx_config.h>
+#include <rx_core.h>
+
+static const rx_tokenizer_impl_t impls[] = {
+    RX_TOKENIZER_SCALAR,
+    RX_TOKENIZER_SSE42,
+    RX_TOKENIZER_AVX2,
+};
+
+static struct rx_tokens tokens;
+
+/* Tokenize `head` a byte at a time, as if each byte arrived on its own */
+static int
+rx_test_tokenize_bytes(const char *head, size_t len)
+{
+    size_t n;
+    int ret;
+
+    rx_tokenizer_reset(&tokens);
+
+    ret = RX_AGAIN;
+
+    for (n = 1; n <= len && ret == RX_AGAIN; n++)
+    {
+        ret = rx_tokenize(&tokens, head, n);
+    }
+
+    return ret;
+}
+
+/* Tokenize `head` with every implementation the CPU supports, both at once
+   and a byte at a time, and check that they all agree on the result */
+static int
+rx_test_tokenize(const char *head)
+{
+    int ret, expected;
+    size_t i, nimpls, len, nheaders;
+
+    expected = RX_OK;
+    nimpls   = 0;
+    len      = strlen(head);
+
+    for (i = 0; i < sizeof(impls) / sizeof(impls[0]); i++)
+    {
+        if (rx_tokenizer_use(impls[i]) != RX_OK)
+        {
+            continue;
+        }
+
+        ret      = rx_test_tokenize_bytes(head, len);
+        nheaders = tokens.nheaders;
+
+        rx_tokenizer_reset(&tokens);
+
+        TEST_ASSERT_EQUAL_INT_MESSAGE(
+            ret, rx_tokenize(&tokens, head, len), rx_tokenizer_name()
+        );
+        TEST_ASSERT_EQUAL_size_t_MESSAGE(
+            nheaders, tokens.nheaders, rx_tokenizer_name()
+        );
+
+        if (nimpls++ == 0)
+        {
+            expected = ret;
+        }
+
+        TEST_ASSERT_EQUAL_INT_MESSAGE(expected, ret, rx_tokenizer_name());
+    }
+
+    return expected;
+}
+
+static void
+rx_test_assert_span(const char *expected, const char *begin, const char *end)
+{
+    TEST_ASSERT_NOT_NULL(begin);
+    TEST_ASSERT_EQUAL_size_t(strlen(expected), end - begin);
+
+    if (end > begin)
+    {
+        TEST_ASSERT_EQUAL_MEMORY(expected, begin, end - begin);
+    }
+}
+
+static void
+rx_test_assert_header(size_t i, const char *name, const char *value)
+{
+    TEST_ASSERT_LESS_THAN_size_t(tokens.nheaders, i);
+    rx_test_assert_span(
+        name, tokens.headers[i].name, tokens.headers[i].name_end
+    );
+    rx_test_assert_span(
+        value, tokens.headers[i].value, tokens.headers[i].value_end
+    );
+}
+
+TEST_GROUP(RX_TOKENIZER);
+
+TEST_SETUP(RX_TOKENIZER)
+{
+}
+
+TEST_TEAR_DOWN(RX_TOKENIZER)
+{
+    rx_tokenizer_init();
+}
+
+TEST(RX_TOKENIZER, RequestTest)
+{
+    const char *head = "GET /index.html?foo=bar HTTP/1.1\r\n"
+                       "Host: localhost:8080\r\n"
+                       "Accept: text/html, application/xhtml+xml\r\n"
+                       "Connection: keep-alive\r\n"
+                       "\r\n";
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_test_tokenize(head));
+
+    rx_test_assert_span("GET", tokens.method, tokens.method_end);
+    rx_test_assert_span("/index.html?foo=bar", tokens.uri, tokens.uri_end);
+    rx_test_assert_span("HTTP/1.1", tokens.version, tokens.version_end);
+
+    TEST_ASSERT_EQUAL_size_t(3, tokens.nheaders);
+    rx_test_assert_header(0, "Host", "localhost:8080");
+    rx_test_assert_header(1, "Accept", "text/html, application/xhtml+xml");
+    rx_test_assert_header(2, "Connection", "keep-alive");
+}
+
+TEST(RX_TOKENIZER, NoHeadersTest)
+{
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_test_tokenize("GET / HTTP/1.1\r\n\r\n"));
+    rx_test_assert_span("/", tokens.uri, tokens.uri_end);
+    TEST_ASSERT_EQUAL_size_t(0, tokens.nheaders);
+}
+
+TEST(RX_TOKENIZER, WhitespaceTest)
+{
+    const char *head = "GET / HTTP/1.1\r\n"
+                       "Host:localhost:8080\r\n"
+                       "Connection: \t close \t\r\n"
+                       "X-Empty:\r\n"
+                       "X-Blank:   \r\n"
+                       "\r\n";
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_test_tokenize(head));
+
+    TEST_ASSERT_EQUAL_size_t(4, tokens.nheaders);
+    rx_test_assert_header(0, "Host", "localhost:8080");
+    rx_test_assert_header(1, "Connection", "close");
+    rx_test_assert_header(2, "X-Empty", "");
+    rx_test_assert_header(3, "X-Blank", "");
+}
+
+TEST(RX_TOKENIZER, StrideTest)
+{
+    char head[1024], value[2 * RX_TOKENIZER_STRIDE + 1];
+    size_t len;
+
+    /* Move the delimiters across every offset of a stride, so that they fall
+       on both sides of each boundary */
+
+    for (len = 0; len < 2 * RX_TOKENIZER_STRIDE + 1; len++)
+    {
+        memset(value, 'v', len);
+        value[len] = '\0';
+
+        snprintf(
+            head, sizeof(head),
+            "GET /%s HTTP/1.1\r\nX-%s: %s\r\nHost: localhost:8080\r\n\r\n",
+            value, value, value
+        );
+
+        TEST_ASSERT_EQUAL_INT(RX_OK, rx_test_tokenize(head));
+        TEST_ASSERT_EQUAL_size_t(len + 1, tokens.uri_end - tokens.uri);
+        TEST_ASSERT_EQUAL_size_t(2, tokens.nheaders);
+        TEST_ASSERT_EQUAL_size_t(
+            len, tokens.headers[0].value_end - tokens.headers[0].value
+        );
+        rx_test_assert_header(1, "Host", "localhost:8080");
+    }
+}
+
+TEST(RX_TOKENIZER, MalformedStartLineTest)
+{
+    TEST_ASSERT_EQUAL_INT(RX_ERROR, rx_test_tokenize("GET\r\n"));
+    TEST_ASSERT_EQUAL_INT(RX_ERROR, rx_test_tokenize("GET /\r\n"));
+
+    TEST_ASSERT_NULL(tokens.version);
+
+    TEST_ASSERT_EQUAL_INT(RX_ERROR, rx_test_tokenize("GET / HTTP/1.1 \r\n"));
+    TEST_ASSERT_EQUAL_INT(RX_ERROR, rx_test_tokenize("GET / HTTP/1.1\n"));
+    TEST_ASSERT_EQUAL_INT(RX_ERROR, rx_test_tokenize("GET / HTTP/1.1\r\r\n"));
+}
+
+TEST(RX_TOKENIZER, MalformedHeaderTest)
+{
+    /* The start line is still usable to answer with a 400 */
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_ERROR, rx_test_tokenize("GET / HTTP/1.1\r\nHost : localhost\r\n")
+    );
+    rx_test_assert_span("HTTP/1.1", tokens.version, tokens.version_end);
+
+    TEST_ASSERT_EQUAL_INT(
+        RX_ERROR, rx_test_tokenize("GET / HTTP/1.1\r\nNoColon\r\n")
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_ERROR, rx_test_tokenize("GET / HTTP/1.1\r\n: empty\r\n")
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_ERROR, rx_test_tokenize("GET / HTTP/1.1\r\nA: b\nC: d\r\n")
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_ERROR, rx_test_tokenize("GET / HTTP/1.1\r\nA: b\rC: d\r\n")
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_ERROR, rx_test_tokenize("GET / HTTP/1.1\r\n folded: value\r\n")
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_ERROR, rx_test_tokenize("GET / HTTP/1.1\r\nHost: localhost\r\r\n")
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_ERROR, rx_test_tokenize("GET / HTTP/1.1\r\n\r\r\n")
+    );
+}
+
+TEST(RX_TOKENIZER, TooManyHeadersTest)
+{
+    char head[4096];
+    size_t i, len;
+
+    len = snprintf(head, sizeof(head), "GET / HTTP/1.1\r\n");
+
+    for (i = 0; i < RX_TOKENIZER_MAX_HEADERS; i++)
+    {
+        len += snprintf(head + len, sizeof(head) - len, "X-%zu: v\r\n", i);
+    }
+
+    snprintf(head + len, sizeof(head) - len, "\r\n");
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_test_tokenize(head));
+    TEST_ASSERT_EQUAL_size_t(RX_TOKENIZER_MAX_HEADERS, tokens.nheaders);
+
+    snprintf(head + len, sizeof(head) - len, "X-last: v\r\n\r\n");
+
+    TEST_ASSERT_EQUAL_INT(RX_ERROR, rx_test_tokenize(head));
+}
+
+TEST(RX_TOKENIZER, IncompleteTest)
+{
+    /* Nothing is wrong yet, more bytes are needed */
+
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_test_tokenize(""));
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_test_tokenize("GET / HTTP/1.1"));
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_test_tokenize("GET / HTTP/1.1\r\n"));
+    TEST_ASSERT_EQUAL_INT(
+        RX_AGAIN, rx_test_tokenize("GET / HTTP/1.1\r\nHost: localhost")
+    );
+    TEST_ASSERT_EQUAL_INT(
+        RX_AGAIN, rx_test_tokenize("GET / HTTP/1.1\r\nHost: localhost\r\n\r")
+    );
+}
+
+TEST(RX_TOKENIZER, ResumeTest)
+{
+    char head[] = "GET /about HTTP/1.1\r\nHost: localhost:8080\r\n\r\n";
+
+    rx_tokenizer_reset(&tokens);
+
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_tokenize(&tokens, head, 14));
+    TEST_ASSERT_EQUAL_INT(RX_REQUEST_STATE_VERSION, tokens.state);
+    TEST_ASSERT_EQUAL_size_t(14, tokens.scanned);
+    rx_test_assert_span("/about", tokens.uri, tokens.uri_end);
+
+    /* The bytes looked at already are not looked at again */
+    head[3] = '\n';
+
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_tokenize(&tokens, head, 27));
+    TEST_ASSERT_EQUAL_INT(RX_REQUEST_STATE_HEADER_VALUE, tokens.state);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_tokenize(&tokens, head, strlen(head)));
+    rx_test_assert_span("HTTP/1.1", tokens.version, tokens.version_end);
+    rx_test_assert_header(0, "Host", "localhost:8080");
+    TEST_ASSERT_EQUAL_PTR(head + strlen(head), tokens.end);
+}
+
+TEST(RX_TOKENIZER, BodyTest)
+{
+    const char *request = "POST /login HTTP/1.1\r\n"
+                          "Content-Length: 12\r\n"
+                          "\r\n"
+                          "Not: a header";
+
+    /* The body is not part of the head */
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_test_tokenize(request));
+    TEST_ASSERT_EQUAL_size_t(1, tokens.nheaders);
+    TEST_ASSERT_EQUAL_STRING("Not: a header", tokens.end);
+
+    /* The result is final */
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_tokenize(&tokens, request, 3));
+    TEST_ASSERT_EQUAL_INT(RX_ERROR, rx_test_tokenize("GET\r\n\r\n"));
+    TEST_ASSERT_EQUAL_INT(
+        RX_ERROR, rx_tokenize(&tokens, request, strlen(request))
+    );
+}
+
+TEST(RX_TOKENIZER, RebaseTest)
+{
+    const char *head = "GET /about HTTP/1.1\r\nHost: localhost:8080\r\n"
+                       "Accept: */*\r\n\r\n";
+    char from[128], to[128];
+
+    strcpy(from, head);
+    rx_tokenizer_reset(&tokens);
+
+    /* Stop in the middle of the value of `Accept`, whose name is known */
+
+    TEST_ASSERT_EQUAL_INT(RX_AGAIN, rx_tokenize(&tokens, from, 53));
+    TEST_ASSERT_EQUAL_INT(RX_REQUEST_STATE_HEADER_VALUE, tokens.state);
+
+    strcpy(to, head);
+    memset(from, 0, sizeof(from));
+
+    rx_tokenizer_rebase(&tokens, from, to);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_tokenize(&tokens, to, strlen(to)));
+    TEST_ASSERT_EQUAL_PTR(to + 4, tokens.uri);
+    rx_test_assert_span("/about", tokens.uri, tokens.uri_end);
+    rx_test_assert_header(0, "Host", "localhost:8080");
+    rx_test_assert_header(1, "Accept", "*/*");
+    TEST_ASSERT_EQUAL_PTR(to + strlen(to), tokens.end);
+}
+
+TEST(RX_TOKENIZER, ProcessTest)
+{
+    struct rx_arena arena;
+    struct rx_request request;
+    const char *head = "POST /login HTTP/1.1\r\n"
+                       "Host: localhost:8080\r\n"
+                       "Content-Length: 42\r\n"
+                       "Connection: close\r\n"
+                       "\r\n";
+
+    rx_arena_init(&arena);
+    rx_request_init(&request, &arena);
+
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_test_tokenize(head));
+    TEST_ASSERT_EQUAL_INT(
+        RX_OK, rx_request_process_start_line(&request, &tokens)
+    );
+    TEST_ASSERT_EQUAL_INT(RX_OK, rx_request_process_headers(&request, &tokens));
+
+    TEST_ASSERT_EQUAL_INT(RX_REQUEST_METHOD_POST, request.method);
+    TEST_ASSERT_EQUAL_INT(RX_REQUEST_VERSION_RESULT_OK, request.version.result);
+    TEST_ASSERT_EQUAL_INT(
+        RX_REQUEST_HEADER_HOST_RESULT_OK, request.host.result
+    );
+    TEST_ASSERT_EQUAL_size_t(42, request.content_length);
+    TEST_ASSERT_EQUAL_INT(0, request.keep_alive);
+
+    rx_request_destroy(&request);
+    rx_arena_destroy(&arena);
+}
+
+TEST_GROUP_RUNNER(RX_TOKENIZER)
+{
+    RUN_TEST_CASE(RX_TOKENIZER, RequestTest);
+    RUN_TEST_CASE(RX_TOKENIZER, NoHeadersTest);
+    RUN_TEST_CASE(RX_TOKENIZER, WhitespaceTest);
+    RUN_TEST_CASE(RX_TOKENIZER, StrideTest);
+    RUN_TEST_CASE(RX_TOKENIZER, MalformedStartLineTest);
+    RUN_TEST_CASE(RX_TOKENIZER, MalformedHeaderTest);
+    RUN_TEST_CASE(RX_TOKENIZER, TooManyHeadersTest);
+    RUN_TEST_CASE(RX_TOKENIZER, IncompleteTest);
+    RUN_TEST_CASE(RX_TOKENIZER, ResumeTest);
+    RUN_TEST_CASE(RX_TOKENIZER, BodyTest);
+    RUN_TEST_CASE(RX_TOKENIZER, RebaseTest);
+    RUN_TEST_CASE(RX_TOKENIZER, ProcessTest);
+}
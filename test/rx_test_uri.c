@@ -32,13 +32,9 @@ struct rx_request_uri uri;
 static void
 rx_memset_uri(struct rx_request_uri *uri)
 {
-    memset(uri->raw_uri, 0, sizeof(uri->raw_uri));
-
-    uri->length           = 0;
-    uri->path             = NULL;
-    uri->query_string     = NULL;
-    uri->path_end         = NULL;
-    uri->query_string_end = NULL;
+    memset(&uri->raw, 0, sizeof(uri->raw));
+    memset(&uri->path, 0, sizeof(uri->path));
+    memset(&uri->query_string, 0, sizeof(uri->query_string));
 
     uri->result = RX_REQUEST_URI_RESULT_NONE;
 }
@@ -59,12 +55,12 @@ TEST(RX_REQUEST_URI, EmptyUriTest)
     const char *raw_uri = "";
     rx_request_process_uri(&uri, raw_uri, 0);
 
-    TEST_ASSERT_EQUAL_STRING("", uri.raw_uri);
-    TEST_ASSERT_EQUAL(0, uri.length);
-    TEST_ASSERT_EQUAL_PTR(NULL, uri.path);
-    TEST_ASSERT_EQUAL_PTR(NULL, uri.query_string);
-    TEST_ASSERT_EQUAL_PTR(NULL, uri.path_end);
-    TEST_ASSERT_EQUAL_PTR(NULL, uri.query_string_end);
+    TEST_ASSERT_EQUAL_PTR(NULL, uri.raw.data);
+    TEST_ASSERT_EQUAL(0, uri.raw.len);
+    TEST_ASSERT_EQUAL_PTR(NULL, uri.path.data);
+    TEST_ASSERT_EQUAL(0, uri.path.len);
+    TEST_ASSERT_EQUAL_PTR(NULL, uri.query_string.data);
+    TEST_ASSERT_EQUAL(0, uri.query_string.len);
 
     TEST_ASSERT_EQUAL(RX_REQUEST_URI_RESULT_INVALID, uri.result);
     TEST_PASS_MESSAGE("Empty URI test passed");
@@ -75,15 +71,13 @@ TEST(RX_REQUEST_URI, IndexUriTest)
     const char *raw_uri = "/";
     rx_request_process_uri(&uri, raw_uri, 1);
 
-    TEST_ASSERT_EQUAL_STRING("/", uri.raw_uri);
-    TEST_ASSERT_EQUAL(1, uri.length);
-    TEST_ASSERT_EQUAL_STRING("/", uri.path);
-    TEST_ASSERT_EQUAL_STRING("\0", uri.path_end);
+    TEST_ASSERT_EQUAL_PTR(raw_uri, uri.raw.data);
+    TEST_ASSERT_EQUAL(1, uri.raw.len);
 
-    TEST_ASSERT_EQUAL_PTR(uri.raw_uri, uri.path);
-    TEST_ASSERT_EQUAL_PTR(NULL, uri.query_string);
-    TEST_ASSERT_EQUAL_PTR(uri.raw_uri + uri.length, uri.path_end);
-    TEST_ASSERT_EQUAL_PTR(NULL, uri.query_string_end);
+    TEST_ASSERT_EQUAL_PTR(raw_uri, uri.path.data);
+    TEST_ASSERT_EQUAL(1, uri.path.len);
+    TEST_ASSERT_EQUAL_PTR(NULL, uri.query_string.data);
+    TEST_ASSERT_EQUAL(0, uri.query_string.len);
 
     TEST_ASSERT_EQUAL(RX_REQUEST_URI_RESULT_OK, uri.result);
 
@@ -96,15 +90,13 @@ TEST(RX_REQUEST_URI, UriWithNoSlashTest)
     const size_t len    = strlen(raw_uri);
     rx_request_process_uri(&uri, raw_uri, len);
 
-    TEST_ASSERT_EQUAL_STRING("index.html", uri.raw_uri);
-    TEST_ASSERT_EQUAL(len, uri.length);
-    TEST_ASSERT_EQUAL_STRING("index.html", uri.path);
-    TEST_ASSERT_EQUAL_STRING("\0", uri.path_end);
+    TEST_ASSERT_EQUAL_PTR(raw_uri, uri.raw.data);
+    TEST_ASSERT_EQUAL(len, uri.raw.len);
 
-    TEST_ASSERT_EQUAL_PTR(uri.raw_uri, uri.path);
-    TEST_ASSERT_EQUAL_PTR(NULL, uri.query_string);
-    TEST_ASSERT_EQUAL_PTR(uri.raw_uri + uri.length, uri.path_end);
-    TEST_ASSERT_EQUAL_PTR(NULL, uri.query_string_end);
+    TEST_ASSERT_EQUAL_PTR(raw_uri, uri.path.data);
+    TEST_ASSERT_EQUAL(len, uri.path.len);
+    TEST_ASSERT_EQUAL_PTR(NULL, uri.query_string.data);
+    TEST_ASSERT_EQUAL(0, uri.query_string.len);
 
     TEST_ASSERT_EQUAL(RX_REQUEST_URI_RESULT_OK, uri.result);
 
@@ -118,15 +110,13 @@ TEST(RX_REQUEST_URI, MultiPathUriTest)
     const size_t len    = strlen(raw_uri);
     rx_request_process_uri(&uri, raw_uri, len);
 
-    TEST_ASSERT_EQUAL_STRING(raw_uri, uri.raw_uri);
-    TEST_ASSERT_EQUAL(len, uri.length);
-    TEST_ASSERT_EQUAL_STRING(raw_uri, uri.path);
-    TEST_ASSERT_EQUAL_STRING("\0", uri.path_end);
+    TEST_ASSERT_EQUAL_PTR(raw_uri, uri.raw.data);
+    TEST_ASSERT_EQUAL(len, uri.raw.len);
 
-    TEST_ASSERT_EQUAL_PTR(uri.raw_uri, uri.path);
-    TEST_ASSERT_EQUAL_PTR(NULL, uri.query_string);
-    TEST_ASSERT_EQUAL_PTR(uri.raw_uri + uri.length, uri.path_end);
-    TEST_ASSERT_EQUAL_PTR(NULL, uri.query_string_end);
+    TEST_ASSERT_EQUAL_PTR(raw_uri, uri.path.data);
+    TEST_ASSERT_EQUAL(len, uri.path.len);
+    TEST_ASSERT_EQUAL_PTR(NULL, uri.query_string.data);
+    TEST_ASSERT_EQUAL(0, uri.query_string.len);
 
     TEST_ASSERT_EQUAL(RX_REQUEST_URI_RESULT_OK, uri.result);
 
@@ -139,27 +129,44 @@ TEST(RX_REQUEST_URI, QueryStringUriTest)
     const size_t len    = strlen(raw_uri);
     rx_request_process_uri(&uri, raw_uri, len);
 
-    TEST_ASSERT_EQUAL_STRING(raw_uri, uri.raw_uri);
-    TEST_ASSERT_EQUAL(len, uri.length);
+    TEST_ASSERT_EQUAL_PTR(raw_uri, uri.raw.data);
+    TEST_ASSERT_EQUAL(len, uri.raw.len);
 
-    TEST_ASSERT_EQUAL_STRING_LEN("/index.html", raw_uri, 11);
-    TEST_ASSERT_EQUAL_STRING_LEN("?", uri.path_end, 1);
-    TEST_ASSERT_EQUAL(11, uri.path_end - uri.path);
+    TEST_ASSERT_EQUAL_STRING_LEN("/index.html", uri.path.data, 11);
+    TEST_ASSERT_EQUAL(11, uri.path.len);
 
-    TEST_ASSERT_EQUAL_STRING_LEN("foo=bar&baz=waldo", uri.query_string, 17);
-    TEST_ASSERT_EQUAL_STRING_LEN("\0", uri.query_string_end, 1);
-    TEST_ASSERT_EQUAL(17, uri.query_string_end - uri.query_string);
+    TEST_ASSERT_EQUAL_STRING_LEN(
+        "foo=bar&baz=waldo", uri.query_string.data, 17
+    );
+    TEST_ASSERT_EQUAL(17, uri.query_string.len);
 
-    TEST_ASSERT_EQUAL_PTR(uri.raw_uri, uri.path);
-    TEST_ASSERT_EQUAL_PTR(uri.raw_uri + 12, uri.query_string);
-    TEST_ASSERT_EQUAL_PTR(uri.raw_uri + 11, uri.path_end);
-    TEST_ASSERT_EQUAL_PTR(uri.raw_uri + uri.length, uri.query_string_end);
+    TEST_ASSERT_EQUAL_PTR(raw_uri, uri.path.data);
+    TEST_ASSERT_EQUAL_PTR(raw_uri + 12, uri.query_string.data);
 
     TEST_ASSERT_EQUAL(RX_REQUEST_URI_RESULT_OK, uri.result);
 
     TEST_PASS_MESSAGE("Query string URI test passed");
 }
 
+TEST(RX_REQUEST_URI, UriInRequestBufferTest)
+{
+    const char *buffer = "GET /about?lang=en HTTP/1.1\r\n";
+    rx_request_process_uri(&uri, buffer + 4, 14);
+
+    TEST_ASSERT_EQUAL_PTR(buffer + 4, uri.raw.data);
+    TEST_ASSERT_EQUAL(14, uri.raw.len);
+
+    TEST_ASSERT_EQUAL_PTR(buffer + 4, uri.path.data);
+    TEST_ASSERT_EQUAL(6, uri.path.len);
+
+    TEST_ASSERT_EQUAL_PTR(buffer + 11, uri.query_string.data);
+    TEST_ASSERT_EQUAL(7, uri.query_string.len);
+
+    TEST_ASSERT_EQUAL(RX_REQUEST_URI_RESULT_OK, uri.result);
+
+    TEST_PASS_MESSAGE("URI in request buffer test passed");
+}
+
 TEST(RX_REQUEST_URI, TooLongUriTest)
 {
     const char *raw_uri = "/index.html"
@@ -212,8 +219,8 @@ TEST(RX_REQUEST_URI, TooLongUriTest)
     size_t len          = strlen(raw_uri);
     rx_request_process_uri(&uri, raw_uri, len);
 
-    TEST_ASSERT_EQUAL_STRING("\0", uri.raw_uri);
-    TEST_ASSERT_EQUAL(0, uri.length);
+    TEST_ASSERT_EQUAL_PTR(NULL, uri.raw.data);
+    TEST_ASSERT_EQUAL(0, uri.raw.len);
 
     TEST_ASSERT_EQUAL(RX_REQUEST_URI_RESULT_TOO_LONG, uri.result);
 
@@ -227,5 +234,6 @@ TEST_GROUP_RUNNER(RX_REQUEST_URI)
     RUN_TEST_CASE(RX_REQUEST_URI, UriWithNoSlashTest);
     RUN_TEST_CASE(RX_REQUEST_URI, MultiPathUriTest);
     RUN_TEST_CASE(RX_REQUEST_URI, QueryStringUriTest);
+    RUN_TEST_CASE(RX_REQUEST_URI, UriInRequestBufferTest);
     RUN_TEST_CASE(RX_REQUEST_URI, TooLongUriTest);
 }